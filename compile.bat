@@ -4,11 +4,19 @@ set name="NESMaze"
 set CC65_HOME=..\
 set srcDir=src
 set libDir=src\lib
+set cfg=nrom_256_vert.cfg
+set defs=
 
-cc65 -Oi %srcDir%\main.c -g --add-source || goto fail
-ca65 %libDir%\crt0.s -g || goto fail
+REM compile.bat unrom builds the bank-switched UNROM ROM
+if /i "%1"=="unrom" (
+	set cfg=unrom_128_vert.cfg
+	set defs=-D MAPPER_UNROM
+)
+
+cc65 -Oi %defs% %srcDir%\main.c -g --add-source || goto fail
+ca65 %libDir%\crt0.s -g %defs% || goto fail
 ca65 %srcDir%\main.s -g || goto fail
-ld65 -C %libDir%\nrom_256_horz.cfg -o %name%.nes %libDir%\crt0.o %srcDir%\main.o nes.lib -Ln labels.txt || goto fail
+ld65 -C %libDir%\%cfg% -o %name%.nes %libDir%\crt0.o %srcDir%\main.o nes.lib -Ln labels.txt || goto fail
 
 REM del main.s
 del %srcDir%\*.o
@@ -0,0 +1,217 @@
+#!/bin/sh
+# Linux counterpart of compile.bat
+#
+# Usage: ./compile.sh [rom|levels|screens|sound|tools|bench|profile]
+#	rom		build NESMaze.nes (default), needs cc65/ca65/ld65 in PATH
+#	levels	regenerate src/nametables/levels.h from the graphics/level_*.nss maps
+#	screens	regenerate src/nametables/screens.h from the title and result screens, and compare
+#			its size and decode cycles with RLE
+#	sound	regenerate src/soundsAndMusic/music.s and sounds.s from sound/music.ftm and sounds.ftm
+#	tools	build the host tools into build/
+#	bench	build both, then run the benchmark session on the fresh ROM, once as scripted and
+#			once going on to the first generated level, whose maze is built in the end delay
+#	profile	build both, then profile the same two sessions by routine and source line
+#
+# Every ROM build ends with build/nmicheck, which fails the build when the NMI cannot
+# flush the largest frame of queued VRAM updates (src/vramQueue.h) within vblank, and
+# build/hotcheck fails it when code marked @hot calls a cc65 multiply/divide/shift helper.
+# build/soundbench reports the FamiTone update cycles of every song and sound effect, and fails
+# the build when the NMI sound stage could run into the next NMI.
+# The ld65 map gives the RAM the variables take, the C stack grows down from the end of RAM
+# to meet them: the build reports what is left and fails under $stackMin bytes (the game passes
+# its arguments in globals, the C stack only holds those of library calls)
+# NMI_PROFILE=1 assembles the NMI stage probes that nesbench reports on (never ship such a ROM)
+# PERF_OVERLAY=1 builds the game loop CPU load bar and lag counters of src/perfOverlay.h (debug only)
+# MAPPER=unrom builds a 128K UNROM ROM (src/lib/unrom_128_vert.cfg) instead of NROM-256, with
+# the tileset, screens, music and level pack in switchable banks
+# INPUT_LOG=record records every pad poll into a pad log in battery RAM, INPUT_LOG=replay
+# plays it back and INPUT_LOG=replay-best the save's best game (src/inputLog.h, src/save.h);
+# the UNROM ROM has no battery RAM for them
+
+name=NESMaze
+srcDir=src
+libDir=src/lib
+toolDir=tools
+buildDir=build
+benchFrames=1200
+stackMin=32
+CC=${CC:-cc}
+ccFlags=
+asFlags=
+linkConfig=$libDir/nrom_256_vert.cfg
+screenFiles="graphics/title.nss graphics/result_success.nss graphics/result_failure.nss"
+
+if [ -n "$NMI_PROFILE" ]; then
+	asFlags="-D NMI_PROFILE"
+fi
+
+if [ -n "$PERF_OVERLAY" ]; then
+	ccFlags="-D PERF_OVERLAY"
+	asFlags="$asFlags -D PERF_OVERLAY"
+fi
+
+case "${MAPPER:-nrom}" in
+	nrom)
+		;;
+	unrom)
+		ccFlags="$ccFlags -D MAPPER_UNROM"
+		asFlags="$asFlags -D MAPPER_UNROM"
+		linkConfig=$libDir/unrom_128_vert.cfg
+		;;
+	*)
+		echo "unknown MAPPER $MAPPER, use nrom or unrom"
+		exit 1
+		;;
+esac
+
+case "${INPUT_LOG:-off}" in
+	off)
+		;;
+	record)
+		ccFlags="$ccFlags -D INPUT_RECORD"
+		;;
+	replay)
+		ccFlags="$ccFlags -D INPUT_REPLAY"
+		;;
+	replay-best)
+		ccFlags="$ccFlags -D INPUT_REPLAY -D INPUT_BEST"
+		;;
+	*)
+		echo "unknown INPUT_LOG $INPUT_LOG, use record, replay or replay-best"
+		exit 1
+		;;
+esac
+
+fail()
+{
+	echo "build failed"
+	exit 1
+}
+
+levels()
+{
+	$buildDir/levelpack -o $srcDir/nametables/levels.h -m $srcDir/metatiles.h -t $srcDir/gamePhase.h graphics/level_*.nss || fail
+}
+
+screens()
+{
+	$buildDir/screenpack -o $srcDir/nametables/screens.h $@ $screenFiles || fail
+}
+
+sound()
+{
+	$buildDir/soundpack -o $srcDir/soundsAndMusic/music.s sound/music.ftm || fail
+	$buildDir/soundpack -e -o $srcDir/soundsAndMusic/sounds.s sound/sounds.ftm || fail
+}
+
+rom()
+{
+	tools
+	levels
+	screens
+	sound
+
+	cc65 -Oi $ccFlags $srcDir/main.c -g --add-source || fail
+	$buildDir/hotcheck $srcDir/main.s || fail
+	ca65 $libDir/crt0.s -g $asFlags || fail
+	ca65 $srcDir/main.s -g || fail
+	ld65 -C $linkConfig -o $name.nes $libDir/crt0.o $srcDir/main.o nes.lib -Ln $buildDir/labels.txt --dbgfile $buildDir/$name.dbg -m $buildDir/$name.map || fail
+
+	rm -f $srcDir/*.o $libDir/*.o
+
+	stackCheck || fail
+
+	$buildDir/nmicheck -l $buildDir/labels.txt -q $srcDir/vramQueue.h $name.nes || fail
+	$buildDir/soundbench -l $buildDir/labels.txt -s $srcDir/soundsAndMusic/soundsAndMusic.h $name.nes || fail
+}
+
+# Reports the zero page and RAM the segments take in the ld65 map, and the RAM left for the
+# C stack; fails when it is under stackMin bytes
+stackCheck()
+{
+	ram=$(sed -n 's/^[[:space:]]*RAM:[[:space:]]*start = \$\([0-9a-fA-F]*\), size = \$\([0-9a-fA-F]*\).*/\1 \2/p' $linkConfig)
+	set -- $ram
+	awk -v ramStart=$((0x$1)) -v ramEnd=$((0x$1 + 0x$2)) -v stackMin=$stackMin '
+		function hex(s,  i, n)
+		{
+			n = 0
+			s = toupper(s)
+			for (i = 1; i <= length(s); ++i)	n = n*16 + index("0123456789ABCDEF", substr(s, i, 1)) - 1
+			return n
+		}
+		/^Segment list:/					{ segments = 1; next }
+		/^[A-Z][a-z]+ list/					{ segments = 0 }
+		!segments || $2 !~ /^[0-9A-F]+$/	{ next }
+		$1 == "ZEROPAGE"					{ zp = hex($4) }
+		hex($2) >= ramStart && hex($2) < ramEnd && hex($3) + 1 > ramTop	{ ramTop = hex($3) + 1 }
+		END {
+			if (ramTop < ramStart)	ramTop = ramStart
+			printf("zero page %d of 256 bytes, RAM %d of %d bytes, %d left for the C stack",
+				   zp, ramTop - ramStart, ramEnd - ramStart, ramEnd - ramTop)
+			if (ramEnd - ramTop < stackMin)
+			{
+				printf("  UNDER %d\n", stackMin)
+				exit 1
+			}
+			printf("  ok\n")
+		}' $buildDir/$name.map
+}
+
+# First generated level: the one after the level pack
+mazeLevel()
+{
+	sed -n 's/^#define LEVEL_COUNT //p' $srcDir/nametables/levels.h
+}
+
+tools()
+{
+	mkdir -p $buildDir
+
+	$CC -O2 -Wall -o $buildDir/nesbench $toolDir/nesbench.c $toolDir/session.c $toolDir/nesemu.c $toolDir/symbols.c || fail
+	$CC -O2 -Wall -o $buildDir/levelpack $toolDir/levelpack.c || fail
+	$CC -O2 -Wall -o $buildDir/screenpack $toolDir/screenpack.c || fail
+	$CC -O2 -Wall -o $buildDir/soundpack $toolDir/soundpack.c -lm || fail
+	$CC -O2 -Wall -o $buildDir/nmicheck $toolDir/nmicheck.c $toolDir/nesemu.c $toolDir/symbols.c || fail
+	$CC -O2 -Wall -o $buildDir/soundbench $toolDir/soundbench.c $toolDir/nesemu.c $toolDir/symbols.c || fail
+	$CC -O2 -Wall -o $buildDir/hotcheck $toolDir/hotcheck.c || fail
+	$CC -O2 -Wall -o $buildDir/nesprof $toolDir/nesprof.c $toolDir/session.c $toolDir/nesemu.c $toolDir/symbols.c $toolDir/dbginfo.c || fail
+}
+
+case "${1:-rom}" in
+	rom)
+		rom
+		;;
+	tools)
+		tools
+		;;
+	levels)
+		tools
+		levels
+		;;
+	screens)
+		tools
+		screens -b
+		;;
+	sound)
+		tools
+		sound
+		;;
+	bench)
+		rom
+		$buildDir/nesbench -l $buildDir/labels.txt -i $toolDir/bench/session.txt -n $benchFrames $name.nes || fail
+		echo
+		echo "Going on to the first generated level, level $(mazeLevel):"
+		$buildDir/nesbench -l $buildDir/labels.txt -i $toolDir/bench/session.txt -L $(mazeLevel) -n $benchFrames $name.nes || fail
+		;;
+	profile)
+		rom
+		$buildDir/nesprof -l $buildDir/labels.txt -g $buildDir/$name.dbg -i $toolDir/bench/session.txt -n $benchFrames $name.nes || fail
+		echo
+		echo "Going on to the first generated level, level $(mazeLevel):"
+		$buildDir/nesprof -l $buildDir/labels.txt -g $buildDir/$name.dbg -i $toolDir/bench/session.txt -L $(mazeLevel) -n $benchFrames $name.nes || fail
+		;;
+	*)
+		echo "usage: $0 [rom|levels|screens|sound|tools|bench|profile]"
+		exit 1
+		;;
+esac
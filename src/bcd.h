@@ -0,0 +1,98 @@
+/******************************************************************************
+*  @file       	bcd.h
+*  @brief      	Packed-BCD counters and number rendering
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Counters shown on screen are kept in packed BCD, two decimal
+*		digits per byte, least significant byte first, so adding to them
+*		and drawing them needs no multiply or divide (the NES CPU has no
+*		decimal mode, bcdAdd adjusts each digit itself)
+*		> bcdRender turns a number into digit characters with leading
+*		zeros blanked, for the HUD and the result screen
+*		> Arguments are passed in the zeropage bcd variables below
+******************************************************************************/
+
+// Packed BCD constants: a 2-digit byte and a 4-digit word
+#define BCD_BYTE(n)		((((n)/10%10)<<4) | ((n)%10))
+#define BCD_WORD(n)		((BCD_BYTE((n)/100)<<8) | BCD_BYTE(n))
+
+// Characters of digit 0 (1-9 follow it) and of a blanked leading zero
+#define BCD_TILE_0		0x10
+#define BCD_TILE_BLANK	0x00
+
+// Most digits bcdRender draws
+#define BCD_MAX_DIGITS	6
+
+// Characters drawn by bcdRender
+static unsigned char bcdTiles[BCD_MAX_DIGITS];
+
+#pragma bss-name (push,"ZEROPAGE")
+// Number to add to or draw, its size in bytes, and the value to add
+static unsigned char *bcdPtr;
+static unsigned char bcdLen;
+static unsigned int bcdValue;
+// Digits to draw
+static unsigned char bcdDigits;
+// Scratch
+static unsigned char bcdIdx;
+static unsigned char bcdLo;
+static unsigned char bcdHi;
+static unsigned char bcdCarry;
+#pragma bss-name (pop)
+
+// Adds packed BCD bcdValue to the bcdLen byte number at bcdPtr
+// Stops as soon as nothing is left to add, so small values cost a byte or two;
+//	a carry out of the last byte is dropped
+void bcdAdd(void)
+{
+	bcdCarry = 0;
+	for (bcdIdx = 0; bcdIdx < bcdLen; ++bcdIdx)
+	{
+		if (!bcdValue && !bcdCarry)	return;
+
+		bcdLo = (bcdPtr[bcdIdx] & 15) + ((unsigned char)bcdValue & 15) + bcdCarry;
+		bcdHi = (bcdPtr[bcdIdx] >> 4) + ((unsigned char)bcdValue >> 4);
+		if (bcdLo > 9)
+		{
+			bcdLo -= 10;
+			++bcdHi;
+		}
+		bcdCarry = 0;
+		if (bcdHi > 9)
+		{
+			bcdHi -= 10;
+			bcdCarry = 1;
+		}
+		bcdPtr[bcdIdx] = (bcdHi << 4) | bcdLo;
+		bcdValue >>= 8;
+	}
+}
+
+// Draws the lowest bcdDigits digits of the number at bcdPtr into bcdTiles, most
+//	significant first, with leading zeros blanked (the last digit is always drawn)
+// Returns the number of digits left after the blanks
+unsigned char bcdRender(void)
+{
+	bcdCarry = TRUE;	// Still in the leading zeros
+	bcdLen = 0;
+	for (bcdIdx = bcdDigits; bcdIdx--; )
+	{
+		bcdLo = bcdPtr[bcdIdx >> 1];
+		if (bcdIdx & 1)	bcdLo >>= 4;
+		else			bcdLo &= 15;
+
+		if (bcdLo || !bcdIdx)	bcdCarry = FALSE;
+		if (bcdCarry)
+		{
+			bcdTiles[bcdLen] = BCD_TILE_BLANK;
+			--bcdDigits;
+		}
+		else
+		{
+			bcdTiles[bcdLen] = BCD_TILE_0 + bcdLo;
+		}
+		++bcdLen;
+	}
+	return bcdDigits;
+}
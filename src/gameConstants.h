@@ -10,8 +10,14 @@
 ******************************************************************************/
 
 // Game constants
+// Speeds and delays are given in PAL frames (50 per second); NTSC runs 6 frames in the time
+//	of 5, and its tables take 5/6 of each speed and 6/5 of each delay (see PAL_SPEED), or
+//	frameCounter leaves one of its frames in 6 out (see countFrame)
+// Player speed in pixels per frame, and its increase per level (see playerSpeedTable)
 #define START_SPEED 		2
 #define SPEED_UP_PER_LEVEL	0
+// Enemy speed per digit of its level marker, in 1/16 pixels per frame ('4' moves 1 pixel per frame)
+#define ENEMY_SPEED_UNIT	4
 // Delay between display on and game start (minimum 1)
 #define START_DELAY			15
 // Delay between meeting win/lose condition and game screen fade out
@@ -20,5 +26,21 @@
 #define CLEAR_PERC_REQT		50
 // Level the game starts at
 #define LEVEL_START			0
-// Level to clear to win the game
-#define LEVEL_END			3
\ No newline at end of file
+// Level to clear to win the game: the level pack, then the generated levels (up to
+//	the 255 levels gameLevel counts)
+#define LEVEL_END			(LEVEL_COUNT+MAZE_LEVELS)
+// Generated levels after the level pack (see mazeGen.h), and the seed they follow from
+#define MAZE_LEVELS			(255-LEVEL_COUNT)
+#define MAZE_SEED			0x5a3c
+// Generated maze width in map tiles (even, 16-64)
+#define MAZE_WIDTH			16
+// Chance out of 256 of an item on each open map tile, and of opening each wall left
+//	between two maze cells
+#define MAZE_ITEM_DENSITY	192
+#define MAZE_LOOPS			40
+// Enemies per generated level, and their speed digit (1-9, as in the level markers)
+#define MAZE_ENEMIES		2
+#define MAZE_ENEMY_SPEED	2
+// PRG bank of the LEVELS0 segment in UNROM builds, LEVELSn is BANK_LEVELS+n
+//	(see src/lib/unrom_128_vert.cfg)
+#define BANK_LEVELS			2
\ No newline at end of file
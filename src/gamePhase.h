@@ -9,10 +9,8 @@
 *		> Holds code used exclusively in the game phase
 ******************************************************************************/
 
-// Level map nametables
-#include "nametables/level_test.h"
-#include "nametables/level_test2.h"
-#include "nametables/level_test3.h"
+// Level pack (levelTable, LEVEL_COUNT) in the compact format written by tools/levelpack.c
+#include "nametables/levels.h"
 
 // Level map palettes
 const unsigned char pal_level_test[16] = { 0x0f,0x00,0x10,0x30,0x0f,0x01,0x21,0x31,0x0f,0x06,0x16,0x26,0x0f,0x09,0x19,0x29 };
@@ -21,41 +19,112 @@ const unsigned char pal_level_test[16] = { 0x0f,0x00,0x10,0x30,0x0f,0x01,0x21,0x
 const unsigned char palGameSpr[16] = { 0x0f,0x0f,0x29,0x30,0x0f,0x0f,0x26,0x30,0x0f,0x0f,0x24,0x30,0x0f,0x0f,0x21,0x30 };
 
 // Max size of the game map (in number of map tiles)
-#define MAP_WIDTH		16
-#define MAP_WIDTH_BIT	4
+// Maps are one screen tall; wider maps scroll horizontally
+#define MAP_MAX_WIDTH	64
+#define MAP_ROW_BIT		5		// map[] row size in bytes (2^5), two map tiles per byte
 #define MAP_HEIGHT		13
 
+// Width of the screen and of the two nametables side by side (in number of map tiles)
+#define SCREEN_WIDTH	16
+#define NAME_COLUMNS	32
+
 // Number of rows occupied by the HUD at the top of the screen
 #define HUD_HEIGHT		2
 
-#define MAP_START_ADR	(NTADR_A(0, HUD_HEIGHT<<1))
+// Nametable column (in map tiles) of map tile column c: the map is drawn nameRot columns
+//	along, wrapping around the two nametables, so the next level can go beside the one on screen
+#define NAME_COLUMN(c)	((unsigned char)((c)+nameRot))
+
+// Nametable address of the top of map tile column c
+// Nametable columns 0-15 are in A, 16-31 in B, then A again
+#define COLUMN_ADR(c)	(((NAME_COLUMN(c)&16) ? NAMETABLE_B : NAMETABLE_A) + (HUD_HEIGHT<<6) + ((NAME_COLUMN(c)&15)<<1))
 
-// Macro for calculating nametable address from tile coordinates
-// x and y are in tile coordinates
-// Multiply both by 2 (<<1) to convert tiles to bytes (1 tile = 2 bytes)
-// Multiply y by 32 (<<5) to get the starting row address (1 row = 32 bytes)
-// Then add x (y'|x') for the column address
-#define NAM_ADR(x,y)	(MAP_START_ADR + (((y)-HUD_HEIGHT)<<6) | ((x)<<1))
+// Nametable address of the upper left character of map tile x,y: the nametable base plus
+//	character row*32 + character column, a map tile being 2x2 characters (y*64 + x*2,
+//	with the base, the HUD rows and x in COLUMN_ADR)
+#define NAM_ADR(x,y)	(COLUMN_ADR(x) + (((y)-HUD_HEIGHT)<<6))
+// Macro for calculating attribute table address from tile coordinates
+// One attribute byte covers 2x2 map tiles
+#define ATTR_ADR(x,y)	(((NAME_COLUMN(x)&16) ? NAMETABLE_B : NAMETABLE_A) + 0x3c0 + (((y)>>1)<<3) + ((NAME_COLUMN(x)&15)>>1))
 // Macro for calculating map offset from tile coordinates
-// Explanation is similar to above, but with 0 start adr,
-// different row width, and no need for conversion to bytes
-#define MAP_ADR(x,y)	((((y)-HUD_HEIGHT)<<MAP_WIDTH_BIT) | (x))
+// Two map tiles per byte, x&1 selects the nibble
+#define MAP_ADR(x,y)	((((y)-HUD_HEIGHT)<<MAP_ROW_BIT) | ((x)>>1))
+// Each map tile nibble is a metatile ID (MAP_TILE_MASK) plus the occupancy bit, set while
+//	an enemy stands on the map tile or is moving into it
+#define MAP_TILE_MASK	7
+#define MAP_TAKEN		8
+
+// Camera: the player is kept this many pixels from the left edge of the screen
+#define CAMERA_OFFSET	120
+// Map tile columns kept in the nametables left of the camera
+//	(SCREEN_WIDTH+1 are visible, the rest of the NAME_COLUMNS are to the right)
+#define STREAM_MARGIN	7
+
+// Sprite 0 sits behind the bottom row of the first HUD label letter, so it hits
+//	on the last scanline of the labels and the map below scrolls. The floor tile
+//	is drawn in sprite color 1, which is black in every sprite palette
+#define SPLIT_SPR_X		32
+#define SPLIT_SPR_Y		22
+#define SPLIT_SPR_TILE	0x44
 
 // Size of a map tile
 #define TILE_SIZE		16		// Tiles are 16x16 bits
 #define TILE_SIZE_BIT	4		// Movement within tile can be represented with 4 bits (2^4)
 
-// Used for converting position variables to tile coordinates
-#define TILE_PLUS_FP_BITS	(TILE_SIZE_BIT + FP_BITS)
+// Player speed of each level, in 1/16 pixels per frame (one map tile is 256, so at most
+//	15 pixels per frame); levels past the table keep its last speed
+#define SPEED_LEVELS		8
+#define PLAYER_SPEED(n)		((START_SPEED + SPEED_UP_PER_LEVEL*(n)) << FP_BITS)
+
+// A speed per PAL frame as the 8.8 fixed point speed per frame of each region: the high
+//	byte moves every frame, the low byte is a fraction that adds up and moves one more
+//	whenever it carries, so NTSC covers in 6 frames what PAL does in 5
+#define PAL_SPEED(s)		((unsigned)(s) << 8)
+#define NTSC_SPEED(s)		((unsigned)(((s)*1280L + 3)/6))
+#define ENEMY_SPEED(n)		((n)*ENEMY_SPEED_UNIT)
 
-// Tile code legend, i.e. what codes in level maps mean
+// Level marker codes, the upper left character of map tiles in the level maps
+//	that only mark a position (the game draws them as MT_EMPTY)
 #define TILE_START		0x33	// 'S'
-#define TILE_EXIT		0x25	// 'E'
-#define TILE_WALL		0x40	// Upper-left corner of wall tile
-#define TILE_EMPTY		0x44	// Empty tile
-#define TILE_HOLE		0x00	// Blank "lose condition" tile
-#define TILE_ITEM		0x45	// Upper-left corner of item tile
-#define TILE_ENEMY		0x10	// '0'
+#define TILE_ENEMY		0x10	// '0', '0'-'9' give the enemy speed (ENEMY_SPEED_UNIT steps)
+
+// Map tile contents: metatile IDs, characters, palettes and flags
+#include "metatiles.h"
+
+// Compact level format: start x,y, item count, map width, enemy count, then x,y and
+//	speed of each enemy, then the map rows at 4 bits per map tile (metatile ID),
+//	2 map tiles per byte, low nibble first
+#define LEVEL_START_X		0
+#define LEVEL_START_Y		1
+#define LEVEL_ITEMS			2
+#define LEVEL_WIDTH			3
+#define LEVEL_ENEMIES		4
+#define LEVEL_ENEMY_LIST	5
+#define LEVEL_ENEMY_SIZE	3
+
+// Enemies per level, each one is an entry of the enemy_ arrays
+#define ENEMY_MAX			8
+// Enemy AI decisions per frame; enemies take turns, so the cost does not grow with their number
+#define ENEMY_AI_PER_FRAME	2
+
+// Enemy states
+#define ENEMY_STAND		0	// Never moves (speed 0)
+#define ENEMY_WAIT		1	// On a map tile, waiting for its AI turn to pick a direction
+#define ENEMY_MOVE		2	// Moving to the next map tile in enemy_dir
+
+// Opposite direction (up/down and left/right are neighboring pad bits)
+#define DIR_REVERSE(d)	(((d)&(DIR_UP|DIR_LEFT)) ? (d)<<1 : (d)>>1)
+
+// Flow field towards the player over the map tile columns in the nametables, packed
+//	like map[] at 4 bits per map tile: bits 0-1 are the enemyDirs index of the step
+//	towards the player, FLOW_VALID is set when that step is known
+#define FLOW_ADR(x,y)	((((y)-HUD_HEIGHT)<<4) | (((x)&(NAME_COLUMNS-1))>>1))
+#define FLOW_VALID		4
+// Map tiles the flow field reached in the current pass, one bit each
+#define VISIT_ADR(x,y)	((((y)-HUD_HEIGHT)<<2) | (((x)&(NAME_COLUMNS-1))>>3))
+// Flow field search queue size (power of two), and map tiles searched per frame
+#define FLOW_QUEUE_SIZE			32
+#define FLOW_TILES_PER_FRAME	6
 
 // Nametable position and length of HUD labels
 #define HUD_LABELS_ADR 	(NTADR_A(4,2))
@@ -85,278 +154,1104 @@ const unsigned char enemyMetasprite[] =
 	MS_EOF
 };
 
-// Pre-initialized update list used during gameplay
-#define UPDATE_LIST_SIZE (8*3 + 8 + 6 + 1)
-const unsigned char updateListData[UPDATE_LIST_SIZE] =
-{
-	// "Empty" tile used to replace "item" tiles after their item has been collected
-	0x28,0x00,TILE_EMPTY,
-	0x28,0x00,TILE_EMPTY,
-	0x28,0x00,TILE_EMPTY,
-	0x28,0x00,TILE_EMPTY,
-	// Blank tile used to replace tiles that player has just left
-	0x28,0x00,TILE_HOLE,
-	0x28,0x00,TILE_HOLE,
-	0x28,0x00,TILE_HOLE,
-	0x28,0x00,TILE_HOLE,
-	
-	// Horizontal update sequences
-	// 5-digit HUD display for total collected items (all levels), initialized to "0"
-	MSB(NTADR_A(11,2))|NT_UPD_HORZ,LSB(NTADR_A(11,2)),5,0x10,0x10,0x10,0x10,0x10,
-	// 3-digit HUD display for percent clear, initialized to "0"
-	MSB(NTADR_A(23,2))|NT_UPD_HORZ,LSB(NTADR_A(23,2)),3,0x10,0x10,0x10,
-	
-	// End of file marker for VRAM update list
-	NT_UPD_EOF
-};
+// Nametable positions of the HUD counters
+#define HUD_TOTAL_ADR	(NTADR_A(11,2))
+#define HUD_PERCENT_ADR	(NTADR_A(23,2))
+
+// Array for game map, contains the metatile ID of every map tile, two per byte
+static unsigned char map[(MAP_MAX_WIDTH>>1)*MAP_HEIGHT];
+
+// Two nametable columns (one column of map tiles), left then right
+static unsigned char nameColumn[MAP_HEIGHT<<2];
 
-// Update list
-static unsigned char updateList[UPDATE_LIST_SIZE];
+#ifdef MAPPER_UNROM
+// PRG bank mapped before loadLevel maps the level's, mapped back once the level is read
+static unsigned char levelPrevBank;
+#endif
 
-// Array for game map, contains walls, empty spaces, and items
-static unsigned char map[MAP_WIDTH*MAP_HEIGHT];
+#pragma bss-name (push,"ZEROPAGE")
+// Level being decoded
+static const unsigned char *levelData;
+// Camera x in pixels, and its limit for the map width
+static unsigned int camX;
+static unsigned int camMaxX;
+#pragma bss-name (pop)
 
-// This array is used to convert nametable into game map, row by row
-static unsigned char nameRow[32];
+// Map width in number of map tiles
+static unsigned char mapWidth;
+// Leftmost map tile column in the nametables (they hold NAME_COLUMNS from there),
+//	and its limit for the map width
+static unsigned char mapColumnLeft;
+static unsigned char mapColumnMax;
+
+// Nametable column of map tile column 0 (even, so an attribute byte keeps its two map tile
+//	columns), and the same in pixels for the scroll
+static unsigned char nameRot;
+static unsigned int nameScroll;
+// Whether the map scrolls below the HUD split (it is wider than the screen, or rotated)
+static unsigned char mapSplit;
+// Nametable columns that hold their map tile column of the current level, a bit each
+static unsigned char nameDrawn[NAME_COLUMNS>>3];
+
+// Order the map tile columns of a new level are drawn in without turning the display off
+//	(fillColumnAt): the fillCount on screen from fillView first, of the fillWidth
+//	the nametables hold; fillNext is the next one to look at
+static unsigned char fillView;
+static unsigned char fillCount;
+static unsigned char fillWidth;
+static unsigned char fillNext;
+// Nametable columns on screen while the next level is prepared, from nameShown
+static unsigned char nameShown;
+static unsigned char nameShownCount;
+// Whether the next level is loaded and drawn beside the one on screen (prepareLevel)
+static unsigned char levelSwap;
 
 // Number of items on current level
 static unsigned char levelItemsCount;
 // Number of items collected in current level
 static unsigned char levelItemsCollected;
-// Percent of items collected in current level
-static unsigned char percentCollected;
+// Percent of items collected in current level, packed BCD, and the remainders of
+//	100/levelItemsCount added up so far (see collectItem)
+static unsigned int percentCollected;
+static unsigned char percentRemainder;
+// Percent per item of the current level: 100/levelItemsCount in packed BCD, and the remainder
+static unsigned int percentStep;
+static unsigned char percentStepRem;
+
+// Player speed of each level, and enemy speed of each level marker digit, per region
+const unsigned int playerSpeedTable[2][SPEED_LEVELS] =
+{
+	{
+		PAL_SPEED(PLAYER_SPEED(0)), PAL_SPEED(PLAYER_SPEED(1)), PAL_SPEED(PLAYER_SPEED(2)), PAL_SPEED(PLAYER_SPEED(3)),
+		PAL_SPEED(PLAYER_SPEED(4)), PAL_SPEED(PLAYER_SPEED(5)), PAL_SPEED(PLAYER_SPEED(6)), PAL_SPEED(PLAYER_SPEED(7))
+	},
+	{
+		NTSC_SPEED(PLAYER_SPEED(0)), NTSC_SPEED(PLAYER_SPEED(1)), NTSC_SPEED(PLAYER_SPEED(2)), NTSC_SPEED(PLAYER_SPEED(3)),
+		NTSC_SPEED(PLAYER_SPEED(4)), NTSC_SPEED(PLAYER_SPEED(5)), NTSC_SPEED(PLAYER_SPEED(6)), NTSC_SPEED(PLAYER_SPEED(7))
+	}
+};
+const unsigned int enemySpeedTable[2][10] =
+{
+	{
+		PAL_SPEED(ENEMY_SPEED(0)), PAL_SPEED(ENEMY_SPEED(1)), PAL_SPEED(ENEMY_SPEED(2)), PAL_SPEED(ENEMY_SPEED(3)),
+		PAL_SPEED(ENEMY_SPEED(4)), PAL_SPEED(ENEMY_SPEED(5)), PAL_SPEED(ENEMY_SPEED(6)), PAL_SPEED(ENEMY_SPEED(7)),
+		PAL_SPEED(ENEMY_SPEED(8)), PAL_SPEED(ENEMY_SPEED(9))
+	},
+	{
+		NTSC_SPEED(ENEMY_SPEED(0)), NTSC_SPEED(ENEMY_SPEED(1)), NTSC_SPEED(ENEMY_SPEED(2)), NTSC_SPEED(ENEMY_SPEED(3)),
+		NTSC_SPEED(ENEMY_SPEED(4)), NTSC_SPEED(ENEMY_SPEED(5)), NTSC_SPEED(ENEMY_SPEED(6)), NTSC_SPEED(ENEMY_SPEED(7)),
+		NTSC_SPEED(ENEMY_SPEED(8)), NTSC_SPEED(ENEMY_SPEED(9))
+	}
+};
+// Delay before the game starts, and the one after the last level ends, per region
+const unsigned char startDelayTable[2] = { START_DELAY, NTSC_FRAMES(START_DELAY) };
+const unsigned char endDelayTable[2] = { END_DELAY, NTSC_FRAMES(END_DELAY) };
 
 // Player variables
-static unsigned int player_x;
-static unsigned int player_y;
+// Positions are kept as separate bytes: the map tile the player is on or leaving
+//	(prevTile) and the one it moves into (nextTile), the move progress in 1/16 pixels
+//	(one map tile is 256), and the pixel position, moved by whole pixels as the progress
+//	crosses them, so tile coordinates and pixels are read directly and never shifted
+//	out of a fixed point value. player_dir is DIR_NONE while standing
+static unsigned int player_pixX;
+static unsigned char player_pixY;
+static unsigned char player_step;
 static unsigned char player_nextTileX;
 static unsigned char player_nextTileY;
 static unsigned char player_prevTileX;
 static unsigned char player_prevTileY;
 static unsigned char player_dir;
 static unsigned char player_nextDir;
-static int player_moveCounter;
-static unsigned int player_speed;
+// Speed in 1/16 pixels per frame, its fraction, and the fractions added up so far (see PAL_SPEED)
+static unsigned char player_speed;
+static unsigned char player_speedFrac;
+static unsigned char player_frac;
+
+// Enemy table, a structure of arrays indexed by enemy number
+// Map tile the enemy stands on or is leaving, and its position in pixels
+static unsigned char enemy_tileX[ENEMY_MAX];
+static unsigned char enemy_tileY[ENEMY_MAX];
+static unsigned int enemy_x[ENEMY_MAX];
+static unsigned char enemy_y[ENEMY_MAX];
+static unsigned char enemy_state[ENEMY_MAX];
+// Direction it moves in, and the one the AI picked for the map tile it is moving to
+static unsigned char enemy_dir[ENEMY_MAX];
+static unsigned char enemy_nextDir[ENEMY_MAX];
+// Speed, and distance covered towards the next map tile, in 1/16 pixels (one map tile is 256)
+static unsigned char enemy_speed[ENEMY_MAX];
+static unsigned char enemy_step[ENEMY_MAX];
+// Fraction of the speed, and the fractions added up so far (see PAL_SPEED)
+static unsigned char enemy_speedFrac[ENEMY_MAX];
+static unsigned char enemy_frac[ENEMY_MAX];
+
+// Move of the player or enemy being moved this frame, in 1/16 pixels, and what is left
+//	of it past the map tile it reaches, which goes on into the next one
+static unsigned char moveSpeed;
+static unsigned char moveCarry;
+
+// Spawned enemies: only the enemy numbers listed here are updated or drawn,
+//	so despawned enemies cost nothing
+static unsigned char enemyList[ENEMY_MAX];
+static unsigned char enemyCount;
+// Position in enemyList of the next enemy to get an AI turn
+static unsigned char enemyNextAI;
+
+// Candidate directions of the enemy AI and the flow field, index^2 is the opposite one
+const unsigned char enemyDirs[4] = { DIR_LEFT, DIR_UP, DIR_RIGHT, DIR_DOWN };
+
+// Flow field, reached map tiles, and the breadth-first search queue (map tile x,y)
+static unsigned char flowField[(NAME_COLUMNS>>1)*MAP_HEIGHT];
+static unsigned char flowVisited[(NAME_COLUMNS>>3)*MAP_HEIGHT];
+static unsigned char flowQueueX[FLOW_QUEUE_SIZE];
+static unsigned char flowQueueY[FLOW_QUEUE_SIZE];
+
+// Map tile columns streamed into the nametables forget their flow field (defined with
+//	the flow field code below)
+void clearFlowColumn(void);
 
-// Enemy variables
-static unsigned char enemy_tileX;
-static unsigned char enemy_tileY;
+// Bit of each x&7 in flowVisited and nameDrawn
+const unsigned char bitMask[8] = { 0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80 };
 
-// Exit position
-static unsigned char exit_tileX;
-static unsigned char exit_tileY;
+#pragma bss-name (push,"ZEROPAGE")
+// Enemy being updated, position in enemyList, and the map tile an AI decision is for
+static unsigned char enemyId;
+static unsigned char enemyLoop;
+static unsigned char enemyTileX;
+static unsigned char enemyTileY;
+// Flow field search: queue ends, the map tile the current pass started from (the player's),
+//	and the map tile being expanded
+static unsigned char flowHead;
+static unsigned char flowTail;
+static unsigned char flowRootX;
+static unsigned char flowRootY;
+static unsigned char flowX;
+static unsigned char flowY;
+static unsigned char flowDir;
+static unsigned char flowIdx;
+static unsigned char flowCount;
+// nameDrawn bit of the map tile column being drawn (its byte is in i)
+static unsigned char nameBit;
+#pragma bss-name (pop)
 
 // Whether current game level is done
 static unsigned char levelDone;
 
-// Increments the total number of items collected by 1
-void incrementTotalItemsCollected(void)
+// Levels past the level pack
+#include "mazeGen.h"
+
+// Counts one more collected item: adds 1 to the total, up to 99999, and the level's
+//	percent per item to the percent, plus 1 each time the remainders add up to the
+//	item count. Costs the same few BCD digit adds for every item
+void collectItem(void)
 {
-	totalItemsCollected1++;
-	if (totalItemsCollected1 == 10)
+	++levelItemsCollected;
+	
+	bcdPtr = totalItemsCollected;
+	bcdLen = TOTAL_ITEMS_BYTES;
+	bcdValue = 1;
+	bcdAdd();
+	if (totalItemsCollected[TOTAL_ITEMS_BYTES-1] > 9)
+	{
+		totalItemsCollected[0] = 0x99;
+		totalItemsCollected[1] = 0x99;
+		totalItemsCollected[2] = 0x09;
+	}
+	
+	bcdPtr = (unsigned char*)&percentCollected;
+	bcdLen = 2;
+	bcdValue = percentStep;
+	// Remainders that reach the item count (compared before adding, the sum can pass 255)
+	i = levelItemsCount - percentStepRem;
+	if (percentRemainder >= i)
 	{
-		totalItemsCollected2++;
-		totalItemsCollected1 = 0;
+		percentRemainder -= i;
+		++bcdValue;		// bcdAdd copes with a low digit of 10
 	}
-	if (totalItemsCollected2 == 10)
+	else
 	{
-		totalItemsCollected3++;
-		totalItemsCollected2 = 0;
+		percentRemainder += percentStepRem;
 	}
-	if (totalItemsCollected3 == 10)
+	bcdAdd();
+}
+
+// Queues the HUD counters for display
+// @hot
+void updateHUD(void)
+{
+	// Total collected in game
+	bcdPtr = totalItemsCollected;
+	bcdDigits = TOTAL_ITEMS_DIGITS;
+	bcdRender();
+	vramQueueRun(NT_UPD_HORZ, HUD_TOTAL_ADR, bcdTiles, TOTAL_ITEMS_DIGITS);
+	// Percent collected in current level
+	bcdPtr = (unsigned char*)&percentCollected;
+	bcdDigits = 3;
+	bcdRender();
+	vramQueueRun(NT_UPD_HORZ, HUD_PERCENT_ADR, bcdTiles, 3);
+}
+
+// Returns the metatile ID of the map tile at px,py
+unsigned char mapTileAt(void)
+{
+	if (px&1)	return (map[MAP_ADR(px,py)] >> 4) & MAP_TILE_MASK;
+	return map[MAP_ADR(px,py)] & MAP_TILE_MASK;
+}
+
+// Returns non-zero when an enemy has taken the map tile at px,py
+unsigned char mapTileTaken(void)
+{
+	if (px&1)	return map[MAP_ADR(px,py)] & (MAP_TAKEN<<4);
+	return map[MAP_ADR(px,py)] & MAP_TAKEN;
+}
+
+// Sets (taken TRUE) or clears the occupancy bit of the map tile at px,py
+void takeMapTile(unsigned char taken)
+{
+	i16 = MAP_ADR(px,py);
+	spr = (px&1) ? MAP_TAKEN<<4 : MAP_TAKEN;
+	if (taken)	map[i16] |= spr;
+	else		map[i16] &= ~spr;
+}
+
+// Returns the attribute byte of the 2x2 map tiles that include px,py
+// A map byte holds exactly the two map tiles of an attribute column
+unsigned char mapAttrAt(void)
+{
+	i16 = MAP_ADR(px, py&~1);
+	spr = map[i16];
+	spr = (metatileAttr[spr&MAP_TILE_MASK] & 0x03) | (metatileAttr[(spr>>4)&MAP_TILE_MASK] & 0x0c);
+	
+	// The last map row has no map row below it
+	if ((py|1) < MAP_HEIGHT+HUD_HEIGHT)
 	{
-		totalItemsCollected4++;
-		totalItemsCollected3 = 0;
+		ptr = map[i16 + (1<<MAP_ROW_BIT)];
+		spr |= (metatileAttr[ptr&MAP_TILE_MASK] & 0x30) | (metatileAttr[(ptr>>4)&MAP_TILE_MASK] & 0xc0);
 	}
-	if (totalItemsCollected4 == 10)
+	return spr;
+}
+
+// Changes the map tile at px,py to metatile id and queues its characters,
+//	plus its attribute byte when the palette changes
+void setMapTile(unsigned char id)
+{
+	// Palette of the metatile being replaced, before the map changes
+	ptr = metatileAttr[mapTileAt()];
+	
+	i16 = MAP_ADR(px,py);
+	if (px&1)	map[i16] = (map[i16] & (0x0f|(MAP_TAKEN<<4))) | (id << 4);
+	else		map[i16] = (map[i16] & (0xf0|MAP_TAKEN)) | id;
+	
+	// Map tiles outside the nametables are drawn when their column is streamed in
+	if ((unsigned char)(px - mapColumnLeft) >= NAME_COLUMNS)	return;
+	
+	i16 = NAM_ADR(px,py);
+	spr = id << 2;
+	vramQueuePut(i16, metatileChars[spr]);			// Upper left
+	vramQueuePut(i16+1, metatileChars[spr+1]);		// Upper right
+	vramQueuePut(i16+32, metatileChars[spr+2]);		// Lower left
+	vramQueuePut(i16+33, metatileChars[spr+3]);		// Lower right
+	
+	if (ptr != metatileAttr[id])	vramQueuePut(ATTR_ADR(px,py), mapAttrAt());
+}
+
+// Sets nameBit and i to the nameDrawn bit and byte of map tile column px
+void findNameBit(void)
+{
+	i = NAME_COLUMN(px) & (NAME_COLUMNS-1);
+	nameBit = bitMask[i&7];
+	i >>= 3;
+}
+
+// Builds the characters of map tile column px into nameColumn, and marks it drawn
+void buildMapColumn(void)
+{
+	findNameBit();
+	nameDrawn[i] |= nameBit;
+	
+	i16 = px >> 1;
+	for (i = 0; i < MAP_HEIGHT<<1; i += 2)
 	{
-		totalItemsCollected5++;
-		totalItemsCollected4 = 0;
+		spr = map[i16];
+		if (px&1)	spr >>= 4;
+		spr = (spr & MAP_TILE_MASK) << 2;
+		nameColumn[i] = metatileChars[spr];							// Upper left
+		nameColumn[i+1] = metatileChars[spr+2];						// Lower left
+		nameColumn[i+(MAP_HEIGHT<<1)] = metatileChars[spr+1];		// Upper right
+		nameColumn[i+(MAP_HEIGHT<<1)+1] = metatileChars[spr+3];		// Lower right
+		i16 += 1<<MAP_ROW_BIT;
 	}
-	if (totalItemsCollected5 == 10)
+}
+
+// Draws map tile column px into the nametables (display must be off)
+void drawMapColumn(void)
+{
+	buildMapColumn();
+	
+	vram_inc(1);
+	vram_adr(COLUMN_ADR(px));
+	vram_write(nameColumn, MAP_HEIGHT<<1);
+	vram_adr(COLUMN_ADR(px)+1);
+	vram_write(nameColumn+(MAP_HEIGHT<<1), MAP_HEIGHT<<1);
+	vram_inc(0);
+	
+	for (py = HUD_HEIGHT; py < MAP_HEIGHT+HUD_HEIGHT; py += 2)
 	{
-		totalItemsCollected1 = 9;
-		totalItemsCollected2 = 9;
-		totalItemsCollected3 = 9;
-		totalItemsCollected4 = 9;
-		totalItemsCollected5 = 9;
+		vram_adr(ATTR_ADR(px,py));
+		vram_put(mapAttrAt());
 	}
 }
 
-// Updates HUD values through the update list
-void updateHUD(void)
+// Queues map tile column px for drawing into the nametables
+void queueMapColumn(void)
 {
-	// Total collected in game
-	updateList[27] = 0x10 + totalItemsCollected5;
-	updateList[28] = 0x10 + totalItemsCollected4;
-	updateList[29] = 0x10 + totalItemsCollected3;
-	updateList[30] = 0x10 + totalItemsCollected2;
-	updateList[31] = 0x10 + totalItemsCollected1;
-	// Percent collected in current level
-	updateList[35] = 0x10 + percentCollected/100;
-	updateList[36] = 0x10 + percentCollected/10%10;
-	updateList[37] = 0x10 + percentCollected%10;
+	buildMapColumn();
+	
+	vramQueueRun(NT_UPD_VERT, COLUMN_ADR(px), nameColumn, MAP_HEIGHT<<1);
+	vramQueueRun(NT_UPD_VERT, COLUMN_ADR(px)+1, nameColumn+(MAP_HEIGHT<<1), MAP_HEIGHT<<1);
+	
+	for (py = HUD_HEIGHT; py < MAP_HEIGHT+HUD_HEIGHT; py += 2)
+	{
+		vramQueuePut(ATTR_ADR(px,py), mapAttrAt());
+	}
 }
 
-// Checks whether player can move in the specified direction,
-//	and updates player move variables if so
-void checkPlayerMove(unsigned char dir)
+// Keeps the player CAMERA_OFFSET pixels from the left screen edge within the map,
+//	and sets j to the leftmost map tile column the nametables should hold for it
+void updateCamera(void)
 {
-	px = player_x >> TILE_PLUS_FP_BITS;
-	py = player_y >> TILE_PLUS_FP_BITS;
+	camX = player_pixX;
+	camX = camX > CAMERA_OFFSET ? camX - CAMERA_OFFSET : 0;
+	if (camX > camMaxX)	camX = camMaxX;
 	
-	// Prevent moving off the left screen edge
-	// TODO: Need checks for other edges?
-	if (px == 0 && dir == DIR_LEFT)	return;
+	j = camX >> TILE_SIZE_BIT;
+	j = j > STREAM_MARGIN ? j - STREAM_MARGIN : 0;
+	if (j > mapColumnMax)	j = mapColumnMax;
+}
+
+// Streams in one map tile column towards the columns the camera needs (j from updateCamera)
+// The camera moves less than a map tile per frame, so one column per frame keeps up
+void streamMapColumn(void)
+{
+	if (j > mapColumnLeft)
+	{
+		// The leftmost column is replaced by the one after the rightmost
+		px = mapColumnLeft + NAME_COLUMNS;
+		++mapColumnLeft;
+		queueMapColumn();
+		clearFlowColumn();
+	}
+	else if (j < mapColumnLeft)
+	{
+		--mapColumnLeft;
+		px = mapColumnLeft;
+		queueMapColumn();
+		clearFlowColumn();
+	}
+}
+
+// Sets px to the map tile column at k in the fill order: the fillCount columns on screen
+//	from fillView, then the others alternately right and left of them, wrapped into the
+//	fillWidth columns the nametables hold from mapColumnLeft
+void fillColumnAt(unsigned char k)
+{
+	if (k < fillCount)
+	{
+		px = fillView + k;
+	}
+	else
+	{
+		k -= fillCount;
+		px = (k&1) ? fillView - 1 - (k>>1) : fillView + fillCount + (k>>1);
+	}
+	px = mapColumnLeft + ((px - mapColumnLeft) & (fillWidth-1));
+}
+
+// Queues the next map tile column in the fill order that a level swap has left undrawn,
+//	once the queue is empty (a column takes two frames of the budget)
+void fillMapColumn(void)
+{
+	if (fillNext == fillWidth || vqHead != vqTail)	return;
 	
+	do
+	{
+		fillColumnAt(fillNext);
+		++fillNext;
+		findNameBit();
+		if (!(nameDrawn[i] & nameBit))
+		{
+			queueMapColumn();
+			return;
+		}
+	}
+	while (fillNext != fillWidth);
+}
+
+// Moves px,py one map tile in direction dir; returns FALSE at the map edges
+unsigned char stepTile(unsigned char dir)
+{
 	switch (dir)
 	{
-	case DIR_LEFT:	--px;	break;
-	case DIR_RIGHT:	++px;	break;
-	case DIR_UP:	--py;	break;
-	case DIR_DOWN:	++py;	break;
+	case DIR_LEFT:
+		if (px == 0)	return FALSE;
+		--px;
+		break;
+	case DIR_RIGHT:
+		if (px == mapWidth-1)	return FALSE;
+		++px;
+		break;
+	case DIR_UP:
+		if (py == HUD_HEIGHT)	return FALSE;
+		--py;
+		break;
+	case DIR_DOWN:
+		if (py == MAP_HEIGHT+HUD_HEIGHT-1)	return FALSE;
+		++py;
+		break;
 	}
+	return TRUE;
+}
+
+// Moves the player i pixels in its direction
+// @hot
+void shiftPlayer(void)
+{
+	switch (player_dir)
+	{
+		case DIR_RIGHT:	player_pixX += i;	break;
+		case DIR_LEFT:	player_pixX -= i;	break;
+		case DIR_DOWN:	player_pixY += i;	break;
+		case DIR_UP:	player_pixY -= i;	break;
+	}
+}
+
+// Checks whether player can move in the specified direction,
+//	and updates player move variables if so
+// @hot
+void checkPlayerMove(unsigned char dir)
+{
+	px = player_prevTileX;
+	py = player_prevTileY;
+	
+	// Prevent moving off the map edges
+	if (!stepTile(dir))	return;
 	
-	if (map[MAP_ADR(px,py)] == TILE_WALL)	return;
+	if (metatileFlags[mapTileAt()] & MTF_SOLID)	return;
 	
 	player_nextTileX = px;
 	player_nextTileY = py;
 	
-	player_moveCounter = TILE_SIZE << FP_BITS;
+	player_step = 0;
 	player_dir = dir;
 	player_nextDir = dir;
 }
 
-// Initializes the game screen, loading the HUD and parsing map data from the nametable for the current level
-void initGameMap(void)
+// Returns the flow field value of the map tile at px,py
+unsigned char flowAt(void)
 {
-	// Clear sprites
-	oam_clear();
+	if (px&1)	return flowField[FLOW_ADR(px,py)] >> 4;
+	return flowField[FLOW_ADR(px,py)] & 15;
+}
+
+// Sets the flow field value of the map tile at px,py
+void setFlow(unsigned char value)
+{
+	flowIdx = FLOW_ADR(px,py);
+	if (px&1)	flowField[flowIdx] = (flowField[flowIdx] & 0x0f) | (value << 4);
+	else		flowField[flowIdx] = (flowField[flowIdx] & 0xf0) | value;
+}
+
+// Starts a new flow field pass from map tile flowRootX,flowRootY
+// Map tiles keep their step from earlier passes until this pass reaches them,
+//	those steps lead to where the player was, close to where it is
+void restartFlowField(void)
+{
+	memfill(flowVisited, 0, sizeof(flowVisited));
+	px = flowRootX;
+	py = flowRootY;
+	flowVisited[VISIT_ADR(px,py)] |= bitMask[px&7];
+	setFlow(0);
+	flowQueueX[0] = px;
+	flowQueueY[0] = py;
+	flowHead = 0;
+	flowTail = 1;
+}
+
+// Extends the flow field pass by up to FLOW_TILES_PER_FRAME map tiles (breadth-first,
+//	so the map tiles nearest the player come first), and restarts it whenever the
+//	player gets to another map tile. Walls and holes are never entered
+void updateFlowField(void)
+{
+	// The map tile nearest to the player
+	if (player_step & 0x80)
+	{
+		px = player_nextTileX;
+		py = player_nextTileY;
+	}
+	else
+	{
+		px = player_prevTileX;
+		py = player_prevTileY;
+	}
+	if (px != flowRootX || py != flowRootY)
+	{
+		flowRootX = px;
+		flowRootY = py;
+		restartFlowField();
+	}
 	
-	// Unpack level nametable into VRAM
-	vram_adr(NAMETABLE_A);
-	// TODO: Improve!
-	switch (gameLevel)
+	for (flowCount = 0; flowCount < FLOW_TILES_PER_FRAME && flowHead != flowTail; ++flowCount)
 	{
-		case 0: 	vram_unrle(level_test);		break;
-		case 1:		vram_unrle(level_test2);	break;
-		default:	vram_unrle(level_test3);	break;
+		flowX = flowQueueX[flowHead];
+		flowY = flowQueueY[flowHead];
+		flowHead = (flowHead + 1) & (FLOW_QUEUE_SIZE-1);
+		
+		// Became a hole since it was queued
+		px = flowX;
+		py = flowY;
+		if (metatileFlags[mapTileAt()] & MTF_FALL)	continue;
+		
+		for (flowDir = 0; flowDir < 4; ++flowDir)
+		{
+			px = flowX;
+			py = flowY;
+			if (!stepTile(enemyDirs[flowDir]))	continue;
+			if ((unsigned char)(px - mapColumnLeft) >= NAME_COLUMNS)	continue;
+			flowIdx = VISIT_ADR(px,py);
+			if (flowVisited[flowIdx] & bitMask[px&7])	continue;
+			if (metatileFlags[mapTileAt()] & (MTF_SOLID|MTF_FALL))	continue;
+			// Queue full: the map tile can still be reached from another one
+			if (((flowTail + 1) & (FLOW_QUEUE_SIZE-1)) == flowHead)	continue;
+			
+			flowVisited[flowIdx] |= bitMask[px&7];
+			// The step back to the map tile it was reached from
+			setFlow(FLOW_VALID | (flowDir^2));
+			flowQueueX[flowTail] = px;
+			flowQueueY[flowTail] = py;
+			flowTail = (flowTail + 1) & (FLOW_QUEUE_SIZE-1);
+		}
 	}
+}
+
+// The map tile at px,py became a hole: drops its step and the steps of the map tiles
+//	next to it that lead into it
+void invalidateFlow(void)
+{
+	if ((unsigned char)(px - mapColumnLeft) >= NAME_COLUMNS)	return;
 	
-	// Load HUD
-	vram_adr(HUD_LABELS_ADR);
-	vram_write((unsigned char*)hudLabels, HUD_LABELS_LEN);
+	flowX = px;
+	flowY = py;
+	setFlow(0);
+	for (flowDir = 0; flowDir < 4; ++flowDir)
+	{
+		px = flowX;
+		py = flowY;
+		if (!stepTile(enemyDirs[flowDir]))	continue;
+		if ((unsigned char)(px - mapColumnLeft) >= NAME_COLUMNS)	continue;
+		if (flowAt() == (FLOW_VALID | (flowDir^2)))	setFlow(0);
+	}
+	px = flowX;
+	py = flowY;
+}
+
+// Forgets the flow field of map tile column px, which just replaced another column
+//	in the nametables
+void clearFlowColumn(void)
+{
+	for (py = HUD_HEIGHT; py < MAP_HEIGHT+HUD_HEIGHT; ++py)
+	{
+		setFlow(0);
+		flowVisited[VISIT_ADR(px,py)] &= ~bitMask[px&7];
+	}
+}
+
+// Checks whether an enemy can move from map tile enemyTileX,enemyTileY in direction dir
+// Enemies keep off walls, holes and map tiles other enemies have taken;
+//	px,py is left on the map tile checked
+unsigned char enemyCanEnter(unsigned char dir)
+{
+	px = enemyTileX;
+	py = enemyTileY;
+	if (!stepTile(dir))	return FALSE;
+	if (mapTileTaken())	return FALSE;
+	return !(metatileFlags[mapTileAt()] & (MTF_SOLID|MTF_FALL));
+}
+
+// Sets (taken TRUE) or clears the occupancy bits of the map tiles enemy enemyId holds:
+//	the one it is on, and the one it is moving into
+void takeEnemyTiles(unsigned char taken)
+{
+	px = enemy_tileX[enemyId];
+	py = enemy_tileY[enemyId];
+	takeMapTile(taken);
+	if (enemy_state[enemyId] != ENEMY_MOVE)	return;
+	stepTile(enemy_dir[enemyId]);
+	takeMapTile(taken);
+}
+
+// Sets the pixel position of enemy enemyId from its map tile, direction and step
+// (on spawning; moving enemies keep it up to date by whole pixels)
+void placeEnemy(void)
+{
+	enemy_x[enemyId] = enemy_tileX[enemyId] << TILE_SIZE_BIT;
+	enemy_y[enemyId] = enemy_tileY[enemyId] << TILE_SIZE_BIT;
 	
-	// Set level map palette
-	pal_bg(pal_level_test);
+	i = enemy_step[enemyId] >> FP_BITS;
+	switch (enemy_dir[enemyId])
+	{
+		case DIR_RIGHT:	enemy_x[enemyId] += i;	break;
+		case DIR_LEFT:	enemy_x[enemyId] -= i;	break;
+		case DIR_DOWN:	enemy_y[enemyId] += i;	break;
+		case DIR_UP:	enemy_y[enemyId] -= i;	break;
+	}
+}
+
+// Sets j to the flow field step towards the player from map tile enemyTileX,enemyTileY,
+//	or DIR_NONE when it is unknown there (outside the nametables or not reached yet)
+//	or no longer open
+void chaseDir(void)
+{
+	j = DIR_NONE;
+	px = enemyTileX;
+	py = enemyTileY;
+	if ((unsigned char)(px - mapColumnLeft) >= NAME_COLUMNS)	return;
 	
-	// Set sprite palette
-	pal_spr(palGameSpr);
+	i = flowAt();
+	if (!(i & FLOW_VALID))	return;
+	if (enemyCanEnter(enemyDirs[i&3]))	j = enemyDirs[i&3];
+}
+
+// AI turn of enemy enemyId: picks the direction to take at the map tile it is moving to
+//	(or standing on), following the flow field towards the player with one lookup.
+//	Where the flow field has no step it wanders: starting from a random direction,
+//	skipping the way back unless it is a dead end. A waiting enemy starts moving right away
+void thinkEnemy(void)
+{
+	if (enemy_state[enemyId] == ENEMY_STAND || enemy_nextDir[enemyId] != DIR_NONE)	return;
+	
+	px = enemy_tileX[enemyId];
+	py = enemy_tileY[enemyId];
+	if (enemy_state[enemyId] == ENEMY_MOVE)	stepTile(enemy_dir[enemyId]);
+	enemyTileX = px;
+	enemyTileY = py;
+	
+	chaseDir();
+	if (j == DIR_NONE)
+	{
+		ptr = DIR_REVERSE(enemy_dir[enemyId]);
+		spr = rand8();
+		for (i = 0; i < 4; ++i)
+		{
+			j = enemyDirs[(spr + i) & 3];
+			if (j != ptr && enemyCanEnter(j))	break;
+		}
+		if (i == 4)
+		{
+			// Dead end, turn back if even that is open
+			if (!ptr || !enemyCanEnter(ptr))	return;
+			j = ptr;
+		}
+	}
+	
+	if (enemy_state[enemyId] == ENEMY_WAIT)
+	{
+		enemy_dir[enemyId] = j;
+		enemy_state[enemyId] = ENEMY_MOVE;
+		// Take the map tile it moves into (px,py from enemyCanEnter)
+		takeMapTile(TRUE);
+	}
+	else
+	{
+		enemy_nextDir[enemyId] = j;
+	}
+}
+
+// Gives the next ENEMY_AI_PER_FRAME spawned enemies their AI turn, round-robin
+void scheduleEnemyAI(void)
+{
+	for (enemyLoop = 0; enemyLoop < ENEMY_AI_PER_FRAME && enemyLoop < enemyCount; ++enemyLoop)
+	{
+		if (enemyNextAI >= enemyCount)	enemyNextAI = 0;
+		enemyId = enemyList[enemyNextAI];
+		++enemyNextAI;
+		thinkEnemy();
+	}
+}
+
+// Moves enemy enemyId i pixels in its direction
+// @hot
+void shiftEnemy(void)
+{
+	switch (enemy_dir[enemyId])
+	{
+		case DIR_RIGHT:	enemy_x[enemyId] += i;	break;
+		case DIR_LEFT:	enemy_x[enemyId] -= i;	break;
+		case DIR_DOWN:	enemy_y[enemyId] += i;	break;
+		case DIR_UP:	enemy_y[enemyId] -= i;	break;
+	}
+}
+
+// Moves the spawned enemies; on reaching a map tile an enemy turns the way its AI picked,
+//	or waits there for its next AI turn when there is no decision yet or the way has closed
+void moveEnemies(void)
+{
+	for (enemyLoop = 0; enemyLoop < enemyCount; ++enemyLoop)
+	{
+		enemyId = enemyList[enemyLoop];
+		if (enemy_state[enemyId] != ENEMY_MOVE)	continue;
+		
+		// This frame's move: the speed, and one more when its fraction carries
+		moveSpeed = enemy_speed[enemyId];
+		enemy_frac[enemyId] += enemy_speedFrac[enemyId];
+		if (enemy_frac[enemyId] < enemy_speedFrac[enemyId])	++moveSpeed;
+		
+		// Pixels covered this frame: the whole pixels of the step before and after,
+		//	or the rest of the map tile when the step wraps around
+		i = enemy_step[enemyId] >> FP_BITS;
+		enemy_step[enemyId] += moveSpeed;
+		if (enemy_step[enemyId] < moveSpeed)	i = TILE_SIZE - i;
+		else									i = (enemy_step[enemyId] >> FP_BITS) - i;
+		shiftEnemy();
+		
+		// The step wrapped around: the next map tile is reached
+		if (enemy_step[enemyId] < moveSpeed)
+		{
+			moveCarry = enemy_step[enemyId];
+			enemy_step[enemyId] = 0;
+			px = enemy_tileX[enemyId];
+			py = enemy_tileY[enemyId];
+			takeMapTile(FALSE);
+			stepTile(enemy_dir[enemyId]);
+			enemy_tileX[enemyId] = enemyTileX = px;
+			enemy_tileY[enemyId] = enemyTileY = py;
+			
+			j = enemy_nextDir[enemyId];
+			enemy_nextDir[enemyId] = DIR_NONE;
+			if (j != DIR_NONE && enemyCanEnter(j))
+			{
+				enemy_dir[enemyId] = j;
+				takeMapTile(TRUE);
+				enemy_step[enemyId] = moveCarry;
+				i = moveCarry >> FP_BITS;
+				shiftEnemy();
+			}
+			else
+			{
+				enemy_state[enemyId] = ENEMY_WAIT;
+			}
+		}
+	}
+}
+
+// Draws the spawned enemies relative to the camera (the OAM manager culls the ones
+//	not fully inside the camera view, and frees the slots of despawned ones)
+void drawEnemies(void)
+{
+	for (enemyLoop = 0; enemyLoop < enemyCount; ++enemyLoop)
+	{
+		enemyId = enemyList[enemyLoop];
+		oamX = enemy_x[enemyId] - camX;
+		oamY = enemy_y[enemyId];
+		oamDraw(enemyMetasprite);
+	}
+}
+
+// Returns TRUE when the player overlaps a spawned enemy (8x8 boxes at the sprite centers)
+// Only the occupancy bits of the one or two map tiles the player covers are looked up;
+//	the boxes are compared only when an enemy has taken one of them, since an enemy
+//	that close always holds a map tile the player covers
+unsigned char checkEnemyHit(void)
+{
+	px = player_prevTileX;
+	py = player_prevTileY;
+	if (!mapTileTaken())
+	{
+		if (player_dir == DIR_NONE)	return FALSE;
+		px = player_nextTileX;
+		py = player_nextTileY;
+		if (!mapTileTaken())	return FALSE;
+	}
+	
+	for (enemyLoop = 0; enemyLoop < enemyCount; ++enemyLoop)
+	{
+		enemyId = enemyList[enemyLoop];
+		i16 = player_pixX - enemy_x[enemyId] + 8;
+		if (i16 >= 16)	continue;
+		i = player_pixY - enemy_y[enemyId] + 8;
+		if (i < 16)	return TRUE;
+	}
+	return FALSE;
+}
+
+// Spawns the enemies of the level at levelData (the enemy count byte), leaving
+//	levelData after the enemy list
+void spawnEnemies(void)
+{
+	enemyCount = *levelData++;
+	for (enemyId = 0; enemyId < enemyCount; ++enemyId)
+	{
+		enemyList[enemyId] = enemyId;
+		enemy_tileX[enemyId] = levelData[0];
+		enemy_tileY[enemyId] = levelData[1];
+		i16 = enemySpeedTable[region][levelData[2]];
+		enemy_speed[enemyId] = i16 >> 8;
+		enemy_speedFrac[enemyId] = (unsigned char)i16;
+		enemy_frac[enemyId] = 0;
+		enemy_state[enemyId] = enemy_speed[enemyId] ? ENEMY_WAIT : ENEMY_STAND;
+		enemy_dir[enemyId] = DIR_NONE;
+		enemy_nextDir[enemyId] = DIR_NONE;
+		enemy_step[enemyId] = 0;
+		placeEnemy();
+		levelData += LEVEL_ENEMY_SIZE;
+	}
+	enemyNextAI = 0;
+}
+
+// Despawns all enemies, giving back the map tiles they held (clobbers px,py)
+void despawnEnemies(void)
+{
+	for (enemyLoop = 0; enemyLoop < enemyCount; ++enemyLoop)
+	{
+		enemyId = enemyList[enemyLoop];
+		takeEnemyTiles(FALSE);
+	}
+	enemyCount = 0;
+}
+
+// Clears the sprites and sets sprite 0 for the HUD split
+void initGameSprites(void)
+{
+	oam_clear();
+	oamInit();
+	oam_spr(SPLIT_SPR_X, SPLIT_SPR_Y, SPLIT_SPR_TILE, 0x20, 0);
+}
+
+// Loads the current level: copies its map into map[], spawns the player and enemies and
+//	puts the camera on the player (nothing is drawn)
+void loadLevel(void)
+{
+	if (gameLevel < LEVEL_COUNT)
+	{
+		// Map the bank of the level while it is read below (all code is in the fixed bank)
+		levelData = levelTable[gameLevel];
+#ifdef MAPPER_UNROM
+		levelPrevBank = bank_prg(BANK_LEVELS + levelBank[gameLevel]);
+#endif
+		percentStep = levelPercentStep[gameLevel];
+		percentStepRem = levelPercentRem[gameLevel];
+	}
+	else
+	{
+		// Generated level, in map[] already when the end delay of the last level had time
+		if (mazeState == MAZE_IDLE || mazeLevel != gameLevel)	mazeBegin();
+		mazeFinish();
+		mazeState = MAZE_IDLE;
+		levelData = mazeHeader;
+		percentStep = mazePercentStep;
+		percentStepRem = mazePercentRem;
+	}
 	
-	// Read level nametable from VRAM
-	i16 = MAP_START_ADR;
-	ptr = 0;
 	wait = 0;
-	levelItemsCount = 0;
+	levelItemsCount = levelData[LEVEL_ITEMS];
 	levelItemsCollected = 0;
 	percentCollected = 0;
+	percentRemainder = 0;
 	
-	enemy_tileX = 255;
-	enemy_tileY = 255;
+	// Player standing on the start map tile
+	player_prevTileX = player_nextTileX = levelData[LEVEL_START_X];
+	player_prevTileY = player_nextTileY = levelData[LEVEL_START_Y];
+	player_pixX = player_prevTileX << TILE_SIZE_BIT;
+	player_pixY = player_prevTileY << TILE_SIZE_BIT;
+	player_step = 0;
+	player_dir = DIR_NONE;
+	player_nextDir = DIR_NONE;
+	// Speed increases every level
+	i16 = playerSpeedTable[region][gameLevel < SPEED_LEVELS ? gameLevel : SPEED_LEVELS-1];
+	player_speed = i16 >> 8;
+	player_speedFrac = (unsigned char)i16;
+	player_frac = 0;
 	
 	// If first level, reset totalItemsCollected
 	if (gameLevel == 0)
 	{
-		totalItemsCollected1 = 0;
-		totalItemsCollected2 = 0;
-		totalItemsCollected3 = 0;
-		totalItemsCollected4 = 0;
-		totalItemsCollected5 = 0;
+		memfill(totalItemsCollected, 0, TOTAL_ITEMS_BYTES);
+	}
+	
+	// Enemies, then the map after their list
+	mapWidth = levelData[LEVEL_WIDTH];
+	levelData += LEVEL_ENEMIES;
+	spawnEnemies();
+	
+	// No flow field yet, the first update starts one from the player
+	memfill(flowField, 0, sizeof(flowField));
+	flowRootX = 255;
+	
+	// Copy the map rows, map[] rows are MAP_MAX_WIDTH map tiles apart
+	//	(a generated level has no rows after its header)
+	if (gameLevel < LEVEL_COUNT)
+	{
+		for (i = 0; i < MAP_HEIGHT; ++i)
+		{
+			memcpy(map + (i<<MAP_ROW_BIT), (void*)levelData, mapWidth>>1);
+			levelData += mapWidth>>1;
+		}
+#ifdef MAPPER_UNROM
+		bank_prg(levelPrevBank);
+#endif
+	}
+	
+	// Enemies take the map tiles they spawn on
+	for (enemyId = 0; enemyId < enemyCount; ++enemyId)
+	{
+		takeEnemyTiles(TRUE);
+	}
+	
+	// Camera limits, a map one screen wide never scrolls
+	camMaxX = (mapWidth - SCREEN_WIDTH) << TILE_SIZE_BIT;
+	mapColumnMax = mapWidth > NAME_COLUMNS ? mapWidth - NAME_COLUMNS : 0;
+	fillWidth = mapWidth < NAME_COLUMNS ? mapWidth : NAME_COLUMNS;
+	
+	// Camera on the player, and the map tile columns on screen (17 when it is
+	//	not on a map tile edge)
+	updateCamera();
+	mapColumnLeft = j;
+	fillView = camX >> TILE_SIZE_BIT;
+	fillCount = (camX & (TILE_SIZE-1)) ? SCREEN_WIDTH+1 : SCREEN_WIDTH;
+	memfill(nameDrawn, 0, sizeof(nameDrawn));
+}
+
+// Initializes the game screen, loading the HUD and the current level, and drawing the
+//	map tile columns around the camera (display must be off)
+void initGameMap(void)
+{
+	initGameSprites();
+	loadLevel();
+	
+	// Clear HUD rows and their attributes, then load HUD
+	vram_adr(NAMETABLE_A);
+	vram_fill(0, HUD_HEIGHT<<6);
+	vram_adr(NAMETABLE_A + 0x3c0);
+	vram_fill(0, 8);
+	vram_adr(HUD_LABELS_ADR);
+	vram_write((unsigned char*)hudLabels, HUD_LABELS_LEN);
+	
+	// Set level map palette
+	pal_bg(pal_level_test);
+	
+	// Set sprite palette
+	pal_spr(palGameSpr);
+	
+	// The map from the left of nametable A, scrolled only when it is wider than the screen
+	nameRot = 0;
+	nameScroll = 0;
+	mapSplit = camMaxX != 0;
+	for (px = mapColumnLeft; px < mapColumnLeft + fillWidth; ++px)
+	{
+		drawMapColumn();
 	}
+	fillNext = fillWidth;
+	
+	// Start with nothing queued for the NMI
+	vramQueueInit();
+}
+
+// Returns whether nametable column c, or the other one in its attribute bytes, is on screen
+//	while the next level is prepared
+unsigned char nameOnScreen(unsigned char c)
+{
+	return ((unsigned char)(c - nameShown) & (NAME_COLUMNS-1)) < nameShownCount
+		|| ((unsigned char)((c^1) - nameShown) & (NAME_COLUMNS-1)) < nameShownCount;
+}
+
+// Prepares the next level in the end delay of the last one, which stays on screen for
+//	END_DELAY frames: generates its maze if it is past the level pack, loads it, and queues
+//	the map tile columns its camera starts on into the nametable columns off screen
+// The new map is rotated so its screen starts right after the one shown; two scrolled
+//	screens can need more than the NAME_COLUMNS between them, and those shared columns are
+//	drawn last, after END_DELAY, for a frame or two at the screen edge before the swap
+void prepareLevel(void)
+{
+	// Nametable columns on screen
+	nameShown = NAME_COLUMN(camX >> TILE_SIZE_BIT);
+	nameShownCount = (camX & (TILE_SIZE-1)) ? SCREEN_WIDTH+1 : SCREEN_WIDTH;
+	
+	if (gameLevel >= LEVEL_COUNT)	mazeBegin();
 	
-	// Read MAP_HEIGHT rows starting from below the HUD
-	for (i = HUD_HEIGHT; i < MAP_HEIGHT+2; ++i)
+	levelSwap = FALSE;
+	frameCounter = 0;
+	while (1)
 	{
-		// Read map data one row at a time (32 bytes) into nameRow
-		vram_adr(i16);
-		vram_read(nameRow, 32);
-		// Reset address to start of row (since it gets advanced by vram_read)
-		vram_adr(i16);
+		ppu_wait_nmi();
+		if (frameCounter < END_DELAY)	countFrame();
 		
-		// Each map tile is 2 bytes wide, so read map data at increments of 2 up to the maximum map width (bytes = tiles*2 = tiles<<1)
-		for (j = 0; j < MAP_WIDTH<<1; j += 2)
+		if (mazeState != MAZE_IDLE && mazeState != MAZE_DONE)
 		{
-			spr = nameRow[j];
-			
-			// Handle each tile according to their type
-			switch (spr)
+			// A slice of the maze per frame (the map on screen is not read any more)
+			mazeStep();
+		}
+		else if (!levelSwap)
+		{
+			loadLevel();
+			nameRot = (nameShown + nameShownCount - fillView) & (NAME_COLUMNS-2);
+			levelSwap = TRUE;
+		}
+		else if (vqHead == vqTail)
+		{
+			// Everything queued is flushed: queue the next column for the new screen
+			for (fillNext = 0; fillNext < fillCount; ++fillNext)
 			{
-			case TILE_START:
-				// Player position x and y are 16-bit variables in the format
-				//	MSB		8 bits - tile coordinate
-				//			4 bits - position within tile, TILE_SIZE_BIT
-				//			4 bits - fixed point resolution, FP_BITS
-				// To set tile coordinate, shift TILE_SIZE_BIT+FP_BITS left
-				// Since the loop variable j increments by 2, also divide by 2 (>>1) to get x
-				player_x = j << TILE_PLUS_FP_BITS >> 1;
-				player_y = i << TILE_PLUS_FP_BITS;
-				player_prevTileX = j >> 1;
-				player_prevTileY = i;
-				player_dir = DIR_NONE;
-				player_nextDir = DIR_NONE;
-				player_moveCounter = 0;
-				// Speed increases every level
-				player_speed = (START_SPEED + SPEED_UP_PER_LEVEL*gameLevel) << FP_BITS;
-				// Remove start marker from map
-				spr = TILE_EMPTY;
-				break;
-			case TILE_EXIT:
-				// Save exit position
-				exit_tileX = j >> 1;
-				exit_tileY = i;
-				break;
-			case TILE_ENEMY:
-				enemy_tileX = j >> 1;
-				enemy_tileY = i;
-				// Remove enemy marker from map
-				spr = TILE_EMPTY;
-				break;
-			case TILE_ITEM:
-				++levelItemsCount;
+				fillColumnAt(fillNext);
+				findNameBit();
+				if (nameDrawn[i] & nameBit)	continue;
+				if (frameCounter < END_DELAY && nameOnScreen(NAME_COLUMN(px)))	continue;
+				queueMapColumn();
 				break;
 			}
-			
-			// Keep local copy of map data for use in collision detection etc
-			map[ptr++] = spr;
-			
-			// Write back to VRAM
-			vram_put(spr);
-			// Keep 2nd byte in tile as is
-			vram_put(nameRow[j+1]);
+			if (fillNext == fillCount && frameCounter == END_DELAY)	break;
 		}
 		
-		// Move to next tile row
-		i16 += 64;	// 32 * 2, with 32 being offset for byte row, and 2 being tile height (2 bytes)
+		vramQueueCommit();
 	}
+}
+
+// Shows the level prepareLevel drew by scrolling to its nametable columns; the sprites
+//	start over, and the map tile columns off screen are drawn as the level plays
+void swapLevel(void)
+{
+	music_stop();
+	initGameSprites();
 	
-	// Set up update list
-	memcpy(updateList, updateListData, sizeof(updateListData));
-	set_vram_update(updateList);
+	nameScroll = nameRot << TILE_SIZE_BIT;
+	mapSplit = camMaxX || nameRot;
+	if (!mapSplit)	split_off();
+	
+	fillNext = fillCount;
 }
 
 void gamePhase(void)
 {			
-	// Start with screen faded out
-	pal_bright(0);
-	
-	// Initializes the game map, and takes info to be used for sprite placement
-	initGameMap();
+	if (levelSwap)
+	{
+		// The level is drawn beside the last one already, which is still on screen
+		swapLevel();
+	}
+	else
+	{
+		// Start with screen faded out
+		pal_bright(0);
+		
+		// Initializes the game map, and takes info to be used for sprite placement
+		initGameMap();
+	}
 	
 	// Short delay before starting game (animations, input processing)
-	wait = START_DELAY;
+	wait = startDelayTable[region];
+	
+	// Maps wider than the screen or rotated in the nametables scroll below the HUD
+	if (mapSplit)	split_x(camX + nameScroll);
 	
-	// Enable display
-	ppu_on_all();
+	// Enable display (on all along after a level swap)
+	if (levelSwap)	levelSwap = FALSE;
+	else			ppu_on_all();
 	
 	// Update HUD values that carry over from previous level
 	if (gameLevel > 0)
@@ -366,30 +1261,46 @@ void gamePhase(void)
 	
 	levelDone = FALSE;
 	frameCounter = 0;
+	perfBegin();
 	
+	// Runs every frame: no multiply, divide or shift runtime helpers (tools/hotcheck.c)
+	// @hot begin
 	while (1)
 	{
-		// Set up sprites in OAM
-		oam_meta_spr(player_x >> FP_BITS,
-					 player_y >> FP_BITS,
-					 0,
-					 playerMetasprite);
-		oam_meta_spr(enemy_tileX << TILE_SIZE_BIT,
-					 enemy_tileY << TILE_SIZE_BIT,
-					 16,
-					 enemyMetasprite);
+		// Follow the player with the camera, streaming in map tile columns as it moves
+		updateCamera();
+		streamMapColumn();
+		// Fill in the map tile columns a level swap left for later
+		fillMapColumn();
+		
+		// Set up sprites in OAM, relative to the camera: the player in the pinned slot,
+		//	then the enemies
+		oamBegin();
+		oamX = player_pixX - camX;
+		oamY = player_pixY;
+		oamDraw(playerMetasprite);
+		drawEnemies();
+		oamEnd();
+		
+		// Hand this frame's nametable updates to the NMI
+		perfDraw();
+		vramQueueCommit();
+		
+		// Scroll the map below the HUD
+		if (mapSplit)	split_x(camX + nameScroll);
 		
 		// Exit the loop after the metasprite update to make sure objects are at their final state
+		// (the end delay waits for vblank, which flushes the last updates)
 		if (levelDone)	break;
 		
 		// Wait for next frame
 		// Note: OAM update must go first to make sure display is updated soon after any object changes
+		perfEnd();
 		ppu_wait_frame();
-		
-		++frameCounter;
+		perfStart();
 		
 		// Slowly fade brightness to needed value (max for gameplay, half for pause)
-		if (!(frameCounter&3))
+		if (countFrame() && !(frameCounter&3))
 		{
 			if (!gamePaused && bright < 4) ++bright;
 			if ( gamePaused && bright > 2) --bright;
@@ -397,7 +1308,7 @@ void gamePhase(void)
 		}
 		
 		// Check input in trigger mode
-		input = pad_trigger(0);
+		input = padTrigger();
 		
 		// Start button toggles pause mode
 		if (input&PAD_START)
@@ -425,152 +1336,107 @@ void gamePhase(void)
 			}
 		}
 		
-		// If movement counter is not zero, process movement
-		if (player_moveCounter != 0)
+		// If moving, process movement
+		if (player_dir != DIR_NONE)
 		{
-			// Update position based on move direction
-			switch (player_dir)
-			{
-				case DIR_RIGHT:	player_x += player_speed;	break;
-				case DIR_LEFT:	player_x -= player_speed;	break;
-				case DIR_DOWN:	player_y += player_speed;	break;
-				case DIR_UP:	player_y -= player_speed;	break;
-			}
-			// Update movement counter
-			player_moveCounter -= player_speed;
+			// This frame's move: the speed, and one more when its fraction carries
+			moveSpeed = player_speed;
+			player_frac += player_speedFrac;
+			if (player_frac < player_speedFrac)	++moveSpeed;
+			
+			// Pixels covered this frame: the whole pixels of the move progress before and
+			//	after, or the rest of the map tile when the progress wraps around
+			i = player_step >> FP_BITS;
+			player_step += moveSpeed;
+			if (player_step < moveSpeed)	i = TILE_SIZE - i;
+			else							i = (player_step >> FP_BITS) - i;
+			shiftPlayer();
 			
-			// Snap position to tile coordinates
-			if (player_moveCounter <= 0)
+			// The progress wrapped around: the player is on the next map tile
+			if (player_step < moveSpeed)
 			{
-				player_moveCounter = 0;
-				// Keep only the tile coordinate bits, taking the "floor" of tile position
-				/* player_x >>= TILE_PLUS_FP_BITS;
-				player_y >>= TILE_PLUS_FP_BITS;
-				// If moving up or left (negative offset relative to target tile position), it should be "ceiling" of tile position instead, i.e. "floor" + 1
-				if (player_dir == DIR_LEFT)	player_x += 1;
-				if (player_dir == DIR_UP)	player_y += 1;
-				// Restore position variable format
-				player_x <<= TILE_PLUS_FP_BITS;
-				player_y <<= TILE_PLUS_FP_BITS; */
-				player_x = player_nextTileX << TILE_PLUS_FP_BITS;
-				player_y = player_nextTileY << TILE_PLUS_FP_BITS;
+				moveCarry = player_step;
+				player_step = 0;
+				player_dir = DIR_NONE;
 				
-				// Check win condition: player reaches exit position
-				if (player_x == exit_tileX << TILE_PLUS_FP_BITS &&
-					player_y == exit_tileY << TILE_PLUS_FP_BITS)
+				px = player_nextTileX;
+				py = player_nextTileY;
+				spr = metatileFlags[mapTileAt()];
+				
+				// Check win condition: player reaches an exit
+				if (spr & MTF_EXIT)
 				{
 					gameClear = TRUE;
 					levelDone = TRUE;
 				}
 				
-				i16 = MAP_ADR(player_nextTileX, player_nextTileY);
-				switch (map[i16])
-				{
 				// Check lose condition: player moves to blank tile
-				case TILE_HOLE:
+				if (spr & MTF_FALL)
+				{
 					gameClear = FALSE;
 					levelDone = TRUE;
-					break;
+				}
 				
 				// Check for item pickups
-				case TILE_ITEM:
-					// Mark as collected in game map
-					map[i16] = TILE_EMPTY;
+				if (spr & MTF_PICKUP)
+				{
 					// Play item collect SFX
 					sfx_play(SFX_ITEM, 1);
-					// Update level collect count
-					++levelItemsCollected;
+					// Update level and total collect counts, and the percent
+					collectItem();
 					
-					// Get percent of items collected in current level
-					percentCollected = levelItemsCollected*100/levelItemsCount;
+					// Mark as collected in game map and on screen
+					setMapTile(MT_EMPTY);
 					
-					// Hide enemy upon reaching clear percent requirement
-					if (percentCollected >= CLEAR_PERC_REQT)
-					{
-						enemy_tileX = 255;	// Lower right screen corner
-						enemy_tileY = 255;
-					}
-					
-					// Update total collect count
-					incrementTotalItemsCollected();
-					
-					// Get address of tile in nametable
-					i16 = NAM_ADR(player_nextTileX, player_nextTileY);
-					
-					// Replace with empty tile using the update list
-					// Upper left subsprite
-					updateList[0] = i16 >> 8;		// MSB
-					updateList[1] = i16 & 0xff;		// LSB
-					// Upper right subsprite
-					updateList[3] = updateList[0];
-					updateList[4] = updateList[1] + 1;	// Element next to upper left
-					i16 += 32;
-					// Lower left subsprite
-					updateList[6] = i16 >> 8;
-					updateList[7] = i16 & 0xff;
-					// Lower right subsprite
-					updateList[9] = updateList[6];
-					updateList[10] = updateList[7] + 1;	// Element next to lower left
+					// Despawn the enemies upon reaching clear percent requirement
+					//	(packed BCD compares like binary)
+					if (percentCollected >= BCD_WORD(CLEAR_PERC_REQT))	despawnEnemies();
 					
 					// Update HUD
 					updateHUD();
-					break;
 				}
 				
-				// Replace the previous tile with a blank tile
-				i16 = MAP_ADR(player_prevTileX, player_prevTileY);
-				map[i16] = TILE_HOLE;
-				
-				// Get address of previous tile in nametable
-				i16 = NAM_ADR(player_prevTileX, player_prevTileY);
-				
-				// Upper left subsprite
-				updateList[12] = i16 >> 8;				// MSB
-				updateList[13] = i16 & 0xff;			// LSB
-				// Upper right subsprite
-				updateList[15] = updateList[12];
-				updateList[16] = updateList[13] + 1;	// Element next to upper left
-				i16 += 32;
-				// Lower left subsprite
-				updateList[18] = i16 >> 8;
-				updateList[19] = i16 & 0xff;
-				// Lower right subsprite
-				updateList[21] = updateList[18];
-				updateList[22] = updateList[19] + 1;	// Element next to lower left
+				// Replace the previous tile with a hole (queued after any item pickup, so it wins)
+				px = player_prevTileX;
+				py = player_prevTileY;
+				setMapTile(MT_HOLE);
+				invalidateFlow();
 				
 				// Set current player pos as "previous" pos for the next frame
 				player_prevTileX = player_nextTileX;
 				player_prevTileY = player_nextTileY;
 				
-				// If both "blanker" and "emptier" work on the same tile,
-				//	"blanker" takes priority
-				if (updateList[12] == updateList[0] && updateList[13] == updateList[1])
-				{
-					updateList[0] = updateList[3] = updateList[6] = updateList[9] = 0x28;
-					updateList[1] = updateList[4] = updateList[7] = updateList[10] = 0x00;
-				}
-				
 				// Keep player moving in same direction until hitting a wall or until another possible move direction is selected
 				checkPlayerMove(player_nextDir);
-			}
-			
-			// Check lose condition: player collides with enemy
-			if (percentCollected < CLEAR_PERC_REQT && 
-				!(((player_x>>TILE_SIZE_BIT)+4)>=((enemy_tileX<<TILE_SIZE_BIT)+12) ||
-				  ((player_x>>TILE_SIZE_BIT)+12)<((enemy_tileX<<TILE_SIZE_BIT)+4) ||
-				  ((player_y>>TILE_SIZE_BIT)+4)>=((enemy_tileY<<TILE_SIZE_BIT)+12) ||
-				  ((player_y>>TILE_SIZE_BIT)+12)<((enemy_tileY<<TILE_SIZE_BIT)+4)))
-			{
-				gameClear = FALSE;
-				levelDone = TRUE;
+				if (player_dir != DIR_NONE)
+				{
+					player_step = moveCarry;
+					i = moveCarry >> FP_BITS;
+					shiftPlayer();
+				}
 			}
 		}
 		
-		// Get input state (previously polled with pad_trigger)
-		j = pad_state(0);
+		// Enemies start moving with the game music, chasing the player along the flow field
+		if (!wait && enemyCount)
+		{
+			updateFlowField();
+			moveEnemies();
+			scheduleEnemyAI();
+		}
+		
+		// Check lose condition: player collides with an enemy
+		if (checkEnemyHit())
+		{
+			gameClear = FALSE;
+			levelDone = TRUE;
+		}
+		
+		// Get input state (previously polled with padTrigger)
+		j = padState();
 		
 		// If no movement to process, check for new input
-		if (player_moveCounter == 0)
+		if (player_dir == DIR_NONE)
 		{
 			if (j&PAD_LEFT)		checkPlayerMove(DIR_LEFT);
 			if (j&PAD_RIGHT)	checkPlayerMove(DIR_RIGHT);
@@ -585,6 +1451,10 @@ void gamePhase(void)
 			if (j&PAD_DOWN)		player_nextDir = DIR_DOWN;
 		}
 	}
+	// @hot end
+	
+	// Keep the level's best percent
+	saveLevel(percentCollected);
 	
 	// Process result
 	if (gameClear)
@@ -602,8 +1472,15 @@ void gamePhase(void)
 		gameDone = TRUE;
 	}
 	
-	// Delay to emphasize result
-	delay(END_DELAY);
+	// Delay to emphasize result, drawing the next level meanwhile for the next gamePhase
+	//	to swap in without turning the display off
+	if (!gameDone)
+	{
+		saveFlush();
+		prepareLevel();
+		return;
+	}
+	delay(endDelayTable[region]);
 	
 	// Fade out game screen
 	pal_fade_to(0);
@@ -0,0 +1,141 @@
+/******************************************************************************
+*  @file       	inputLog.h
+*  @brief      	Pad input recording and replay
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> The game reads the pad only through padTrigger (one poll per
+*		call) and padState (the buttons of the last poll), so the buttons
+*		of every poll are enough to play a session again
+*		> Built with INPUT_RECORD, every poll goes into a run-length
+*		coded pad log: INPUT_LOG_MAGIC, then a poll count (1-255) and the
+*		buttons for each run of polls, ended by a zero count. The log is
+*		in the battery-backed PRG RAM at $6000 (the 2K of RAM has no room
+*		for it), and is valid after every poll; a full log stops growing
+*		> Built with INPUT_REPLAY, the polls read the log in battery RAM
+*		(as a recording build left it) instead of the pad; once it ends,
+*		no buttons are held
+*		> With INPUT_BEST as well, the log replayed is the save's best
+*		game (save.h) instead, or nothing when it has none for this region
+*		> nesbench and nesprof replay a pad log too (-p), from a battery
+*		save
+*		> The UNROM ROM has no battery RAM, so none of this builds for it
+*		> Without either, padState is the neslib call and padTrigger
+*		records the game for the save (save.h)
+******************************************************************************/
+
+#define INPUT_LOG_MAGIC0	'P'
+#define INPUT_LOG_MAGIC1	'L'
+#define INPUT_LOG_START		2
+
+#if defined(INPUT_RECORD) || defined(INPUT_REPLAY)
+
+#ifdef MAPPER_UNROM
+#error "the pad log needs the battery RAM, which the UNROM ROM has none of"
+#endif
+
+#ifdef INPUT_BEST
+// The save's best replay, or an empty log
+unsigned char* saveReplay(void);
+const unsigned char inputLogEmpty[3] = { INPUT_LOG_MAGIC0, INPUT_LOG_MAGIC1, 0 };
+static unsigned char *inputLogBest;
+#define INPUT_LOG			inputLogBest
+#else
+// Up to the save slots (save.h), over the replay areas
+#define INPUT_LOG			((unsigned char*)0x6000)
+#define INPUT_LOG_SIZE		0x1c00
+#endif
+
+#pragma bss-name (push,"ZEROPAGE")
+// Offset of the run count being recorded or of the next run to replay
+static unsigned int inputLogPos;
+// Buttons of the last poll, and of the one before (for the trigger)
+static unsigned char inputPad;
+static unsigned char inputPadPrev;
+// Polls left in the run being replayed
+static unsigned char inputRun;
+#pragma bss-name (pop)
+
+#define padState()	inputPad
+
+#ifdef INPUT_RECORD
+
+// Starts an empty log
+void inputLogInit(void)
+{
+	INPUT_LOG[INPUT_LOG_START] = 0;
+	INPUT_LOG[0] = INPUT_LOG_MAGIC0;
+	INPUT_LOG[1] = INPUT_LOG_MAGIC1;
+	inputLogPos = INPUT_LOG_START;
+}
+
+// Polls the pad and adds the buttons to the log; returns the newly pressed buttons
+// The end mark goes in before the run it follows, so the log is valid at any time
+unsigned char padTrigger(void)
+{
+	inputPadPrev = pad_trigger(0);
+	inputPad = pad_state(0);
+
+	if (INPUT_LOG[inputLogPos] && INPUT_LOG[inputLogPos] != 255 && INPUT_LOG[inputLogPos+1] == inputPad)
+	{
+		++INPUT_LOG[inputLogPos];
+		return inputPadPrev;
+	}
+
+	// New run after the current one (the first one takes the end mark's place)
+	if (INPUT_LOG[inputLogPos])
+	{
+		if (inputLogPos + 4 >= INPUT_LOG_SIZE)	return inputPadPrev;
+		inputLogPos += 2;
+	}
+	INPUT_LOG[inputLogPos+2] = 0;
+	INPUT_LOG[inputLogPos+1] = inputPad;
+	INPUT_LOG[inputLogPos] = 1;
+	return inputPadPrev;
+}
+
+#else
+
+// Starts the replay, of nothing when the battery RAM holds no log
+void inputLogInit(void)
+{
+#ifdef INPUT_BEST
+	inputLogBest = saveReplay();
+	if (!inputLogBest)	inputLogBest = (unsigned char*)inputLogEmpty;
+#endif
+	if (INPUT_LOG[0] != INPUT_LOG_MAGIC0 || INPUT_LOG[1] != INPUT_LOG_MAGIC1)	INPUT_LOG[INPUT_LOG_START] = 0;
+	inputLogPos = INPUT_LOG_START;
+	inputRun = 0;
+	inputPad = 0;
+}
+
+// Takes the buttons of the next poll from the log; returns the newly pressed buttons
+unsigned char padTrigger(void)
+{
+	inputPadPrev = inputPad;
+	if (!inputRun)
+	{
+		inputRun = INPUT_LOG[inputLogPos];
+		if (inputRun)
+		{
+			inputPad = INPUT_LOG[inputLogPos+1];
+			inputLogPos += 2;
+		}
+		else
+		{
+			inputPad = 0;
+			return 0;
+		}
+	}
+	--inputRun;
+	return inputPad & ~inputPadPrev;
+}
+
+#endif
+
+#else
+
+#define inputLogInit()
+#define padState()		pad_state(0)
+
+#endif
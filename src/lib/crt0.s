@@ -9,6 +9,15 @@ FT_SFX_STREAMS			= 4			;number of sound effects played at once, 1..4
 .define FT_SFX_ENABLE   1			;undefine to exclude all sound effects code
 .define FT_MUSIC_ENABLE	1			;undefine to disable music (does not exclude music code)
 
+;UNROM build (-D MAPPER_UNROM, MAPPER=unrom ./compile.sh), banks as in unrom_128_vert.cfg
+;the fixed bank at $c000 holds all code, neslib maps these banks at $8000 when it needs their data
+
+.ifdef MAPPER_UNROM
+BANK_CHR				= 0			;tileset, copied to CHR RAM at startup
+BANK_SCREENS			= 0			;nametables read by vram_unlz and vram_unrle
+BANK_MUSIC				= 1			;music and sound effects read by FamiTone
+.endif
+
 
     .export _exit,__STARTUP__:absolute=1
 	.import initlib,push0,popa,popax,_main,zerobss,copydata
@@ -54,7 +63,6 @@ PAL_BUF		=$01c0
 
 NTSC_MODE: 			.res 1
 FRAME_CNT1: 		.res 1
-FRAME_CNT2: 		.res 1
 VRAM_UPDATE: 		.res 1
 NAME_UPD_ADR: 		.res 2
 NAME_UPD_ENABLE: 	.res 1
@@ -71,7 +79,13 @@ PAD_STATET: 		.res 2
 PPU_CTRL_VAR: 		.res 1
 PPU_CTRL_VAR1: 		.res 1
 PPU_MASK_VAR: 		.res 1
+SPLIT_X: 			.res 1
+SPLIT_NT: 			.res 1		;bit 7 split enabled, bit 0 nametable
+SPLIT_CTRL: 		.res 1
 RAND_SEED: 			.res 2
+.ifdef MAPPER_UNROM
+PRG_BANK: 			.res 1		;bank mapped at $8000, restored by the NMI after FamiToneUpdate
+.endif
 FT_TEMP: 			.res 3
 
 TEMP: 				.res 11
@@ -91,14 +105,27 @@ RLE_HIGH	=TEMP+1
 RLE_TAG		=TEMP+2
 RLE_BYTE	=TEMP+3
 
+LZ_LOW		=TEMP
+LZ_HIGH		=TEMP+1
+LZ_LEN		=TEMP+2
+
+
 
+;battery-backed PRG RAM at $6000 for the save (save.h) and the pad log (inputLog.h),
+;on NROM only: UNROM boards have no PRG RAM, and that ROM keeps no save
+
+.ifdef MAPPER_UNROM
+NES_BATTERY				= 0
+.else
+NES_BATTERY				= 2
+.endif
 
 .segment "HEADER"
 
     .byte $4e,$45,$53,$1a
 	.byte <NES_PRG_BANKS
 	.byte <NES_CHR_BANKS
-	.byte <NES_MIRRORING|(<NES_MAPPER<<4)
+	.byte <NES_MIRRORING|NES_BATTERY|(<NES_MAPPER<<4)
 	.byte <NES_MAPPER&$f0
 	.res 8,0
 
@@ -168,6 +195,29 @@ clearRAM:
     inx
     bne @1
 
+.ifdef MAPPER_UNROM
+uploadCHR:
+
+	lda #BANK_CHR
+	jsr bankSwitch
+	lda #<chr_data
+	sta <PTR
+	lda #>chr_data
+	sta <PTR+1
+	ldy #0
+	sty PPU_ADDR
+	sty PPU_ADDR
+	ldx #$20			;8K, 32 pages
+@1:
+	lda (PTR),y
+	sta PPU_DATA
+	iny
+	bne @1
+	inc <PTR+1
+	dex
+	bne @1
+.endif
+
 	lda #4
 	jsr _pal_bright
 	jsr _pal_clear
@@ -210,6 +260,11 @@ detectNTSC:
 
 	jsr _ppu_off
 
+.ifdef MAPPER_UNROM
+	lda #BANK_MUSIC		;FamiToneInit reads the music header
+	jsr bankSwitch
+.endif
+
 	ldx #<music_data
 	ldy #>music_data
 	lda <NTSC_MODE
@@ -234,7 +289,7 @@ detectNTSC:
 
 	.include "neslib.s"
 
-.segment "RODATA"
+.segment "MUSIC"
 
 music_data:
 	.include "../soundsAndMusic/music.s"
@@ -258,4 +313,7 @@ sounds_data:
 
 
 .segment "CHARS"
+.ifdef MAPPER_UNROM
+chr_data:
+.endif
 	.incbin "../../graphics/tileset.chr"
\ No newline at end of file
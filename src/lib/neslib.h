@@ -52,7 +52,8 @@ void __fastcall__ pal_bg_bright(unsigned char bright);
 
 void __fastcall__ ppu_wait_nmi(void);
 
-//wait virtual frame, it is always 50hz, frame-to-frame in PAL, frameskip in NTSC
+//wait the next frame like ppu_wait_nmi, 50hz for PAL, 60hz for NTSC; there is no NTSC
+//frameskip, the game scales its speeds by ppu_system instead (see gameConstants.h)
 
 void __fastcall__ ppu_wait_frame(void);
 
@@ -76,6 +77,12 @@ void __fastcall__ ppu_on_spr(void);
 
 void __fastcall__ ppu_mask(unsigned char mask);
 
+//PERF_OVERLAY builds only: the NMI count, and PPU_MASK with extra bits set at once,
+//until the next NMI writes the mask again
+
+unsigned char __fastcall__ nesclock(void);
+void __fastcall__ ppu_mask_now(unsigned char mask);
+
 //get current video system, 0 for PAL, not 0 for NTSC
 
 unsigned char __fastcall__ ppu_system(void);
@@ -159,6 +166,15 @@ void __fastcall__ scroll(unsigned int x,unsigned int y);
 
 void __fastcall__ split(unsigned int x,unsigned int y);
 
+//set X scroll below the sprite 0 hit, applied by the NMI every frame until split_off,
+//so lag frames and skipped frames keep the split; the area above uses scroll()
+//warning: the NMI busy waits for the hit, sprite 0 has to hit over the background; the wait
+//         gives up 10 lines past sprite 0's Y, and sprite 0 at Y 128 and lower skips the split
+//warning: call it right before ppu_wait_frame/ppu_wait_nmi, so an NMI can not apply half of it
+
+void __fastcall__ split_x(unsigned int x);
+void __fastcall__ split_off(void);
+
 
 //select current chr bank for sprites, 0..1
 
@@ -168,6 +184,16 @@ void __fastcall__ bank_spr(unsigned char n);
 
 void __fastcall__ bank_bg(unsigned char n);
 
+//select the PRG bank mapped at $8000-$bfff, returns the previous one (UNROM builds,
+//does nothing on NROM); vram_unrle, vram_unlz, music_play and sfx_play map their own banks
+//and restore the previous one
+
+#ifdef MAPPER_UNROM
+unsigned char __fastcall__ bank_prg(unsigned char n);
+#else
+#define bank_prg(n)
+#endif
+
 
 
 //get random number 0..255 or 0..65535
@@ -234,6 +260,11 @@ void __fastcall__ vram_write(unsigned char *src,unsigned int size);
 
 void __fastcall__ vram_unrle(const unsigned char *data);
 
+//unpack LZ data from tools/screenpack.c to current address of vram, works only when
+//rendering is turned off; smaller and faster to unpack than RLE for nametables
+
+void __fastcall__ vram_unlz(const unsigned char *data);
+
 
 
 //like a normal memcpy, but does not return anything
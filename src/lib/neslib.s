@@ -8,16 +8,51 @@
 	.export _ppu_off,_ppu_on_all,_ppu_on_bg,_ppu_on_spr,_ppu_mask,_ppu_system
 	.export _oam_clear,_oam_size,_oam_spr,_oam_meta_spr,_oam_hide_rest
 	.export _ppu_wait_frame,_ppu_wait_nmi
-	.export _scroll,_split
+	.export _scroll,_split,_split_x,_split_off
 	.export _bank_spr,_bank_bg
 	.export _vram_read,_vram_write
 	.export _music_play,_music_stop,_music_pause
 	.export _sfx_play,_sample_play
 	.export _pad_poll,_pad_trigger,_pad_state
 	.export _rand8,_rand16,_set_rand
-	.export _vram_adr,_vram_put,_vram_fill,_vram_inc,_vram_unrle
+	.export _vram_adr,_vram_put,_vram_fill,_vram_inc,_vram_unrle,_vram_unlz
 	.export _set_vram_update,_flush_vram_update
 	.export _memcpy,_memfill,_delay
+.ifdef MAPPER_UNROM
+	.export _bank_prg
+.endif
+.ifdef PERF_OVERLAY
+	.export _nesclock,_ppu_mask_now
+.endif
+
+
+
+;NMI stage probes, only assembled with -D NMI_PROFILE (NMI_PROFILE=1 ./compile.sh)
+;every stage end writes to its own unused I/O register ($4018-$401e), so no CPU register
+;is touched and the cost is 4 cycles per probe; nesbench timestamps these writes
+
+NMI_PROBE_ENTRY		=0		;registers saved
+NMI_PROBE_OAM		=1		;OAM DMA done
+NMI_PROBE_PAL		=2		;palette upload done
+NMI_PROBE_VRAM		=3		;update list flushed
+NMI_PROBE_PPU		=4		;scroll and mask written, last PPU access in vblank
+NMI_PROBE_SPLIT		=5		;screen split done (waiting for sprite 0 is most of it)
+NMI_PROBE_SOUND		=6		;FamiToneUpdate done
+
+;the HUD split polls the sprite 0 hit in loops of at least one scanline each (116 cycles,
+;an NTSC line is 113.7 and a PAL one 106.6), so every wait is bounded in scanlines
+
+SPLIT_LINE_LOOPS	=10		;hit polls per scanline loop
+SPLIT_WAIT_LINES	=10		;lines waited after vblank past sprite 0's Y (an 8-line sprite hits by Y+9)
+SPLIT_MAX_Y			=128	;sprite 0 lower than this skips the split, so the longest wait ends mid-frame
+SPLIT_VBLANK_NTSC	=21		;vblank lines left after the NMI, and the pre-render line
+SPLIT_VBLANK_PAL	=71
+
+.macro nmi_probe stage
+.ifdef NMI_PROFILE
+	sta $4018+stage
+.endif
+.endmacro
 
 
 
@@ -30,6 +65,8 @@ nmi:
 	tya
 	pha
 
+	nmi_probe NMI_PROBE_ENTRY
+
 	lda <PPU_MASK_VAR	;if rendering is disabled, do not access the VRAM at all
 	and #%00011000
 	bne @doUpdate
@@ -40,6 +77,8 @@ nmi:
 	lda #>OAM_BUF		;update OAM
 	sta PPU_OAM_DMA
 
+	nmi_probe NMI_PROBE_OAM
+
 	lda <PAL_UPDATE		;update palette if needed
 	bne @updPal
 	jmp @updVRAM
@@ -84,6 +123,8 @@ nmi:
 
 @updVRAM:
 
+	nmi_probe NMI_PROBE_PAL
+
 	lda <VRAM_UPDATE
 	beq @skipUpd
 	lda #0
@@ -96,6 +137,8 @@ nmi:
 
 @skipUpd:
 
+	nmi_probe NMI_PROBE_VRAM
+
 	lda #0
 	sta PPU_ADDR
 	sta PPU_ADDR
@@ -113,17 +156,109 @@ nmi:
 	lda <PPU_MASK_VAR
 	sta PPU_MASK
 
-	inc <FRAME_CNT1
-	inc <FRAME_CNT2
-	lda <FRAME_CNT2
-	cmp #6
-	bne @skipNtsc
+	nmi_probe NMI_PROBE_PPU
+
+	lda <SPLIT_NT		;screen split below the sprite 0 hit, set by split_x
+	bpl @skipSplit
+	lda <PPU_MASK_VAR	;sprite 0 never hits without both background and sprites
+	and #%00011000
+	cmp #%00011000
+	bne @skipSplit
+
+	lda <PPU_CTRL_VAR
+	and #$fc
+	sta <SPLIT_CTRL
+	lda <SPLIT_NT
+	and #$01
+	ora <SPLIT_CTRL
+	sta <SPLIT_CTRL
+
+	lda OAM_BUF+0		;a hidden or low sprite 0 skips the split
+	cmp #SPLIT_MAX_Y
+	bcs @skipSplit
+	adc #SPLIT_WAIT_LINES	;carry is clear, lines to wait for the hit once vblank is over
+	bit PPU_STATUS
+	bvs @splitVblank
+	ldx <NTSC_MODE		;no hit last frame to see vblank end by, wait through it too
+	bne @splitNtsc
+	adc #SPLIT_VBLANK_PAL
+	bcc @splitLimit		;bra
+@splitNtsc:
+	adc #SPLIT_VBLANK_NTSC
+	bcc @splitLimit		;bra
+
+@splitVblank:
+
+	pha
+	ldy #SPLIT_VBLANK_PAL
+	ldx <NTSC_MODE
+	beq @splitVblankLine
+	ldy #SPLIT_VBLANK_NTSC
+
+@splitVblankLine:
+
+	ldx #SPLIT_LINE_LOOPS
+
+@splitVblankWait:
+
+	bit PPU_STATUS		;the previous hit is cleared at the end of vblank
+	bvc @splitVblankEnd
+	dex
+	bne @splitVblankWait
+	dey
+	bne @splitVblankLine
+	pla					;still set a whole vblank later, so this frame's hit is past already
+	jmp @skipSplit
+
+@splitVblankEnd:
+
+	pla
+
+@splitLimit:
+
+	tay
+
+@splitLine:
+
+	ldx #SPLIT_LINE_LOOPS
+
+@splitWait:
+
+	bit PPU_STATUS
+	bvs @splitHit
+	dex
+	bne @splitWait
+	dey
+	bne @splitLine
+	beq @skipSplit		;bra, sprite 0 is not over the background
+
+@splitHit:
+
+	lda <SPLIT_X
+	sta PPU_SCROLL
 	lda #0
-	sta <FRAME_CNT2
+	sta PPU_SCROLL
+	lda <SPLIT_CTRL
+	sta PPU_CTRL
+
+@skipSplit:
 
-@skipNtsc:
+	nmi_probe NMI_PROBE_SPLIT
 
+	inc <FRAME_CNT1
+
+.ifdef MAPPER_UNROM
+	lda #BANK_MUSIC		;map the music data without touching PRG_BANK,
+	sta prgBankTable+BANK_MUSIC	;so the bank the main thread uses comes back after
 	jsr FamiToneUpdate
+	ldy <PRG_BANK
+	tya
+	sta prgBankTable,y
+.else
+	jsr FamiToneUpdate
+.endif
+
+	nmi_probe NMI_PROBE_SOUND
 
 	pla
 	tay
@@ -316,6 +451,32 @@ _ppu_mask:
 
 
 
+;the CPU load bar of perfOverlay.h, only assembled with -D PERF_OVERLAY
+
+.ifdef PERF_OVERLAY
+
+;unsigned char __fastcall__ nesclock(void);
+
+_nesclock:
+
+	lda <FRAME_CNT1
+	ldx #0
+	rts
+
+
+
+;void __fastcall__ ppu_mask_now(unsigned char mask);
+
+_ppu_mask_now:
+
+	ora <PPU_MASK_VAR
+	sta PPU_MASK
+	rts
+
+.endif
+
+
+
 ;unsigned char __fastcall__ ppu_system(void);
 
 _ppu_system:
@@ -486,17 +647,6 @@ _ppu_wait_frame:
 
 	cmp <FRAME_CNT1
 	beq @1
-	lda <NTSC_MODE
-	beq @3
-
-@2:
-
-	lda <FRAME_CNT2
-	cmp #5
-	beq @2
-
-@3:
-
 	rts
 
 
@@ -518,7 +668,29 @@ _ppu_wait_nmi:
 
 ;void __fastcall__ vram_unrle(const unsigned char *data);
 
+.ifdef MAPPER_UNROM
+
+;trampoline, RLE nametables are in the screens bank
+
+_vram_unrle:
+
+	sta <RLE_LOW
+	stx <RLE_HIGH
+	lda <PRG_BANK
+	pha
+	lda #BANK_SCREENS
+	jsr bankSwitch
+	lda <RLE_LOW
+	ldx <RLE_HIGH
+	jsr vramUnrle
+	pla
+	jmp bankSwitch
+
+vramUnrle:
+
+.else
 _vram_unrle:
+.endif
 
 	tay
 	stx <RLE_HIGH
@@ -572,6 +744,139 @@ _vram_unrle:
 
 
 
+;void __fastcall__ vram_unlz(const unsigned char *data);
+;LZ nametables from tools/screenpack.c (format there); a copy takes its bytes from
+;earlier in the packed data, so nothing is read back from the PPU
+;the data is read with (LZ_LOW),y: y stays below 128 before a token, and the pointer
+;moves on 64 bytes when it does not, so a copy reaches at least 64 bytes back
+;runs write 4 bytes per loop; screenpack -b counts the cycles of every path here
+
+.ifdef MAPPER_UNROM
+
+;trampoline, LZ nametables are in the screens bank
+
+_vram_unlz:
+
+	sta <LZ_LOW
+	stx <LZ_HIGH
+	lda <PRG_BANK
+	pha
+	lda #BANK_SCREENS
+	jsr bankSwitch
+	lda <LZ_LOW
+	ldx <LZ_HIGH
+	jsr vramUnlz
+	pla
+	jmp bankSwitch
+
+vramUnlz:
+
+.else
+_vram_unlz:
+.endif
+
+	sta <LZ_LOW
+	stx <LZ_HIGH
+	ldy #0
+
+@token:
+
+	lda (LZ_LOW),y
+	bmi @runOrCopy
+	beq @done
+	iny
+	tax
+
+@literal:
+
+	lda (LZ_LOW),y
+	sta PPU_DATA
+	iny
+	dex
+	bne @literal
+
+@next:
+
+	cpy #$80
+	bcc @token
+
+	tya						;carry is set, y-64
+	sbc #64
+	tay
+	lda <LZ_LOW				;carry is still set, pointer+64
+	adc #63
+	sta <LZ_LOW
+	bcc @token
+	inc <LZ_HIGH
+	bcs @token
+
+@done:
+
+	rts
+
+@runOrCopy:
+
+	iny
+	cmp #$c0
+	bcs @copy
+	and #$3f
+	bne @run
+	lda (LZ_LOW),y			;$80, the count follows
+	iny
+
+@run:
+
+	sta <LZ_LEN
+	lda (LZ_LOW),y
+	iny
+	lsr <LZ_LEN
+	bcc @run2
+	sta PPU_DATA
+
+@run2:
+
+	lsr <LZ_LEN
+	bcc @run4
+	sta PPU_DATA
+	sta PPU_DATA
+
+@run4:
+
+	ldx <LZ_LEN
+	beq @next
+
+@run4loop:
+
+	sta PPU_DATA
+	sta PPU_DATA
+	sta PPU_DATA
+	sta PPU_DATA
+	dex
+	bne @run4loop
+	beq @next
+
+@copy:
+
+	and #$3f
+	tax
+	tya						;carry is set, y minus the distance
+	sbc (LZ_LOW),y
+	iny
+	sty <LZ_LEN
+	tay
+
+@copyLoop:
+
+	lda (LZ_LOW),y
+	sta PPU_DATA
+	iny
+	dex
+	bne @copyLoop
+	ldy <LZ_LEN
+	bne @next
+
+
+
 ;void __fastcall__ scroll(unsigned int x,unsigned int y);
 
 _scroll:
@@ -648,6 +953,55 @@ _split:
 
 
 
+;void __fastcall__ split_x(unsigned int x);
+
+_split_x:
+
+	sta <SPLIT_X
+	txa
+	and #$01
+	ora #$80
+	sta <SPLIT_NT
+	rts
+
+
+
+;void __fastcall__ split_off(void);
+
+_split_off:
+
+	lda #0
+	sta <SPLIT_NT
+	rts
+
+
+
+.ifdef MAPPER_UNROM
+
+;unsigned char __fastcall__ bank_prg(unsigned char n);
+
+_bank_prg:
+
+	ldx <PRG_BANK
+	jsr bankSwitch
+	txa
+	ldx #0
+	rts
+
+;maps PRG bank A at $8000 and remembers it in PRG_BANK, keeps X
+;UNROM has bus conflicts, so the value is written over a ROM byte that holds the same value
+
+bankSwitch:
+
+	sta <PRG_BANK
+	tay
+	sta prgBankTable,y
+	rts
+
+.endif
+
+
+
 ;void __fastcall__ bank_spr(unsigned char n);
 
 _bank_spr:
@@ -766,7 +1120,25 @@ _vram_write:
 ;void __fastcall__ music_play(unsigned char song);
 
 .if(FT_MUSIC_ENABLE)
+.ifdef MAPPER_UNROM
+
+;trampoline, the song header is in the music bank
+
+_music_play:
+
+	tax
+	lda <PRG_BANK
+	pha
+	lda #BANK_MUSIC
+	jsr bankSwitch
+	txa
+	jsr FamiToneMusicPlay
+	pla
+	jmp bankSwitch
+
+.else
 _music_play=FamiToneMusicPlay
+.endif
 .else
 _music_play=FamiToneMusicStop
 .endif
@@ -796,7 +1168,21 @@ _sfx_play:
 	lda @sfxPriority,x
 	tax
 	jsr popa
+.ifdef MAPPER_UNROM
+	tay					;trampoline, the effect table is in the music bank
+	lda <PRG_BANK
+	pha
+	tya
+	pha
+	lda #BANK_MUSIC
+	jsr bankSwitch
+	pla
+	jsr FamiToneSfxPlay
+	pla
+	jmp bankSwitch
+.else
 	jmp FamiToneSfxPlay
+.endif
 
 @sfxPriority:
 
@@ -1260,4 +1646,9 @@ palBrightTable8:
 	.byte $30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30
 	.byte $30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30,$30
 
+.ifdef MAPPER_UNROM
+prgBankTable:
+	.byte 0,1,2,3,4,5,6
+.endif
+
 	.include "famitone2.s"
\ No newline at end of file
@@ -22,6 +22,15 @@
 #define DIR_UP			PAD_UP
 #define DIR_DOWN		PAD_DOWN
 
+// Video systems, as read from ppu_system; they index the per-region speed tables
+#define REGION_PAL		0
+#define REGION_NTSC		1
+// A delay in PAL frames in NTSC frames
+#define NTSC_FRAMES(n)		(((n)*6 + 2)/5)
+
+// Frames between fade steps
+#define FADE_DELAY		4
+
 // Put all the subsequent global vars into zeropage
 #pragma bss-name (push,"ZEROPAGE")
 #pragma data-name(push,"ZEROPAGE")
@@ -31,6 +40,8 @@
 static unsigned char i;
 static unsigned char j;
 static unsigned char frameCounter;
+// NTSC frames since frameCounter last skipped one (see countFrame)
+static unsigned char frameSkip;
 static unsigned char input;
 static unsigned char wait;
 
@@ -51,13 +62,15 @@ static unsigned char gameLevel;
 
 // Used in fade functions (pal_fade_to, game loop fade)
 static unsigned char bright;
+// Video system the game runs on (REGION_PAL or REGION_NTSC)
+static unsigned char region;
+// Frames between fade steps, per region
+const unsigned char fadeDelayTable[2] = { FADE_DELAY, NTSC_FRAMES(FADE_DELAY) };
 
-// Total number of collected items
-static unsigned char totalItemsCollected5;	// x0000
-static unsigned char totalItemsCollected4;	// 0x000
-static unsigned char totalItemsCollected3;	// 00x00
-static unsigned char totalItemsCollected2;	// 000x0
-static unsigned char totalItemsCollected1;	// 0000x
+// Total number of collected items, packed BCD (see bcd.h), up to 99999
+#define TOTAL_ITEMS_BYTES	3
+#define TOTAL_ITEMS_DIGITS	5
+static unsigned char totalItemsCollected[TOTAL_ITEMS_BYTES];
 
 #pragma data-name(pop)
 #pragma bss-name (pop)
@@ -67,14 +80,14 @@ static unsigned char totalItemsCollected1;	// 0000x
 #include "soundsAndMusic/soundsAndMusic.h"
 
 // Smoothly fade current bright to the given value
-// When to=0, stop music, turn display off, reset vram update and scroll
+// When to=0, stop music, turn display off, reset vram update, scroll and split
 void pal_fade_to(unsigned to)
 {
 	if (!to) music_stop();
 
 	while (bright != to)
 	{
-		delay(4);
+		delay(fadeDelayTable[region]);
 		if (bright<to) 	++bright;
 		else 			--bright;
 		pal_bright(bright);
@@ -85,10 +98,30 @@ void pal_fade_to(unsigned to)
 		ppu_off();
 		set_vram_update(NULL);
 		scroll(0,0);
+		split_off();
+	}
+}
+
+// Counts the frame in frameCounter, which counts PAL frames: NTSC leaves every sixth
+//	frame out, so the timers read from it keep the same pace; returns whether it counted
+unsigned char countFrame(void)
+{
+	if (region == REGION_NTSC && ++frameSkip == 6)
+	{
+		frameSkip = 0;
+		return FALSE;
 	}
+	++frameCounter;
+	return TRUE;
 }
 
 #include "gameConstants.h"
+#include "inputLog.h"
+#include "save.h"
+#include "vramQueue.h"
+#include "bcd.h"
+#include "perfOverlay.h"
+#include "oamManager.h"
 #include "titlePhase.h"
 #include "gamePhase.h"
 #include "resultPhase.h"
@@ -96,17 +129,30 @@ void pal_fade_to(unsigned to)
 // Program entry-point
 void main(void)
 {
+	// The loop runs at the TV's own rate, speeds and delays follow it
+	region = ppu_system() ? REGION_NTSC : REGION_PAL;
+	
+	// Find the save, before a replay-best build looks for its replay
+	saveLoad();
+	
+	// Start recording or replaying pad input, in builds that do
+	inputLogInit();
+	
 	while (1) // Infinite loop
 	{
 		titlePhase();
 		
 		gameLevel = LEVEL_START;
 		gameDone = FALSE;
+		saveReplayStart();
 		
 		while (!gameDone)
 		{
 			gamePhase();
 		}
+		
+		// Best total and replay, with the last level's best percent
+		saveGame();
 
 		resultPhase();
 	}
@@ -0,0 +1,362 @@
+/******************************************************************************
+*  @file       	mazeGen.h
+*  @brief      	Generated maze levels, built a slice per frame
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Levels from LEVEL_COUNT on (past the level pack) are mazes
+*		generated straight into map[], from a 16-bit seed that follows
+*		from MAZE_SEED and the level number, so every level is the same
+*		each time it is played and costs no ROM
+*		> Maze cells are the map tiles at odd x and odd map row, the walls
+*		between them at even ones. The maze is carved by hunt-and-kill: a
+*		random walk to uncarved cells until it is stuck, then a scan for
+*		an uncarved cell next to a carved one to walk on from. It needs no
+*		stack, and every cell is carved and joined to the others, so the
+*		exit can always be reached from the start. MAZE_LOOPS opens more
+*		walls, for other ways round
+*		> Open map tiles get items at MAZE_ITEM_DENSITY, the start is the
+*		upper left cell, the exit a cell of the last column, and enemies
+*		(MAZE_ENEMIES, always moving, so none stands in a corridor for
+*		good) start on cells away from the start
+*		> The level header (start, item count, width and enemy list, as in
+*		the level pack) goes to mazeHeader, for initGameMap to read
+*		> mazeBegin starts the next level while the last one is still on
+*		screen, prepareLevel (gamePhase.h) runs MAZE_STEPS_PER_FRAME steps
+*		of it per frame in the end delay, and mazeFinish runs what is left
+*		> The steps per frame are a guess until measured: the second run of
+*		./compile.sh bench goes on to the first generated level, and its
+*		game phase peak cycles and lag frames include the end delay frames
+*		that build the maze (./compile.sh profile gives mazeStep's share)
+******************************************************************************/
+
+// Cells across and down, and the last cell's map tile column and map row
+#define MAZE_CELLS_X		((MAZE_WIDTH-2)>>1)
+#define MAZE_CELLS_Y		((MAP_HEIGHT-1)>>1)
+#define MAZE_LAST_X			(MAZE_CELLS_X*2-1)
+#define MAZE_LAST_Y			(HUD_HEIGHT+MAZE_CELLS_Y*2-1)
+#define MAZE_FIRST_Y		(HUD_HEIGHT+1)
+
+// Enemies start at least this far right, in map tiles
+#define MAZE_ENEMY_MIN_X	7
+// Tries at a free cell for each enemy
+#define MAZE_ENEMY_TRIES	8
+
+// Steps per frame in the end delay: a map row, a walk or a hunted cell each (not measured yet,
+//	see above)
+#define MAZE_STEPS_PER_FRAME	8
+
+// Generator states
+#define MAZE_IDLE		0	// Nothing generated, or the level was used
+#define MAZE_FILL		1	// Walling the map, a map row per step
+#define MAZE_WALK		2	// Walking to uncarved cells
+#define MAZE_HUNT		3	// Looking for the next cell to walk from
+#define MAZE_LOOP		4	// Opening walls, a map row per step
+#define MAZE_DRESS		5	// Placing items, a map row per step
+#define MAZE_PLACE		6	// Start, exit, enemies and the header
+#define MAZE_DONE		7
+
+// Header of the generated level, in the level pack format (no map rows follow)
+static unsigned char mazeHeader[LEVEL_ENEMY_LIST + MAZE_ENEMIES*LEVEL_ENEMY_SIZE];
+// Percent per item of the generated level (see collectItem)
+static unsigned int mazePercentStep;
+static unsigned char mazePercentRem;
+
+// State, and the level being generated
+static unsigned char mazeState;
+static unsigned char mazeLevel;
+// Cell the walk is on
+static unsigned char mazeCellX;
+static unsigned char mazeCellY;
+// Next cell to hunt at, the first map row that may still have uncarved cells,
+//	and whether the hunted map row had any
+static unsigned char mazeHuntX;
+static unsigned char mazeHuntY;
+static unsigned char mazeHuntRow;
+static unsigned char mazeRowLeft;
+// Items placed
+static unsigned char mazeItems;
+
+#pragma bss-name (push,"ZEROPAGE")
+// Map tile being read or written, and its map[] offset
+static unsigned char mazeX;
+static unsigned char mazeY;
+static unsigned int mazeAdr;
+// Scratch
+static unsigned char mazeDir;
+static unsigned char mazeTry;
+static unsigned char mazeRand;
+static unsigned char mazeSteps;
+#pragma bss-name (pop)
+
+// Cell steps of the enemyDirs directions
+const signed char mazeStepX[4] = { -2, 0, 2, 0 };
+const signed char mazeStepY[4] = { 0, -2, 0, 2 };
+
+// Returns the metatile ID at mazeX,mazeY (no enemies are on the map while generating)
+unsigned char mazeTile(void)
+{
+	mazeAdr = MAP_ADR(mazeX, mazeY);
+	if (mazeX&1)	return map[mazeAdr] >> 4;
+	return map[mazeAdr] & 15;
+}
+
+// Sets the map tile at mazeX,mazeY to metatile id
+void mazeSetTile(unsigned char id)
+{
+	mazeAdr = MAP_ADR(mazeX, mazeY);
+	if (mazeX&1)	map[mazeAdr] = (map[mazeAdr] & 0x0f) | (id << 4);
+	else			map[mazeAdr] = (map[mazeAdr] & 0xf0) | id;
+}
+
+// Returns a random number below n, without a divide
+unsigned char mazeRandom(unsigned char n)
+{
+	mazeRand = rand8();
+	while (mazeRand >= n)	mazeRand -= n;
+	return mazeRand;
+}
+
+// Sets mazeX,mazeY to the cell next to the walk's cell in direction mazeDir;
+//	returns FALSE when that is off the maze
+unsigned char mazeLook(void)
+{
+	mazeX = mazeCellX + mazeStepX[mazeDir];
+	mazeY = mazeCellY + mazeStepY[mazeDir];
+	return (unsigned char)(mazeX - 1) < MAZE_LAST_X && (unsigned char)(mazeY - MAZE_FIRST_Y) < MAZE_LAST_Y - HUD_HEIGHT;
+}
+
+// Carves the wall between the walk's cell and mazeX,mazeY, and the walk's cell
+void mazeCarve(void)
+{
+	mazeX = (mazeX + mazeCellX) >> 1;
+	mazeY = (mazeY + mazeCellY) >> 1;
+	mazeSetTile(MT_EMPTY);
+	mazeX = mazeCellX;
+	mazeY = mazeCellY;
+	mazeSetTile(MT_EMPTY);
+}
+
+// Starts generating level gameLevel
+void mazeBegin(void)
+{
+	// The seed bytes are 8-bit generators that never leave 0
+	i16 = MAZE_SEED + (((unsigned int)gameLevel << 8) | gameLevel);
+	if (!(unsigned char)i16)	++i16;
+	if (!(i16 >> 8))			i16 |= 0x100;
+	set_rand(i16);
+
+	mazeLevel = gameLevel;
+	mazeState = MAZE_FILL;
+	mazeY = HUD_HEIGHT;
+	mazeItems = 0;
+}
+
+// One walk step: on to a random uncarved cell next to the walk's cell, or hunting
+//	when there is none
+void mazeWalk(void)
+{
+	mazeDir = rand8() & 3;
+	for (mazeTry = 4; mazeTry; --mazeTry)
+	{
+		if (mazeLook() && mazeTile() == MT_WALL)
+		{
+			// Walk on to it, carving it and the wall to the cell walked from
+			mazeCellX = mazeX;
+			mazeCellY = mazeY;
+			mazeX -= mazeStepX[mazeDir];
+			mazeY -= mazeStepY[mazeDir];
+			mazeCarve();
+			return;
+		}
+		mazeDir = (mazeDir + 1) & 3;
+	}
+
+	mazeState = MAZE_HUNT;
+	mazeHuntX = 1;
+	mazeHuntY = mazeHuntRow;
+	mazeRowLeft = FALSE;
+}
+
+// One hunt step: if the cell at mazeHuntX,mazeHuntY is uncarved and next to a carved
+//	one, joins them and walks on from it
+void mazeHunt(void)
+{
+	mazeX = mazeHuntX;
+	mazeY = mazeHuntY;
+	if (mazeTile() == MT_WALL)
+	{
+		mazeRowLeft = TRUE;
+		mazeCellX = mazeHuntX;
+		mazeCellY = mazeHuntY;
+		mazeDir = rand8() & 3;
+		for (mazeTry = 4; mazeTry; --mazeTry)
+		{
+			if (mazeLook() && mazeTile() != MT_WALL)
+			{
+				mazeCarve();
+				mazeState = MAZE_WALK;
+				return;
+			}
+			mazeDir = (mazeDir + 1) & 3;
+		}
+	}
+
+	mazeHuntX += 2;
+	if (mazeHuntX <= MAZE_LAST_X)	return;
+
+	// A map row with no uncarved cells left is not scanned again
+	if (!mazeRowLeft && mazeHuntY == mazeHuntRow)	mazeHuntRow += 2;
+	mazeRowLeft = FALSE;
+	mazeHuntX = 1;
+	mazeHuntY += 2;
+	if (mazeHuntY <= MAZE_LAST_Y)	return;
+
+	// A whole scan found nothing: every cell is carved
+	mazeState = MAZE_LOOP;
+	mazeY = MAZE_FIRST_Y;
+}
+
+// Opens each wall between two cells on map row mazeY at the MAZE_LOOPS chance
+void mazeLoopRow(void)
+{
+	// Walls between cells above and below are on even map rows, the others on odd ones
+	mazeX = ((mazeY - HUD_HEIGHT) & 1) ? 2 : 1;
+	for (; mazeX <= MAZE_LAST_X; mazeX += 2)
+	{
+		if (mazeTile() == MT_WALL && rand8() < MAZE_LOOPS)	mazeSetTile(MT_EMPTY);
+	}
+
+	if (++mazeY <= MAZE_LAST_Y)	return;
+	mazeState = MAZE_DRESS;
+	mazeY = MAZE_FIRST_Y;
+}
+
+// Puts items on the open map tiles of map row mazeY at the MAZE_ITEM_DENSITY chance
+void mazeDressRow(void)
+{
+	for (mazeX = 1; mazeX <= MAZE_LAST_X; ++mazeX)
+	{
+		if (mazeTile() == MT_EMPTY && mazeItems != 255 && rand8() < MAZE_ITEM_DENSITY)
+		{
+			mazeSetTile(MT_ITEM);
+			++mazeItems;
+		}
+	}
+
+	if (++mazeY <= MAZE_LAST_Y)	return;
+	mazeState = MAZE_PLACE;
+}
+
+// Places the start, exit and enemies and writes the header
+void mazePlace(void)
+{
+	// Start on the upper left cell, exit on a cell of the last column
+	mazeX = 1;
+	mazeY = MAZE_FIRST_Y;
+	if (mazeTile() == MT_ITEM)	--mazeItems;
+	mazeSetTile(MT_EMPTY);
+	mazeHeader[LEVEL_START_X] = mazeX;
+	mazeHeader[LEVEL_START_Y] = mazeY;
+
+	mazeX = MAZE_LAST_X;
+	mazeY = MAZE_FIRST_Y + (mazeRandom(MAZE_CELLS_Y) << 1);
+	if (mazeTile() == MT_ITEM)	--mazeItems;
+	mazeSetTile(MT_EXIT);
+
+	// A level needs an item: the start cell is a corner, so the wall below it or the
+	//	one right of it is open
+	if (!mazeItems)
+	{
+		mazeX = 1;
+		mazeY = MAZE_FIRST_Y + 1;
+		if (mazeTile() != MT_EMPTY)
+		{
+			mazeX = 2;
+			mazeY = MAZE_FIRST_Y;
+		}
+		mazeSetTile(MT_ITEM);
+		mazeItems = 1;
+	}
+
+	mazeHeader[LEVEL_ITEMS] = mazeItems;
+	mazeHeader[LEVEL_WIDTH] = MAZE_WIDTH;
+
+	// Enemies on free cells right of MAZE_ENEMY_MIN_X, none on the exit or on another
+	// (mazeTile uses mazeAdr, so j is the end of the list)
+	mazeHeader[LEVEL_ENEMIES] = 0;
+	j = LEVEL_ENEMY_LIST;
+	for (mazeTry = 0; mazeTry < MAZE_ENEMIES; ++mazeTry)
+	{
+		for (mazeDir = MAZE_ENEMY_TRIES; mazeDir; --mazeDir)
+		{
+			mazeX = 1 + (mazeRandom(MAZE_CELLS_X) << 1);
+			mazeY = MAZE_FIRST_Y + (mazeRandom(MAZE_CELLS_Y) << 1);
+			if (mazeX < MAZE_ENEMY_MIN_X || mazeTile() == MT_EXIT)	continue;
+
+			for (i = LEVEL_ENEMY_LIST; i < j; i += LEVEL_ENEMY_SIZE)
+			{
+				if (mazeHeader[i] == mazeX && mazeHeader[i+1] == mazeY)	break;
+			}
+			if (i < j)	continue;
+
+			mazeHeader[j] = mazeX;
+			mazeHeader[j+1] = mazeY;
+			mazeHeader[j+2] = MAZE_ENEMY_SPEED;
+			j += LEVEL_ENEMY_SIZE;
+			++mazeHeader[LEVEL_ENEMIES];
+			break;
+		}
+	}
+
+	// 100 divided by the item count, the quotient in packed BCD
+	mazePercentStep = 0;
+	mazePercentRem = 100;
+	bcdPtr = (unsigned char*)&mazePercentStep;
+	bcdLen = 2;
+	while (mazePercentRem >= mazeItems)
+	{
+		mazePercentRem -= mazeItems;
+		bcdValue = 1;
+		bcdAdd();
+	}
+
+	mazeState = MAZE_DONE;
+}
+
+// Runs up to MAZE_STEPS_PER_FRAME steps of the generator
+void mazeStep(void)
+{
+	for (mazeSteps = MAZE_STEPS_PER_FRAME; mazeSteps; --mazeSteps)
+	{
+		switch (mazeState)
+		{
+			case MAZE_FILL:
+				memfill(map + ((mazeY - HUD_HEIGHT) << MAP_ROW_BIT), (MT_WALL<<4)|MT_WALL, MAZE_WIDTH>>1);
+				if (++mazeY < HUD_HEIGHT+MAP_HEIGHT)	break;
+				// Walk from the start cell
+				mazeCellX = mazeX = 1;
+				mazeCellY = mazeY = MAZE_FIRST_Y;
+				mazeSetTile(MT_EMPTY);
+				mazeHuntRow = MAZE_FIRST_Y;
+				mazeState = MAZE_WALK;
+				break;
+			case MAZE_WALK:		mazeWalk();		break;
+			case MAZE_HUNT:		mazeHunt();		break;
+			case MAZE_LOOP:		mazeLoopRow();	break;
+			case MAZE_DRESS:	mazeDressRow();	break;
+			case MAZE_PLACE:
+				mazePlace();
+				return;
+			default:
+				return;
+		}
+	}
+}
+
+// Runs the generator to the end
+void mazeFinish(void)
+{
+	while (mazeState != MAZE_DONE)	mazeStep();
+}
+
@@ -0,0 +1,63 @@
+/******************************************************************************
+*  @file       	metatiles.h
+*  @brief      	Map metatile definitions
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Every map tile is a 2x2 block of characters (a metatile), and map[]
+*		holds metatile IDs, two per byte. The tables below give the
+*		characters, palette and gameplay flags of each ID
+*		> A metatile is one palette, so the same characters in another
+*		palette are another ID (e.g. a wall variant in a different color)
+*		> tools/levelpack.c reads these tables to turn the characters and
+*		attributes of each map tile in a .nss back into an ID, so the
+*		order of the IDs can change freely. Levels store IDs in 4 bits,
+*		and the game keeps the top one for enemy occupancy (MAP_TAKEN),
+*		so there can be up to 8 of them
+******************************************************************************/
+
+// Metatile IDs
+#define MT_HOLE			0
+#define MT_EMPTY		1
+#define MT_WALL			2
+#define MT_ITEM			3
+#define MT_EXIT			4
+#define METATILE_COUNT	5
+
+// Metatile flags
+#define MTF_SOLID		0x01	// Player cannot move into it
+#define MTF_PICKUP		0x02	// Item, becomes MT_EMPTY when collected
+#define MTF_FALL		0x04	// Lose condition when entered
+#define MTF_EXIT		0x08	// Win condition when entered
+
+// Characters of each metatile (upper left, upper right, lower left, lower right)
+const unsigned char metatileChars[METATILE_COUNT*4] =
+{
+	0x00,0x00,0x00,0x00,	// MT_HOLE
+	0x44,0x44,0x44,0x44,	// MT_EMPTY
+	0x40,0x41,0x42,0x43,	// MT_WALL
+	0x45,0x46,0x47,0x48,	// MT_ITEM
+	0x25,0x38,0x29,0x34		// MT_EXIT
+};
+
+// Palette of each metatile, repeated for all four attribute quadrants
+// (holes are blank, they share the empty tile palette so that leaving
+//	a hole behind does not need an attribute write)
+const unsigned char metatileAttr[METATILE_COUNT] =
+{
+	0xaa,	// MT_HOLE
+	0xaa,	// MT_EMPTY
+	0xff,	// MT_WALL
+	0xaa,	// MT_ITEM
+	0x55	// MT_EXIT
+};
+
+// Gameplay flags of each metatile
+const unsigned char metatileFlags[METATILE_COUNT] =
+{
+	MTF_FALL,	// MT_HOLE
+	0,			// MT_EMPTY
+	MTF_SOLID,	// MT_WALL
+	MTF_PICKUP,	// MT_ITEM
+	MTF_EXIT	// MT_EXIT
+};
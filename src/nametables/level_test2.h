@@ -1,56 +0,0 @@
-const unsigned char level_test2[857]={
-0x01,0x00,0x01,0x47,0xd4,0xd4,0x00,0x01,0x2c,0xd4,0x00,0x01,0x07,0x40,0x41,0x40,
-0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,
-0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x42,0x43,0x42,
-0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,
-0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x40,0x41,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x44,0x01,0x03,0x40,0x41,0x42,0x43,0x47,0x48,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x47,0x48,0x42,0x43,0x44,0x01,0x03,0x42,0x43,0x40,0x41,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x40,0x41,0x44,0x01,0x03,0x25,0x38,0x42,0x43,0x47,0x48,0x47,0x48,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x42,0x43,0x44,0x01,0x03,0x29,0x34,0x40,0x41,0x45,0x46,0x45,0x46,0x40,
-0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x40,0x41,0x44,0x44,0x45,0x46,0x40,0x41,0x42,0x43,0x47,0x48,0x47,0x48,0x42,
-0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,
-0x48,0x42,0x43,0x44,0x44,0x47,0x48,0x42,0x43,0x40,0x41,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x40,
-0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x40,0x41,0x42,0x43,0x47,0x48,0x47,0x48,0x47,
-0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x42,
-0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x42,0x43,0x40,0x41,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x44,0x01,0x05,0x40,0x41,0x40,0x41,0x44,0x44,0x45,0x46,
-0x45,0x46,0x45,0x46,0x40,0x41,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x44,0x01,0x05,0x42,0x43,0x42,0x43,0x44,0x44,0x47,0x48,0x47,0x48,0x47,
-0x48,0x42,0x43,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x44,0x01,0x0b,
-0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x42,0x43,0x47,0x48,0x47,0x48,
-0x47,0x48,0x47,0x48,0x44,0x01,0x0b,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,
-0x43,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x44,0x44,0x40,0x41,0x40,0x41,0x44,
-0x01,0x05,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x42,0x43,
-0x47,0x48,0x47,0x48,0x47,0x48,0x44,0x44,0x42,0x43,0x42,0x43,0x44,0x01,0x05,0x47,
-0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x40,0x41,0x45,0x46,0x45,
-0x46,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x42,0x43,0x47,0x48,0x47,
-0x48,0x42,0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x42,0x43,0x42,0x43,0x47,0x48,0x47,
-0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x40,0x41,0x45,0x46,0x44,
-0x44,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x40,
-0x41,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x40,0x41,0x42,0x43,0x47,0x48,0x44,
-0x44,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x42,0x43,0x42,
-0x43,0x42,0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x42,0x43,0x33,0x44,0x01,0x04,0x40,
-0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x44,0x01,0x05,0x42,0x43,0x47,0x48,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x47,0x48,0x42,0x43,0x40,0x41,0x44,0x01,0x03,0x40,0x41,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x40,0x41,0x42,0x43,0x44,0x01,0x03,0x42,0x43,0x47,0x48,0x47,0x48,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x42,0x43,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,
-0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,
-0x40,0x41,0x40,0x41,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,
-0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,
-0x42,0x43,0x42,0x43,0x00,0x01,0x07,0xbf,0xaf,0x01,0x04,0xbf,0xef,0xbb,0xea,0xfa,
-0xfa,0xaa,0xaa,0xbb,0xe6,0xbb,0xaa,0xaa,0xae,0xeb,0xbe,0xab,0xee,0xbb,0xaa,0xea,
-0xba,0xaa,0x01,0x02,0xee,0xbb,0xee,0xab,0xae,0xfb,0xfa,0xba,0xee,0xba,0xee,0xaa,
-0x01,0x04,0xee,0x0f,0x01,0x06,0x0f,0x01,0x00
-};
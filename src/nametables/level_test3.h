@@ -1,54 +0,0 @@
-const unsigned char level_test3[819]={
-0x01,0x00,0x01,0x47,0xd4,0xd4,0x00,0x01,0x2c,0xd4,0x00,0x01,0x0b,0x40,0x41,0x40,
-0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,
-0x41,0x40,0x41,0x00,0x01,0x09,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,
-0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x00,0x01,0x09,0x40,
-0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x00,0x01,0x03,0x42,0x43,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x00,0x01,0x03,0x40,0x41,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x40,0x41,0x44,0x44,0x10,0x44,0x25,0x38,0x00,0x01,0x03,0x42,0x43,0x47,0x48,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x42,0x43,0x44,0x01,0x03,0x29,0x34,0x00,0x01,0x03,0x40,0x41,0x45,0x46,0x45,0x46,
-0x40,0x41,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,
-0x45,0x46,0x40,0x41,0x40,0x41,0x00,0x01,0x03,0x42,0x43,0x47,0x48,0x47,0x48,0x42,
-0x43,0x42,0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x47,
-0x48,0x42,0x43,0x42,0x43,0x00,0x01,0x03,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,
-0x45,0x46,0x45,0x46,0x40,0x41,0x45,0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x45,0x46,
-0x40,0x41,0x00,0x01,0x05,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,
-0x48,0x42,0x43,0x47,0x48,0x47,0x48,0x42,0x43,0x42,0x43,0x47,0x48,0x42,0x43,0x00,
-0x01,0x03,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x44,0x01,
-0x03,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x00,0x01,0x03,
-0x42,0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x44,0x01,0x03,0x42,
-0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x00,0x01,0x03,0x40,0x41,
-0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x44,0x01,0x07,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x40,0x41,0x00,0x01,0x03,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x44,0x01,0x07,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x00,
-0x01,0x03,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x44,0x01,
-0x03,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x00,0x01,0x03,
-0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x42,0x43,0x44,0x01,0x03,0x47,
-0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x42,0x43,0x00,0x01,0x03,0x40,0x41,
-0x45,0x46,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x40,0x41,0x45,0x46,0x45,0x46,
-0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x00,0x01,0x05,0x42,0x43,0x47,0x48,0x42,
-0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,
-0x48,0x47,0x48,0x42,0x43,0x00,0x01,0x03,0x40,0x41,0x40,0x41,0x45,0x46,0x40,0x41,
-0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x40,0x41,0x40,0x41,0x45,0x46,
-0x45,0x46,0x40,0x41,0x00,0x01,0x03,0x42,0x43,0x42,0x43,0x47,0x48,0x42,0x43,0x47,
-0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x42,0x43,0x42,0x43,0x47,0x48,0x47,
-0x48,0x42,0x43,0x00,0x01,0x03,0x33,0x44,0x01,0x04,0x40,0x41,0x45,0x46,0x45,0x46,
-0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,
-0x00,0x01,0x03,0x44,0x01,0x05,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x00,0x01,0x03,0x40,
-0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,
-0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x45,0x46,0x40,0x41,0x00,0x01,0x03,0x42,0x43,
-0x42,0x43,0x42,0x43,0x42,0x43,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,
-0x47,0x48,0x47,0x48,0x47,0x48,0x47,0x48,0x42,0x43,0x00,0x01,0x09,0x40,0x41,0x40,
-0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,0x41,0x40,
-0x41,0x40,0x41,0x00,0x01,0x09,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,
-0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x42,0x43,0x00,0x01,0x0b,0xff,
-0xbf,0xaf,0x01,0x03,0xff,0xf3,0xff,0xbb,0xea,0xfa,0xaa,0xaa,0xbb,0xf6,0xff,0xbb,
-0xaa,0xaa,0xeb,0xbe,0xab,0xff,0xff,0xaa,0xea,0xba,0xaa,0xaa,0xea,0xff,0xff,0xee,
-0xab,0xae,0xfa,0xba,0xee,0xff,0xfa,0xfe,0xaa,0x01,0x03,0xee,0xff,0x0f,0x01,0x06,
-0x0f,0x01,0x00
-};
@@ -0,0 +1,55 @@
+// Generated by tools/levelpack.c, do not edit
+
+#pragma rodata-name (push,"LEVELS0")
+
+const unsigned char level_test[109]={
+0x00,0x0c,0x52,0x10,0x00,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x32,0x33,0x33,
+0x33,0x33,0x13,0x11,0x21,0x32,0x33,0x33,0x33,0x33,0x11,0x11,0x41,0x32,0x33,0x33,
+0x33,0x11,0x11,0x11,0x21,0x32,0x33,0x33,0x11,0x11,0x11,0x11,0x23,0x32,0x33,0x13,
+0x11,0x11,0x11,0x31,0x23,0x32,0x33,0x11,0x11,0x11,0x11,0x33,0x23,0x32,0x13,0x11,
+0x11,0x11,0x31,0x33,0x23,0x32,0x11,0x11,0x11,0x11,0x33,0x33,0x23,0x12,0x11,0x11,
+0x11,0x33,0x33,0x33,0x23,0x11,0x11,0x11,0x33,0x33,0x33,0x33,0x23,0x12,0x11,0x31,
+0x33,0x33,0x33,0x33,0x23,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22
+};
+
+const unsigned char level_test2[109]={
+0x00,0x0c,0x66,0x10,0x00,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x32,0x33,0x33,
+0x33,0x33,0x33,0x12,0x21,0x32,0x33,0x33,0x33,0x33,0x33,0x12,0x41,0x32,0x23,0x22,
+0x22,0x33,0x33,0x12,0x23,0x32,0x33,0x33,0x23,0x32,0x23,0x32,0x23,0x32,0x33,0x33,
+0x11,0x21,0x12,0x33,0x23,0x32,0x33,0x13,0x11,0x11,0x31,0x33,0x23,0x32,0x33,0x21,
+0x12,0x11,0x33,0x33,0x23,0x32,0x23,0x32,0x23,0x32,0x33,0x33,0x23,0x32,0x21,0x33,
+0x33,0x22,0x22,0x32,0x23,0x11,0x21,0x33,0x33,0x33,0x33,0x33,0x23,0x12,0x21,0x33,
+0x33,0x33,0x33,0x33,0x23,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22
+};
+
+const unsigned char level_test3[112]={
+0x00,0x0c,0x58,0x10,0x01,0x0e,0x04,0x00,0x00,0x22,0x22,0x22,0x22,0x22,0x02,0x00,
+0x00,0x32,0x33,0x33,0x33,0x33,0x22,0x22,0x00,0x32,0x33,0x33,0x33,0x33,0x12,0x41,
+0x00,0x32,0x23,0x22,0x33,0x33,0x32,0x22,0x00,0x32,0x33,0x33,0x32,0x23,0x32,0x02,
+0x20,0x32,0x33,0x13,0x21,0x32,0x33,0x02,0x20,0x33,0x33,0x11,0x11,0x33,0x33,0x02,
+0x20,0x33,0x23,0x12,0x31,0x33,0x23,0x02,0x20,0x23,0x32,0x23,0x33,0x33,0x23,0x00,
+0x22,0x23,0x33,0x33,0x22,0x32,0x23,0x00,0x11,0x21,0x33,0x33,0x33,0x33,0x23,0x00,
+0x22,0x22,0x33,0x33,0x33,0x33,0x23,0x00,0x00,0x20,0x22,0x22,0x22,0x22,0x22,0x00
+};
+
+#pragma rodata-name (pop)
+
+#define LEVEL_COUNT 3
+
+const unsigned char* const levelTable[LEVEL_COUNT]={
+level_test,
+level_test2,
+level_test3
+};
+
+const unsigned char levelBank[LEVEL_COUNT]={
+0,0,0
+};
+
+const unsigned int levelPercentStep[LEVEL_COUNT]={
+0x0001,0x0000,0x0001
+};
+
+const unsigned char levelPercentRem[LEVEL_COUNT]={
+18,100,12
+};
@@ -1,9 +0,0 @@
-const unsigned char result_failure[99]={
-0x01,0x00,0x01,0xfe,0x00,0x01,0x88,0x21,0x21,0xd3,0xd3,0xc2,0x00,0x01,0x04,0xd4,
-0x00,0x01,0x05,0xa1,0x00,0x01,0x0c,0x21,0x00,0x00,0x21,0xd3,0x37,0x00,0x01,0x02,
-0x37,0x00,0x37,0xd4,0x00,0x00,0x37,0x00,0x01,0x0f,0x21,0x01,0x03,0xd3,0x37,0x00,
-0x37,0x00,0x37,0xb5,0x37,0xb5,0x37,0xb5,0x37,0xc6,0x01,0x02,0x00,0x01,0x0c,0x21,
-0xb5,0x00,0x21,0xd3,0x00,0x37,0x00,0x37,0x00,0xb5,0x00,0x37,0xb5,0x37,0x00,0x2f,
-0x01,0x02,0x00,0x01,0xfe,0x00,0x01,0xdf,0x44,0x55,0x01,0x03,0x11,0x00,0x01,0x1f,
-0x00,0x01,0x00
-};
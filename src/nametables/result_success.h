@@ -1,12 +0,0 @@
-const unsigned char result_success[146]={
-0x02,0x00,0x02,0xea,0xc2,0x00,0x02,0x04,0xd4,0x00,0x02,0x05,0xa1,0x00,0x02,0x4d,
-0x37,0xd3,0x02,0x02,0x37,0xb5,0x10,0x02,0x02,0x00,0x10,0x02,0x02,0x00,0x34,0x02,
-0x02,0xb2,0x00,0x02,0x0b,0x1e,0x00,0x37,0x00,0x37,0xd3,0x37,0xb5,0x10,0x00,0x10,
-0x00,0x10,0x00,0x10,0x00,0x00,0x34,0xb5,0x00,0x1c,0xa1,0x00,0x02,0x0b,0xd3,0x37,
-0xd3,0x37,0xd3,0xd3,0x10,0x02,0x02,0x00,0x10,0x02,0x02,0x00,0x00,0x34,0xb5,0x00,
-0x00,0xa1,0x00,0x02,0x27,0xb5,0x00,0x02,0x49,0x27,0x2f,0x34,0x00,0x02,0x7b,0x2c,
-0x2f,0x2f,0x34,0x33,0x01,0x00,0x02,0xfe,0x00,0x02,0x18,0xb5,0x00,0x02,0x03,0xb5,
-0xb5,0x00,0xb5,0x00,0x02,0x1c,0x50,0x02,0x05,0x00,0x00,0x44,0x55,0x02,0x03,0x54,
-0x00,0x02,0x02,0x0c,0xff,0xff,0x03,0x00,0x02,0x04,0x0f,0x0f,0x00,0x02,0x11,0x00,
-0x02,0x00
-};
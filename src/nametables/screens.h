@@ -0,0 +1,43 @@
+// Generated by tools/screenpack.c, do not edit
+
+#pragma rodata-name (push,"SCREENS")
+
+const unsigned char title[213]={
+0x80,0xc5,0x00,0x06,0x40,0x41,0x00,0xb3,0x00,0x00,0xc3,0x07,0x04,0x40,0x41,0x40,
+0x41,0xc3,0x0e,0xc4,0x07,0xc3,0x12,0x89,0x00,0x02,0x42,0x43,0xc4,0x10,0x07,0x42,
+0x43,0x00,0x42,0x43,0x42,0x43,0xc7,0x08,0xc3,0x0a,0x89,0x00,0x02,0x40,0x41,0xc4,
+0x0e,0xc3,0x2e,0xc3,0x30,0x87,0x00,0xc3,0x34,0x8a,0x00,0x06,0x42,0x43,0xb4,0x40,
+0x41,0xb4,0xc5,0x24,0xc3,0x41,0x83,0x00,0x02,0xb1,0xb1,0xc3,0x2d,0x8a,0x00,0x03,
+0x40,0x41,0xb3,0xc5,0x18,0x03,0x00,0x40,0x41,0xc3,0x3b,0x83,0x00,0xc3,0x5a,0x8c,
+0x00,0xc3,0x43,0x83,0x00,0xc5,0x47,0x83,0xb1,0x05,0x00,0x00,0xb1,0x42,0x43,0x83,
+0xb1,0x8a,0x00,0xc3,0x70,0x83,0x00,0xc3,0x74,0xc4,0x6d,0xc3,0x78,0xc4,0x71,0xc3,
+0x7c,0x89,0x00,0x02,0x42,0x43,0x84,0x00,0x07,0x42,0x43,0x00,0x42,0x43,0x42,0x43,
+0xc7,0x08,0xc3,0x0a,0x80,0xcf,0x00,0x0b,0x30,0x32,0x25,0x33,0x33,0x00,0x33,0x34,
+0x21,0x32,0x34,0xb6,0x00,0x02,0xa6,0xa6,0x80,0x5e,0x00,0x08,0x12,0x10,0x11,0x17,
+0x00,0x32,0x2f,0x2e,0x80,0x95,0x00,0x86,0xff,0x02,0x00,0x00,0x83,0xff,0x05,0xf3,
+0xff,0xff,0x00,0x00,0x86,0x0f,0x8b,0x00,0x04,0x04,0x05,0x05,0x01,0x85,0x00,0x02,
+0x0a,0x0a,0x8b,0x00,0x00
+};
+
+const unsigned char result_success[143]={
+0x80,0xeb,0x00,0x01,0xc2,0x85,0x00,0x01,0xd4,0x86,0x00,0x01,0xa1,0x80,0x4e,0x00,
+0x01,0x37,0x83,0xd3,0x02,0x37,0xb5,0x83,0x10,0x01,0x00,0x83,0x10,0x01,0x00,0x83,
+0x34,0x01,0xb2,0x8c,0x00,0x0c,0x1e,0x00,0x37,0x00,0x37,0xd3,0x37,0xb5,0x10,0x00,
+0x10,0x00,0xc4,0x05,0x06,0x00,0x34,0xb5,0x00,0x1c,0xa1,0x8c,0x00,0x01,0xd3,0xc3,
+0x16,0x02,0xd3,0xd3,0x83,0x10,0x01,0x00,0x83,0x10,0x01,0x00,0xc4,0x18,0x02,0x00,
+0xa1,0xa8,0x00,0x01,0xb5,0x80,0x4a,0x00,0x03,0x27,0x2f,0x34,0x80,0x7c,0x00,0x06,
+0x2c,0x2f,0x2f,0x34,0x33,0x01,0x80,0xff,0x00,0x99,0x00,0x01,0xb5,0x84,0x00,0x04,
+0xb5,0xb5,0x00,0xb5,0x9d,0x00,0x86,0x50,0x03,0x00,0x00,0x44,0x84,0x55,0x01,0x54,
+0x83,0x00,0x04,0x0c,0xff,0xff,0x03,0x85,0x00,0x02,0x0f,0x0f,0x93,0x00,0x00
+};
+
+const unsigned char result_failure[92]={
+0x80,0xff,0x00,0x80,0x89,0x00,0x05,0x21,0x21,0xd3,0xd3,0xc2,0x85,0x00,0x01,0xd4,
+0x86,0x00,0x01,0xa1,0x8d,0x00,0x06,0x21,0x00,0x00,0x21,0xd3,0x37,0x83,0x00,0x07,
+0x37,0x00,0x37,0xd4,0x00,0x00,0x37,0x90,0x00,0x84,0x21,0x01,0xd3,0xc3,0x0e,0x05,
+0x00,0x37,0xb5,0x37,0xb5,0xc3,0x05,0x83,0xc6,0x8d,0x00,0x02,0x21,0xb5,0xc3,0x26,
+0x01,0x00,0xc3,0x23,0x02,0x00,0xb5,0xc4,0x18,0x01,0x00,0x83,0x2f,0x80,0xff,0x00,
+0x80,0xe0,0x00,0x01,0x44,0x84,0x55,0x01,0x11,0xa1,0x00,0x00
+};
+
+#pragma rodata-name (pop)
@@ -1,18 +0,0 @@
-const unsigned char title_nam[253]={
-0x02,0x00,0x02,0xc4,0x40,0x41,0x00,0xb3,0x00,0x00,0x40,0x41,0x00,0x40,0x41,0x40,
-0x41,0x40,0x41,0x00,0x40,0x41,0x40,0x41,0x40,0x41,0x00,0x02,0x09,0x42,0x43,0x40,
-0x41,0x40,0x41,0x42,0x43,0x00,0x42,0x43,0x42,0x43,0x42,0x43,0x00,0x42,0x43,0x42,
-0x43,0x42,0x43,0x00,0x02,0x09,0x40,0x41,0x42,0x43,0x42,0x43,0x40,0x41,0x00,0x40,
-0x41,0x00,0x02,0x07,0x40,0x41,0x00,0x02,0x0a,0x42,0x43,0xb4,0x40,0x41,0xb4,0x42,
-0x43,0x00,0x42,0x43,0x40,0x41,0x00,0x02,0x03,0xb1,0xb1,0x42,0x43,0x00,0x02,0x0a,
-0x40,0x41,0xb3,0x42,0x43,0xb4,0x40,0x41,0x00,0x40,0x41,0x42,0x43,0x00,0x02,0x03,
-0x40,0x41,0x00,0x02,0x0c,0x42,0x43,0x00,0x02,0x03,0x42,0x43,0x00,0x42,0x43,0xb1,
-0x02,0x02,0x00,0x00,0xb1,0x42,0x43,0xb1,0x02,0x02,0x00,0x02,0x09,0x40,0x41,0x00,
-0x02,0x03,0x40,0x41,0x00,0x40,0x41,0x40,0x41,0x40,0x41,0x00,0x40,0x41,0x40,0x41,
-0x40,0x41,0x00,0x02,0x09,0x42,0x43,0x00,0x02,0x03,0x42,0x43,0x00,0x42,0x43,0x42,
-0x43,0x42,0x43,0x00,0x42,0x43,0x42,0x43,0x42,0x43,0x00,0x02,0xcf,0x30,0x32,0x25,
-0x33,0x33,0x00,0x33,0x34,0x21,0x32,0x34,0x00,0x02,0x35,0xa6,0xa6,0x00,0x02,0x5d,
-0x12,0x10,0x11,0x17,0x00,0x32,0x2f,0x2e,0x00,0x02,0x94,0xff,0x02,0x05,0x00,0x00,
-0xff,0x02,0x02,0xf3,0xff,0xff,0x00,0x00,0x0f,0x02,0x05,0x00,0x02,0x0a,0x04,0x05,
-0x05,0x01,0x00,0x02,0x04,0x0a,0x0a,0x00,0x02,0x09,0x00,0x02,0x00
-};
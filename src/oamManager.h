@@ -0,0 +1,157 @@
+/******************************************************************************
+*  @file       	oamManager.h
+*  @brief      	OAM slot allocator with culling and flicker
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Every object is a 16x16 metasprite (four sprites, two per
+*		scanline) drawn into a slot of its own in the OAM buffer. Game code
+*		calls oamBegin, then oamDraw for each object, then oamEnd, every
+*		frame; the NMI copies the OAM buffer as before
+*		> Objects not fully on screen are culled, and take no slot
+*		> The first OAM_PINNED objects drawn each frame (the player) keep
+*		their slots, the others go round the OAM_ROTATED slots after them
+*		> Sprites are counted per 8-line row of the screen, on every row
+*		a sprite of the object covers (three, or two when the object is on
+*		a row edge). When a row went over the 8 sprites per scanline the
+*		PPU can show, the next frame shifts the objects one rotated slot
+*		along, so the sprites the PPU drops (the highest in OAM) are a
+*		different object every frame and flicker instead of vanishing
+*		> Each slot remembers what it holds, and is only rewritten when its
+*		position or metasprite changes, or hidden when it is freed
+******************************************************************************/
+
+// Slots: pinned, then rotated (power of two), from OAM_FIRST
+// (OAM offset 0 is the HUD split sprite, on the HUD lines where objects never go)
+#define OAM_PINNED		1
+#define OAM_ROTATED		8
+#define OAM_SLOTS		(OAM_PINNED+OAM_ROTATED)
+#define OAM_FIRST		4
+
+// Object size in pixels, and its sprites per scanline
+#define OAM_OBJECT_SIZE		16
+#define OAM_OBJECT_SPRITES	2
+// Sprites per scanline the PPU shows
+#define OAM_LINE_LIMIT		8
+// 8-line rows, one more than the screen has for objects reaching the last line
+#define OAM_ROWS			31
+
+// Sprite y of a hidden slot
+#define OAM_HIDDEN		240
+
+// The OAM buffer copied to the PPU by the NMI (OAM_BUF in crt0.s)
+#define OAM_BUF			((unsigned char*)0x0200)
+
+// Position and metasprite each slot holds, y OAM_HIDDEN when it is hidden
+static unsigned char oamSlotX[OAM_SLOTS];
+static unsigned char oamSlotY[OAM_SLOTS];
+static const unsigned char *oamSlotData[OAM_SLOTS];
+
+#pragma bss-name (push,"ZEROPAGE")
+// Sprites per scanline in each row this frame
+static unsigned char oamRow[OAM_ROWS];
+// Screen position of the object oamDraw draws, x can be off screen
+static unsigned int oamX;
+static unsigned char oamY;
+// Objects drawn this frame (including culled pinned ones)
+static unsigned char oamObject;
+// Rotated slot of the first rotated object
+static unsigned char oamRotation;
+// Whether a row went over OAM_LINE_LIMIT this frame
+static unsigned char oamOverflow;
+// Scratch
+static unsigned char oamSlot;
+static unsigned char oamIdx;
+#pragma bss-name (pop)
+
+// Forgets the slot contents; call right after oam_clear
+void oamInit(void)
+{
+	memfill(oamSlotY, OAM_HIDDEN, OAM_SLOTS);
+	oamRotation = 0;
+	oamOverflow = FALSE;
+}
+
+// Starts a frame of oamDraw calls, rotating the slots if the last frame overflowed
+void oamBegin(void)
+{
+	if (oamOverflow)	++oamRotation;
+	oamOverflow = FALSE;
+	memfill(oamRow, 0, OAM_ROWS);
+	oamObject = 0;
+}
+
+// Hides slot oamSlot unless it is already hidden
+void oamHideSlot(void)
+{
+	if (oamSlotY[oamSlot] == OAM_HIDDEN)	return;
+	oamSlotY[oamSlot] = OAM_HIDDEN;
+
+	oamIdx = OAM_FIRST + (oamSlot << 4);
+	OAM_BUF[oamIdx] = OAM_HIDDEN;
+	OAM_BUF[oamIdx+4] = OAM_HIDDEN;
+	OAM_BUF[oamIdx+8] = OAM_HIDDEN;
+	OAM_BUF[oamIdx+12] = OAM_HIDDEN;
+}
+
+// Adds an object's sprites to row oamIdx
+void oamCountRow(void)
+{
+	oamRow[oamIdx] += OAM_OBJECT_SPRITES;
+	if (oamRow[oamIdx] > OAM_LINE_LIMIT)	oamOverflow = TRUE;
+}
+
+// Draws metasprite data at oamX,oamY into the object's slot
+void oamDraw(const unsigned char *data)
+{
+	// Cull objects not fully on screen
+	if (oamX > 256-OAM_OBJECT_SIZE || oamY > 240-OAM_OBJECT_SIZE)
+	{
+		// A pinned slot stays reserved for its object
+		if (oamObject < OAM_PINNED)
+		{
+			oamSlot = oamObject++;
+			oamHideSlot();
+		}
+		return;
+	}
+
+	if (oamObject < OAM_PINNED)
+	{
+		oamSlot = oamObject;
+	}
+	else
+	{
+		if (oamObject == OAM_SLOTS)	return;
+		oamSlot = OAM_PINNED + ((oamObject - OAM_PINNED + oamRotation) & (OAM_ROTATED-1));
+	}
+	++oamObject;
+
+	// Count the sprites on the rows the object covers, a third one when it is not on a row edge
+	oamIdx = oamY >> 3;
+	oamCountRow();
+	++oamIdx;
+	oamCountRow();
+	if (oamY & 7)
+	{
+		++oamIdx;
+		oamCountRow();
+	}
+
+	// Leave the slot alone when it already holds this
+	if (oamSlotX[oamSlot] == (unsigned char)oamX && oamSlotY[oamSlot] == oamY && oamSlotData[oamSlot] == data)	return;
+	oamSlotX[oamSlot] = oamX;
+	oamSlotY[oamSlot] = oamY;
+	oamSlotData[oamSlot] = data;
+	oam_meta_spr(oamX, oamY, OAM_FIRST + (oamSlot << 4), data);
+}
+
+// Ends the frame's oamDraw calls, hiding the rotated slots no object took
+void oamEnd(void)
+{
+	for (; oamObject < OAM_SLOTS; ++oamObject)
+	{
+		oamSlot = OAM_PINNED + ((oamObject - OAM_PINNED + oamRotation) & (OAM_ROTATED-1));
+		oamHideSlot();
+	}
+}
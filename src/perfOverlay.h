@@ -0,0 +1,88 @@
+/******************************************************************************
+*  @file       	perfOverlay.h
+*  @brief      	CPU load bar and lag counters for the game loop (debug build)
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Built with PERF_OVERLAY (PERF_OVERLAY=1 ./compile.sh), the game
+*		loop turns on grayscale and emphasis with PPU_MASK when its work is
+*		done, until the NMI sets the mask back; the screen above the gray
+*		part is the CPU time the frame took
+*		> A frame is a lag frame when the NMI has already come by the time
+*		the loop reaches ppu_wait_frame. The lag frames so far (packed
+*		BCD, up to 99) and the most NMIs one loop pass missed are drawn in
+*		spare HUD cells
+*		> Without PERF_OVERLAY, the calls compile to nothing
+******************************************************************************/
+
+#ifdef PERF_OVERLAY
+
+// PPU_MASK bits for the part of the screen after the loop's work: grayscale, red and green emphasis
+#define PERF_BAR_MASK	0x61
+
+// Spare HUD cells for the counters
+#define PERF_LAG_ADR	(NTADR_A(28,2))
+#define PERF_PEAK_ADR	(NTADR_A(2,2))
+
+#pragma bss-name (push,"ZEROPAGE")
+// NMI count when the current loop pass started
+static unsigned char perfFrame;
+// Lag frames (packed BCD) and most NMIs missed in one pass
+static unsigned char perfLag;
+static unsigned char perfPeak;
+// Whether the counters changed since they were drawn
+static unsigned char perfDirty;
+#pragma bss-name (pop)
+
+// Starts counting from the first loop pass of a level, and draws the counters then
+void perfBegin(void)
+{
+	perfFrame = nesclock();
+	perfDirty = TRUE;
+}
+
+// Queues the counters when they changed; call before vramQueueCommit
+void perfDraw(void)
+{
+	if (!perfDirty)	return;
+	perfDirty = FALSE;
+
+	bcdPtr = &perfLag;
+	bcdDigits = 2;
+	bcdRender();
+	vramQueueRun(NT_UPD_HORZ, PERF_LAG_ADR, bcdTiles, 2);
+	vramQueuePut(PERF_PEAK_ADR, BCD_TILE_0 + perfPeak);
+}
+
+// Marks the end of the loop's work: counts a lag frame if the NMI came already, and
+//	starts the load bar; call right before ppu_wait_frame
+void perfEnd(void)
+{
+	ppu_mask_now(PERF_BAR_MASK);
+
+	// NMIs missed while working
+	perfFrame = nesclock() - perfFrame;
+	if (!perfFrame)	return;
+
+	if (perfLag != 0x99)
+	{
+		bcdPtr = &perfLag;
+		bcdLen = 1;
+		bcdValue = 1;
+		bcdAdd();
+	}
+	if (perfFrame > perfPeak)	perfPeak = perfFrame < 9 ? perfFrame : 9;
+	perfDirty = TRUE;
+}
+
+// Starts timing the next loop pass; call right after ppu_wait_frame
+#define perfStart()	perfFrame = nesclock()
+
+#else
+
+#define perfBegin()
+#define perfDraw()
+#define perfEnd()
+#define perfStart()
+
+#endif
@@ -9,11 +9,15 @@
 *		> Holds code used exclusively in the result phase
 ******************************************************************************/
 
-#include "nametables/result_success.h"
-#include "nametables/result_failure.h"
-
 // Nametable position and length of "score" text
 #define SCORE_TEXT_ADR 	(NTADR_A(13,18))
+// Nametable position of the save's best total, "BEST " and up to 6 digits
+//	(the UNROM ROM has no save)
+#ifndef MAPPER_UNROM
+#define BEST_TEXT_ADR	(NTADR_A(11,24))
+
+const unsigned char bestText[5] = { 'B'-0x20, 'E'-0x20, 'S'-0x20, 'T'-0x20, 0 };
+#endif
 
 void resultPhase(void)
 {
@@ -28,50 +32,30 @@ void resultPhase(void)
 	vram_adr(NAMETABLE_A);
 	if (gameClear)
 	{
-		vram_unrle(result_success);
+		vram_unlz(result_success);
 		
-		// Write "score" text horizontally centered on screen
-		if (totalItemsCollected5 > 0)
-		{
-			vram_adr(SCORE_TEXT_ADR);
-			vram_put(0x10 + totalItemsCollected5);
-			vram_put(0x10 + totalItemsCollected4);
-			vram_put(0x10 + totalItemsCollected3);
-			vram_put(0x10 + totalItemsCollected2);
-			vram_put(0x10 + totalItemsCollected1);
-		}
-		else if (totalItemsCollected4 > 0)
-		{
-			vram_adr(SCORE_TEXT_ADR + 1);
-			vram_put(0x10 + totalItemsCollected4);
-			vram_put(0x10 + totalItemsCollected3);
-			vram_put(0x10 + totalItemsCollected2);
-			vram_put(0x10 + totalItemsCollected1);
-		}
-		else if (totalItemsCollected3 > 0)
-		{
-			vram_adr(SCORE_TEXT_ADR + 1);
-			vram_put(0x10 + totalItemsCollected3);
-			vram_put(0x10 + totalItemsCollected2);
-			vram_put(0x10 + totalItemsCollected1);
-		}
-		else if (totalItemsCollected2 > 0)
-		{
-			vram_adr(SCORE_TEXT_ADR + 2);
-			vram_put(0x10 + totalItemsCollected2);
-			vram_put(0x10 + totalItemsCollected1);
-		}
-		else
-		{
-			vram_adr(SCORE_TEXT_ADR + 2);
-			vram_put(0x10 + totalItemsCollected1);
-		}
+		// Write "score" text horizontally centered on screen, without leading zeros
+		bcdPtr = totalItemsCollected;
+		bcdDigits = TOTAL_ITEMS_DIGITS;
+		i = bcdRender();
+		vram_adr(SCORE_TEXT_ADR + ((TOTAL_ITEMS_DIGITS+1-i) >> 1));
+		vram_write(bcdTiles + TOTAL_ITEMS_DIGITS - i, i);
 	}
 	else
 	{
-		vram_unrle(result_failure);
+		vram_unlz(result_failure);
 	}
 	
+#ifndef MAPPER_UNROM
+	// Write the best total below, centered the same way
+	bcdPtr = saveSlot + SAVE_TOTAL;
+	bcdDigits = TOTAL_ITEMS_DIGITS;
+	i = bcdRender();
+	vram_adr(BEST_TEXT_ADR + ((TOTAL_ITEMS_DIGITS+1-i) >> 1));
+	vram_write((unsigned char*)bestText, sizeof(bestText));
+	vram_write(bcdTiles + TOTAL_ITEMS_DIGITS - i, i);
+#endif
+	
 	// Enable BG
 	ppu_on_bg();
 	
@@ -83,7 +67,7 @@ void resultPhase(void)
 		ppu_wait_frame();
 		
 		// If start button is pressed, exit the result loop
-		if (pad_trigger(0)&PAD_START)	break;
+		if (padTrigger()&PAD_START)	break;
 	}
 	
 	pal_fade_to(0);
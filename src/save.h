@@ -0,0 +1,298 @@
+/******************************************************************************
+*  @file       	save.h
+*  @brief      	Best scores and best game replay in battery-backed PRG RAM
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> The save keeps the best percent of every level, the best total
+*		and the pad input of the game that scored it, in the battery RAM
+*		at $6000 (the NROM cartridge header asks for it). The UNROM board
+*		has none, and its ROM keeps nothing
+*		> It lives in two slots, each with a serial and a checksum of its
+*		contents; the valid slot with the newest serial is the save.
+*		Writes go to the other slot: its magic is cleared first, the
+*		contents and the checksum follow and the magic goes in last, so
+*		cutting the power at any point leaves the previous save valid
+*		> The slots are only written between phases, with no frame
+*		running: saveLevel starts a save when a level ends on a new best
+*		percent, saveGame adds the total and the replay when a game ends
+*		on a new best, and saveFlush finishes it, once per level or game
+*		at most
+*		> Loading at boot checks the two slots and nothing else (about
+*		530 bytes); the replay is only checked when replayed
+*		> The replay is the one thing written during frames: the 2K of
+*		RAM has no room to hold a game's pad polls until it ends, so every
+*		poll goes straight into the replay area no slot refers to (3 bytes
+*		at most), in the pad log format of inputLog.h after one START poll
+*		for the title. Cutting the power mid-game only loses that game,
+*		and saveGame refers a slot to it between phases; a replay that
+*		outgrows the area is not kept. Each game starts from a new
+*		random seed, kept with the replay, as the enemies' choices depend
+*		on it. INPUT_LOG=replay-best builds start from the kept seed and
+*		play the best replay back
+******************************************************************************/
+
+#ifdef MAPPER_UNROM
+
+// No battery RAM: nothing to load or keep, and the pad is read as it is
+#define saveLoad()
+#define saveLevel(percent)
+#define saveFlush()
+#define saveReplayStart()
+#define saveGame()
+#define padTrigger()		pad_trigger(0)
+
+#else
+
+// Replay areas, the first one shared with the pad log of the INPUT_LOG builds
+//	(the replay checksum tells when the pad log wrote over a kept replay)
+#define SAVE_REPLAY0		((unsigned char*)0x6000)
+#define SAVE_REPLAY1		((unsigned char*)0x6e00)
+#define SAVE_REPLAY_SIZE	0x0e00
+// Save slots
+#define SAVE_SLOT0			((unsigned char*)0x7c00)
+#define SAVE_SLOT1			((unsigned char*)0x7e00)
+
+// Slot layout, in byte offsets: the magic, the serial, the best total (packed BCD
+//	as totalItemsCollected), the replay of the best total (area 0 or 1, or
+//	SAVE_NO_REPLAY), the region, random seed and size of the replay and its checksum, the best
+//	percent of every level (packed BCD, 100 as SAVE_PERCENT_FULL), and the
+//	checksum of everything from the serial on
+#define SAVE_MAGIC0			0
+#define SAVE_MAGIC1			1
+#define SAVE_SERIAL			2
+#define SAVE_TOTAL			3
+#define SAVE_REPLAY			(SAVE_TOTAL+TOTAL_ITEMS_BYTES)
+#define SAVE_REGION			(SAVE_REPLAY+1)
+#define SAVE_SEED			(SAVE_REGION+1)
+#define SAVE_REPLAY_LEN		(SAVE_SEED+2)
+#define SAVE_REPLAY_SUM		(SAVE_REPLAY_LEN+2)
+#define SAVE_PERCENT		(SAVE_REPLAY_SUM+2)
+#define SAVE_CHECKSUM		(SAVE_PERCENT+255)
+#define SAVE_SIZE			(SAVE_CHECKSUM+2)
+
+#define SAVE_MAGIC0_VALUE	'N'
+#define SAVE_MAGIC1_VALUE	'M'
+#define SAVE_NO_REPLAY		0xff
+#define SAVE_PERCENT_FULL	0xa0
+
+// Replay recording states
+#define REPLAY_OFF			0
+#define REPLAY_ON			1
+#define REPLAY_FULL			2
+
+#pragma bss-name (push,"ZEROPAGE")
+// Valid slot, and the slot being written (NULL when none is)
+static unsigned char *saveSlot;
+static unsigned char *saveNext;
+// Run being recorded into the replay area
+static unsigned char *replayPtr;
+// Scratch: checksum range and sums, pad poll
+static unsigned char *savePtr;
+static unsigned char *saveEnd;
+static unsigned char saveSum1;
+static unsigned char saveSum2;
+static unsigned char saveIdx;
+static unsigned char savePad;
+static unsigned char savePadNew;
+#pragma bss-name (pop)
+
+// Replay area being recorded into, its state, and the random seed the game started from
+static unsigned char *replayBase;
+static unsigned char replayState;
+static unsigned int replaySeed;
+
+// Adds up the bytes from savePtr to saveEnd into saveSum1 and saveSum2 (Fletcher
+//	sums, which also catch bytes swapped or moved)
+void saveSum(void)
+{
+	saveSum1 = 0;
+	saveSum2 = 0;
+	while (savePtr != saveEnd)
+	{
+		saveSum1 += *savePtr++;
+		saveSum2 += saveSum1;
+	}
+}
+
+// Whether the slot at savePtr holds a save: magic set and checksum right
+unsigned char saveValid(void)
+{
+	if (savePtr[SAVE_MAGIC0] != SAVE_MAGIC0_VALUE || savePtr[SAVE_MAGIC1] != SAVE_MAGIC1_VALUE)	return FALSE;
+	saveEnd = savePtr + SAVE_CHECKSUM;
+	savePtr += SAVE_SERIAL;
+	saveSum();
+	return saveSum1 == saveEnd[0] && saveSum2 == saveEnd[1];
+}
+
+// Starts the next save in the other slot, as a copy of the valid one
+void saveBegin(void)
+{
+	if (saveNext)	return;
+
+	saveNext = saveSlot == SAVE_SLOT0 ? SAVE_SLOT1 : SAVE_SLOT0;
+	saveNext[SAVE_MAGIC0] = 0;
+	memcpy(saveNext + SAVE_SERIAL, saveSlot + SAVE_SERIAL, SAVE_SIZE - SAVE_SERIAL);
+	++saveNext[SAVE_SERIAL];
+}
+
+// Finishes the save started by saveBegin, which becomes the valid one
+void saveFlush(void)
+{
+	if (!saveNext)	return;
+
+	savePtr = saveNext + SAVE_SERIAL;
+	saveEnd = saveNext + SAVE_CHECKSUM;
+	saveSum();
+	saveNext[SAVE_CHECKSUM] = saveSum1;
+	saveNext[SAVE_CHECKSUM+1] = saveSum2;
+	saveNext[SAVE_MAGIC1] = SAVE_MAGIC1_VALUE;
+	saveNext[SAVE_MAGIC0] = SAVE_MAGIC0_VALUE;
+	saveSlot = saveNext;
+	saveNext = NULL;
+}
+
+// Finds the save, or writes an empty one when neither slot is valid
+void saveLoad(void)
+{
+	saveSlot = NULL;
+	saveNext = NULL;
+
+	savePtr = SAVE_SLOT0;
+	if (saveValid())	saveSlot = SAVE_SLOT0;
+	savePtr = SAVE_SLOT1;
+	if (saveValid() && (!saveSlot || (signed char)(SAVE_SLOT1[SAVE_SERIAL] - saveSlot[SAVE_SERIAL]) > 0))
+	{
+		saveSlot = SAVE_SLOT1;
+	}
+	if (saveSlot)	return;
+
+	saveNext = SAVE_SLOT0;
+	saveNext[SAVE_MAGIC0] = 0;
+	memfill(saveNext + SAVE_SERIAL, 0, SAVE_SIZE - SAVE_SERIAL);
+	saveNext[SAVE_REPLAY] = SAVE_NO_REPLAY;
+	saveFlush();
+}
+
+// Keeps the level's percentCollected (packed BCD, up to 100) as its best percent
+//	if it is one; the write is left for saveFlush
+void saveLevel(unsigned int percent)
+{
+	saveIdx = (percent >> 8) ? SAVE_PERCENT_FULL : (unsigned char)percent;
+	if (saveIdx <= saveSlot[SAVE_PERCENT + gameLevel])	return;
+
+	saveBegin();
+	saveNext[SAVE_PERCENT + gameLevel] = saveIdx;
+}
+
+#if defined(INPUT_RECORD) || defined(INPUT_REPLAY)
+
+#ifdef INPUT_BEST
+// Starts the game from the random seed the best replay was recorded with
+void saveReplayStart(void)
+{
+	set_rand(saveSlot[SAVE_SEED] | (saveSlot[SAVE_SEED+1] << 8));
+}
+#else
+// The pad log builds record nothing more, their logs play out from the reset
+#define saveReplayStart()
+#endif
+
+#else
+
+// Starts recording the game about to start into the replay area the save does not use,
+//	from a new random seed (the generators of both bytes stay nonzero)
+void saveReplayStart(void)
+{
+	replaySeed = rand16();
+	set_rand(replaySeed);
+
+	replayBase = saveSlot[SAVE_REPLAY] ? SAVE_REPLAY0 : SAVE_REPLAY1;
+	replayPtr = replayBase + INPUT_LOG_START;
+	// The title's START press, then the game's polls
+	replayPtr[2] = 0;
+	replayPtr[1] = PAD_START;
+	replayPtr[0] = 1;
+	replayBase[0] = INPUT_LOG_MAGIC0;
+	replayBase[1] = INPUT_LOG_MAGIC1;
+	replayState = REPLAY_ON;
+}
+
+// Polls the pad and, during a game, adds the buttons to the replay as the
+//	INPUT_RECORD builds do; returns the newly pressed buttons
+unsigned char padTrigger(void)
+{
+	savePadNew = pad_trigger(0);
+	if (replayState != REPLAY_ON)	return savePadNew;
+
+	savePad = pad_state(0);
+	if (replayPtr[0] != 255 && replayPtr[1] == savePad)
+	{
+		++replayPtr[0];
+		return savePadNew;
+	}
+
+	if (replayPtr + 4 >= replayBase + SAVE_REPLAY_SIZE)
+	{
+		replayState = REPLAY_FULL;
+		return savePadNew;
+	}
+	replayPtr += 2;
+	replayPtr[2] = 0;
+	replayPtr[1] = savePad;
+	replayPtr[0] = 1;
+	return savePadNew;
+}
+
+#endif
+
+// Ends the replay and keeps totalItemsCollected as the best total if it is one,
+//	with the replay when it was recorded whole, then writes the save
+void saveGame(void)
+{
+	// Most significant byte first, up to the first that differs
+	saveIdx = TOTAL_ITEMS_BYTES;
+	do
+	{
+		--saveIdx;
+	}
+	while (saveIdx && totalItemsCollected[saveIdx] == saveSlot[SAVE_TOTAL + saveIdx]);
+
+	if (totalItemsCollected[saveIdx] > saveSlot[SAVE_TOTAL + saveIdx])
+	{
+		saveBegin();
+		memcpy(saveNext + SAVE_TOTAL, totalItemsCollected, TOTAL_ITEMS_BYTES);
+		saveNext[SAVE_REPLAY] = SAVE_NO_REPLAY;
+		if (replayState == REPLAY_ON)
+		{
+			savePtr = replayBase;
+			saveEnd = replayPtr + 3;
+			saveSum();
+			saveNext[SAVE_REPLAY] = replayBase == SAVE_REPLAY1;
+			saveNext[SAVE_REGION] = region;
+			saveNext[SAVE_SEED] = (unsigned char)replaySeed;
+			saveNext[SAVE_SEED+1] = replaySeed >> 8;
+			saveNext[SAVE_REPLAY_LEN] = (unsigned char)(saveEnd - replayBase);
+			saveNext[SAVE_REPLAY_LEN+1] = (unsigned int)(saveEnd - replayBase) >> 8;
+			saveNext[SAVE_REPLAY_SUM] = saveSum1;
+			saveNext[SAVE_REPLAY_SUM+1] = saveSum2;
+		}
+	}
+	replayState = REPLAY_OFF;
+
+	saveFlush();
+}
+
+// Returns the best replay when it is whole and was recorded on this region, or NULL
+unsigned char* saveReplay(void)
+{
+	if (saveSlot[SAVE_REPLAY] == SAVE_NO_REPLAY || saveSlot[SAVE_REGION] != region)	return NULL;
+
+	savePtr = saveSlot[SAVE_REPLAY] ? SAVE_REPLAY1 : SAVE_REPLAY0;
+	saveEnd = savePtr + (saveSlot[SAVE_REPLAY_LEN] | (saveSlot[SAVE_REPLAY_LEN+1] << 8));
+	saveSum();
+	if (saveSum1 != saveSlot[SAVE_REPLAY_SUM] || saveSum2 != saveSlot[SAVE_REPLAY_SUM+1])	return NULL;
+	return saveSlot[SAVE_REPLAY] ? SAVE_REPLAY1 : SAVE_REPLAY0;
+}
+
+#endif
@@ -1,4 +1,4 @@
-;this file for FamiTone2 libary generated by nsf2data tool
+;generated by tools/soundpack.c from sound/sounds.ftm, do not edit
 
 sounds:
 	.word @sfx_ntsc_0,@sfx_pal_0
@@ -9,7 +9,7 @@
 *		> Holds code for managing sounds and music
 ******************************************************************************/
 
-// Music data is included as .s file generated by the text2data tool from music.ftm
+// Music data is included as .s file generated by tools/soundpack.c from sound/music.ftm
 extern const unsigned char music_music_data[];
 
 // Sound effects enum
@@ -9,8 +9,9 @@
 *		> Holds code used exclusively in the title phase
 ******************************************************************************/
 
-// Nametables for game screens
-#include "nametables/title_nam.h"
+// Nametables for the title and result screens, packed by tools/screenpack.c into the
+//	screens bank read by vram_unlz
+#include "nametables/screens.h"
 
 // Index of color of "press start" text in title palette, used for blinking animation
 #define PRESS_START_PAL_INDEX 6
@@ -32,7 +33,7 @@ void titlePhase(void)
 	
 	// Load title nametable
 	vram_adr(NAMETABLE_A);
-	vram_unrle(title_nam);
+	vram_unlz(title);
 	// Set title palette
 	pal_bg(palTitle);
 	// Turn on background display
@@ -46,10 +47,10 @@ void titlePhase(void)
 		ppu_wait_frame();
 		
 		// If start button is pressed, exit the title loop
-		if (pad_trigger(0)&PAD_START)	break;
+		if (padTrigger()&PAD_START)	break;
 		
-		// Update frame count
-		frameCounter++;
+		// Update frame count, nothing changes on a frame it leaves out
+		if (!countFrame())	continue;
 
 		// Update title screen fade in
 		// Note: Not using pal_fade_to here to allow polling start button simultaneously
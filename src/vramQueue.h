@@ -0,0 +1,143 @@
+/******************************************************************************
+*  @file       	vramQueue.h
+*  @brief      	Batched nametable update queue
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Game code queues single tile writes and horizontal/vertical runs
+*		at any time during the frame; entries are stored in a ring buffer
+*		in the neslib update list format
+*		> Once per frame, before waiting for vblank, vramQueueCommit moves
+*		whole entries into the update list flushed by the NMI until the
+*		frame's cycle budget is used up. Whatever does not fit stays queued
+*		for the next frame, and an empty frame costs the NMI nothing but
+*		the end marker
+*		> Entries are flushed in the order they were queued, so a later
+*		write to the same tile always wins
+*		> Only use while the display is on, the NMI skips the update list
+*		when rendering is off
+******************************************************************************/
+
+// Ring buffer size, must be a power of two
+#define VRAM_QUEUE_SIZE		128
+#define VRAM_QUEUE_MASK		(VRAM_QUEUE_SIZE-1)
+
+// Vblank cycles the NMI may spend in _flush_vram_update_nmi each frame
+// (the rest of the NMI takes about 1000 cycles before its last PPU write)
+#define VRAM_QUEUE_BUDGET	1100
+
+// Worst-case flush cost of each entry type in _flush_vram_update_nmi,
+//	checked against the real code by tools/nmicheck.c at build time
+#define VQ_COST_SINGLE		43
+#define VQ_COST_RUN			75
+#define VQ_COST_RUN_BYTE	17
+// Cost of n run bytes without a runtime multiply (n*17)
+#define VQ_COST_RUN_BYTES(n)	(((unsigned int)(n)<<4) + (n))
+
+// Longest run that fits in one frame's budget; longer runs are split
+#define VQ_MAX_RUN			((VRAM_QUEUE_BUDGET-VQ_COST_RUN)/VQ_COST_RUN_BYTE)
+
+// Update list size: single writes are the most bytes per cycle, plus end marker
+#define VRAM_UPDATE_SIZE	(3*(VRAM_QUEUE_BUDGET/VQ_COST_SINGLE) + 1)
+
+// Pending entries
+static unsigned char vramQueue[VRAM_QUEUE_SIZE];
+// Entries sent this frame, flushed by the NMI
+static unsigned char vramUpdate[VRAM_UPDATE_SIZE];
+
+#pragma bss-name (push,"ZEROPAGE")
+// Next free byte and oldest pending byte in vramQueue
+static unsigned char vqHead;
+static unsigned char vqTail;
+// Scratch for commit
+static unsigned char vqLen;
+static unsigned char vqRun;
+static unsigned char vqOut;
+static unsigned int vqCost;
+#pragma bss-name (pop)
+
+#define VQ_PUSH(b)	{ vramQueue[vqHead] = (b); vqHead = (vqHead + 1) & VRAM_QUEUE_MASK; }
+
+// Empties the queue and hands the (empty) update list to the NMI
+void vramQueueInit(void)
+{
+	vqHead = 0;
+	vqTail = 0;
+	vramUpdate[0] = NT_UPD_EOF;
+	set_vram_update(vramUpdate);
+}
+
+// Moves as many whole entries as the cycle budget allows into the update list
+// Call once per frame, right before ppu_wait_frame
+void vramQueueCommit(void)
+{
+	vqOut = 0;
+	vqCost = 0;
+
+	while (vqTail != vqHead)
+	{
+		// Entry size and cost from its first byte
+		if (vramQueue[vqTail] < NT_UPD_HORZ)
+		{
+			vqLen = 3;
+			vqCost += VQ_COST_SINGLE;
+		}
+		else
+		{
+			vqLen = vramQueue[(vqTail + 2) & VRAM_QUEUE_MASK];
+			vqCost += VQ_COST_RUN + VQ_COST_RUN_BYTES(vqLen);
+			vqLen += 3;
+		}
+
+		// Out of budget: the rest goes next frame
+		if (vqCost > VRAM_QUEUE_BUDGET)	break;
+
+		do
+		{
+			vramUpdate[vqOut++] = vramQueue[vqTail];
+			vqTail = (vqTail + 1) & VRAM_QUEUE_MASK;
+		}
+		while (--vqLen);
+	}
+
+	vramUpdate[vqOut] = NT_UPD_EOF;
+}
+
+// Waits for whole frames of flushing until len bytes are free in the queue
+void vramQueueReserve(unsigned char len)
+{
+	while (((vqTail - vqHead - 1) & VRAM_QUEUE_MASK) < len)
+	{
+		vramQueueCommit();
+		ppu_wait_nmi();
+	}
+}
+
+// Queues a single tile write
+void vramQueuePut(unsigned int adr, unsigned char tile)
+{
+	vramQueueReserve(3);
+	VQ_PUSH(MSB(adr));
+	VQ_PUSH(LSB(adr));
+	VQ_PUSH(tile);
+}
+
+// Queues a run of len tiles going right (NT_UPD_HORZ) or down (NT_UPD_VERT) from adr
+void vramQueueRun(unsigned char dir, unsigned int adr, const unsigned char *data, unsigned char len)
+{
+	while (len)
+	{
+		vqRun = len > VQ_MAX_RUN ? VQ_MAX_RUN : len;
+		vramQueueReserve(vqRun + 3);
+		VQ_PUSH(MSB(adr)|dir);
+		VQ_PUSH(LSB(adr));
+		VQ_PUSH(vqRun);
+		len -= vqRun;
+		adr += dir == NT_UPD_HORZ ? vqRun : vqRun << 5;
+		do
+		{
+			VQ_PUSH(*data++);
+		}
+		while (--vqRun);
+	}
+}
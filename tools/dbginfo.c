@@ -0,0 +1,188 @@
+/******************************************************************************
+*  @file       	dbginfo.c
+*  @brief      	Address to source line map loaded from the ld65 debug file
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Record format is "<type>\t<key>=<value>,<key>=<value>...", e.g.
+*		line	id=12,file=0,line=101,type=1,span=40+41
+*		span	id=40,seg=3,start=120,size=3
+*		seg		id=3,name="CODE",start=0x008123,size=0x1000,...
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbginfo.h"
+
+typedef struct
+{
+	int seg;
+	long start;
+	long size;
+} Span;
+
+// Copies the value of key out of a record body; returns 0 when the key is missing
+static int get_field(const char *body, const char *key, char *out, size_t size)
+{
+	size_t keyLen = strlen(key);
+	const char *p = body;
+
+	while (*p)
+	{
+		if (!strncmp(p, key, keyLen) && p[keyLen] == '=')
+		{
+			size_t n = 0;
+			p += keyLen + 1;
+			if (*p == '"')
+			{
+				++p;
+				while (*p && *p != '"' && n + 1 < size)	out[n++] = *p++;
+			}
+			else
+			{
+				while (*p && *p != ',' && *p != '\n' && *p != '\r' && n + 1 < size)	out[n++] = *p++;
+			}
+			out[n] = 0;
+			return 1;
+		}
+		// Skip to the next field, stepping over quoted values
+		while (*p && *p != ',')
+		{
+			if (*p == '"')
+			{
+				++p;
+				while (*p && *p != '"')	++p;
+			}
+			if (*p)	++p;
+		}
+		if (*p == ',')	++p;
+	}
+	return 0;
+}
+
+static long get_number(const char *body, const char *key, long fallback)
+{
+	char value[64];
+	if (!get_field(body, key, value, sizeof(value)))	return fallback;
+	return strtol(value, NULL, 0);
+}
+
+// Grows an id-indexed array so that index id is valid, zero filling new entries
+static void *grow(void *array, int *count, int id, size_t elemSize)
+{
+	if (id >= *count)
+	{
+		int newCount = id + 1 > *count*2 ? id + 1 : *count*2;
+		array = realloc(array, newCount*elemSize);
+		memset((char *)array + *count*elemSize, 0, (newCount - *count)*elemSize);
+		*count = newCount;
+	}
+	return array;
+}
+
+int dbg_load(DebugInfo *info, const char *path)
+{
+	FILE *f = fopen(path, "r");
+	static char rec[4096];
+	long *segStart = NULL;
+	Span *spans = NULL;
+	char **lineSpans = NULL;
+	int segCount = 0, spanCount = 0, lineCap = 0, fileCap = 0, i;
+
+	memset(info, 0, sizeof(*info));
+	for (i = 0; i < 0x10000; ++i)	info->lineAt[i] = -1;
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+
+	while (fgets(rec, sizeof(rec), f))
+	{
+		char *body = strchr(rec, '\t');
+		int id;
+
+		if (!body)	continue;
+		*body++ = 0;
+		id = (int)get_number(body, "id", -1);
+		if (id < 0)	continue;
+
+		if (!strcmp(rec, "file"))
+		{
+			char name[512];
+			info->files = grow(info->files, &fileCap, id, sizeof(char *));
+			if (get_field(body, "name", name, sizeof(name)))	info->files[id] = strdup(name);
+			if (id >= info->fileCount)	info->fileCount = id + 1;
+		}
+		else if (!strcmp(rec, "seg"))
+		{
+			segStart = grow(segStart, &segCount, id, sizeof(long));
+			segStart[id] = get_number(body, "start", 0);
+		}
+		else if (!strcmp(rec, "span"))
+		{
+			spans = grow(spans, &spanCount, id, sizeof(Span));
+			spans[id].seg = (int)get_number(body, "seg", 0);
+			spans[id].start = get_number(body, "start", 0);
+			spans[id].size = get_number(body, "size", 0);
+		}
+		else if (!strcmp(rec, "line"))
+		{
+			char spanList[1024];
+			int oldCap = lineCap;
+			info->lines = grow(info->lines, &lineCap, id, sizeof(SourceLine));
+			lineSpans = grow(lineSpans, &oldCap, id, sizeof(char *));
+			info->lines[id].file = (int)get_number(body, "file", 0);
+			info->lines[id].line = (int)get_number(body, "line", 0);
+			info->lines[id].isC = get_number(body, "type", 0) == 1;
+			if (get_field(body, "span", spanList, sizeof(spanList)))	lineSpans[id] = strdup(spanList);
+			if (id >= info->lineCount)	info->lineCount = id + 1;
+		}
+	}
+	fclose(f);
+
+	// Resolve line spans to CPU addresses
+	for (i = 0; i < info->lineCount; ++i)
+	{
+		char *p = lineSpans ? lineSpans[i] : NULL;
+
+		while (p && *p)
+		{
+			int spanId = (int)strtol(p, &p, 10);
+			if (*p == '+')	++p;
+
+			if (spanId >= 0 && spanId < spanCount && spans[spanId].seg < segCount)
+			{
+				long adr = segStart[spans[spanId].seg] + spans[spanId].start;
+				long end = adr + spans[spanId].size;
+				for (; adr < end && adr < 0x10000; ++adr)
+				{
+					int32_t old = info->lineAt[adr];
+					if (old < 0 || (!info->lines[old].isC && info->lines[i].isC))	info->lineAt[adr] = i;
+				}
+			}
+			else
+			{
+				break;
+			}
+		}
+		if (lineSpans)	free(lineSpans[i]);
+	}
+
+	free(lineSpans);
+	free(spans);
+	free(segStart);
+	return 0;
+}
+
+void dbg_free(DebugInfo *info)
+{
+	int i;
+	for (i = 0; i < info->fileCount; ++i)	free(info->files[i]);
+	free(info->files);
+	free(info->lines);
+	info->files = NULL;
+	info->lines = NULL;
+}
@@ -0,0 +1,38 @@
+/******************************************************************************
+*  @file       	dbginfo.h
+*  @brief      	Address to source line map loaded from the ld65 debug file
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Reads the file written by "ld65 --dbgfile". Only the file, line,
+*		seg and span records are used. C lines (emitted by cc65 -g) win
+*		over the assembler lines that cover the same bytes
+******************************************************************************/
+
+#ifndef DBGINFO_H
+#define DBGINFO_H
+
+#include <stdint.h>
+
+typedef struct
+{
+	int file;
+	int line;
+	int isC;
+} SourceLine;
+
+typedef struct
+{
+	char **files;
+	int fileCount;
+	SourceLine *lines;
+	int lineCount;
+	// Index into lines for every CPU address, -1 when unknown
+	int32_t lineAt[0x10000];
+} DebugInfo;
+
+// Loads the debug file; returns 0 on success
+int dbg_load(DebugInfo *info, const char *path);
+void dbg_free(DebugInfo *info);
+
+#endif
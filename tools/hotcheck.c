@@ -0,0 +1,507 @@
+/******************************************************************************
+*  @file       	hotcheck.c
+*  @brief      	Build-time check that hot code calls no costly cc65 runtime helpers
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Reads the assembly cc65 writes for main.c (built with -g
+*		--add-source) and maps every call to a multiply, divide, modulo or
+*		shift runtime helper back to its C function and source line, with
+*		a rough cycle cost per call
+*		> Hot code is marked in the C sources: a "@hot" comment line before
+*		a function marks the whole function, "@hot begin" and "@hot end"
+*		comment lines mark the source lines between them (the game loop)
+*		> A helper call in hot code fails the check. Functions called from
+*		hot code are listed with their helpers too, and with -s fail the
+*		check the same way
+*
+*		Usage: hotcheck [-s] [main.s]
+*			-s	also fail on helpers in functions called from hot code
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define DEFAULT_ASM		"src/main.s"
+#define MAX_LINE		512
+#define MAX_NAME		64
+#define MAX_FUNCS		512
+#define MAX_SITES		1024
+#define MAX_CALLS		2048
+#define MAX_FILES		64
+#define MAX_REGIONS		32
+
+// Helper families, and the rough cycles of one call (including jsr/rts)
+enum
+{
+	H_MUL = 0,
+	H_DIV,
+	H_SHIFT,
+	H_VAR_SHIFT
+};
+
+static const char *kindNames[] = { "multiply", "divide", "shift", "variable shift" };
+
+typedef struct
+{
+	const char *prefix;
+	int kind;
+	int cycles;
+} HelperFamily;
+
+// Checked in order, so longer prefixes go first; constant shifts (name ending in the
+//	count) are costed per bit below
+static const HelperFamily families[] =
+{
+	{ "tosmuleax",	H_MUL,		1100 },
+	{ "tosumuleax",	H_MUL,		1100 },
+	{ "tosmul",		H_MUL,		420 },
+	{ "tosumul",	H_MUL,		400 },
+	{ "mulax",		H_MUL,		60 },
+	{ "umul8x8",	H_MUL,		180 },
+	{ "imul8x8",	H_MUL,		220 },
+	{ "umul",		H_MUL,		650 },
+	{ "imul",		H_MUL,		700 },
+	{ "tosdiveax",	H_DIV,		1600 },
+	{ "tosudiveax",	H_DIV,		1500 },
+	{ "tosmodeax",	H_DIV,		1600 },
+	{ "tosumodeax",	H_DIV,		1500 },
+	{ "tosdiv",		H_DIV,		720 },
+	{ "tosudiv",	H_DIV,		650 },
+	{ "tosmod",		H_DIV,		720 },
+	{ "tosumod",	H_DIV,		650 },
+	{ "udiv",		H_DIV,		650 },
+	{ "idiv",		H_DIV,		720 },
+	{ "tosasl",		H_VAR_SHIFT, 110 },
+	{ "tosasr",		H_VAR_SHIFT, 120 },
+	{ "tosshl",		H_VAR_SHIFT, 110 },
+	{ "tosshr",		H_VAR_SHIFT, 110 },
+	{ "asleax",		H_SHIFT,	0 },
+	{ "asreax",		H_SHIFT,	0 },
+	{ "shleax",		H_SHIFT,	0 },
+	{ "shreax",		H_SHIFT,	0 },
+	{ "aslax",		H_SHIFT,	0 },
+	{ "asrax",		H_SHIFT,	0 },
+	{ "shlax",		H_SHIFT,	0 },
+	{ "shrax",		H_SHIFT,	0 },
+};
+
+// A helper call
+typedef struct
+{
+	char helper[MAX_NAME];
+	int kind;
+	int cycles;
+	int func;
+	const char *file;
+	int line;
+	int hot;
+} Site;
+
+// A call to another C function
+typedef struct
+{
+	int caller;
+	char callee[MAX_NAME];
+	const char *file;
+	int line;
+	int hot;
+} Call;
+
+typedef struct
+{
+	char name[MAX_NAME];
+	int marked;		// "@hot" before the function
+	int reached;	// called from hot code
+	int via;		// caller it was first reached from
+	int sites;
+} Func;
+
+// Source lines between "@hot begin" and "@hot end"
+typedef struct
+{
+	const char *file;
+	int first;
+	int last;
+} Region;
+
+static Site sites[MAX_SITES];
+static Call calls[MAX_CALLS];
+static Func funcs[MAX_FUNCS];
+static Region regions[MAX_REGIONS];
+static char files[MAX_FILES][MAX_LINE];
+static int siteCount, callCount, funcCount, regionCount, fileCount;
+
+// Returns the helper family index of a runtime routine name, or -1
+static int helper_family(const char *name, int *cycles)
+{
+	size_t len = strlen(name), i;
+
+	for (i = 0; i < sizeof(families)/sizeof(families[0]); ++i)
+	{
+		if (strncmp(name, families[i].prefix, strlen(families[i].prefix)))	continue;
+
+		*cycles = families[i].cycles;
+		if (families[i].kind == H_SHIFT)
+		{
+			int bits = isdigit((unsigned char)name[len-1]) ? name[len-1] - '0' : 0;
+			int isLong = strstr(name, "eax") != NULL;
+
+			// Count in Y: a loop, like the tos shifts
+			if (!bits)
+			{
+				*cycles = isLong ? 200 : 110;
+				return H_VAR_SHIFT;
+			}
+			*cycles = isLong ? 20 + 13*bits : 17 + 7*bits;
+		}
+		return families[i].kind;
+	}
+	return -1;
+}
+
+// Returns the stored copy of file path (separators turned to '/'), adding it if new
+static const char *intern_file(const char *path)
+{
+	char name[MAX_LINE];
+	int i;
+
+	snprintf(name, sizeof(name), "%s", path);
+	for (i = 0; name[i]; ++i)	if (name[i] == '\\')	name[i] = '/';
+	for (i = 0; i < fileCount; ++i)	if (!strcmp(files[i], name))	return files[i];
+	if (fileCount == MAX_FILES)	return NULL;
+	strcpy(files[fileCount], name);
+	return files[fileCount++];
+}
+
+static int find_func(const char *name)
+{
+	int i;
+
+	for (i = 0; i < funcCount; ++i)	if (!strcmp(funcs[i].name, name))	return i;
+	return -1;
+}
+
+// Copies the word at s (identifier characters) to out; returns the character after it
+static const char *read_word(const char *s, char *out)
+{
+	int n = 0;
+
+	while ((isalnum((unsigned char)*s) || *s == '_') && n < MAX_NAME - 1)	out[n++] = *s++;
+	out[n] = 0;
+	return s;
+}
+
+static const char *skip_space(const char *s)
+{
+	while (*s == ' ' || *s == '\t')	++s;
+	return s;
+}
+
+// Reads the "@hot" markers of a C source file; returns -1 on an unmatched marker
+static int load_markers(const char *file)
+{
+	FILE *f = fopen(file, "r");
+	char line[MAX_LINE], name[MAX_NAME];
+	int lineNum = 0, pending = 0, begin = 0;
+
+	// Library headers and the like may not be around; they hold no markers
+	if (!f)	return 0;
+
+	while (fgets(line, sizeof(line), f))
+	{
+		const char *s = skip_space(line), *mark;
+
+		++lineNum;
+		if (s[0] == '/' && s[1] == '/')
+		{
+			mark = strstr(s, "@hot");
+			if (!mark)	continue;
+			mark = skip_space(mark + 4);
+			if (!strncmp(mark, "begin", 5))
+			{
+				if (begin)
+				{
+					fprintf(stderr, "%s:%d: @hot begin inside another\n", file, lineNum);
+					fclose(f);
+					return -1;
+				}
+				begin = lineNum;
+			}
+			else if (!strncmp(mark, "end", 3))
+			{
+				if (!begin || regionCount == MAX_REGIONS)
+				{
+					fprintf(stderr, "%s:%d: @hot end without @hot begin\n", file, lineNum);
+					fclose(f);
+					return -1;
+				}
+				regions[regionCount].file = file;
+				regions[regionCount].first = begin;
+				regions[regionCount].last = lineNum;
+				++regionCount;
+				begin = 0;
+			}
+			else
+			{
+				pending = lineNum;
+			}
+			continue;
+		}
+
+		// The first code line after "@hot" is the function definition
+		if (!pending || !*s || *s == '\n')	continue;
+		{
+			const char *paren = strchr(s, '(');
+			const char *start = paren ? paren : s;
+
+			while (start > s && (start[-1] == ' ' || start[-1] == '\t'))	--start;
+			while (start > s && (isalnum((unsigned char)start[-1]) || start[-1] == '_'))	--start;
+			read_word(start, name);
+			if (!paren || !name[0] || funcCount == MAX_FUNCS)
+			{
+				fprintf(stderr, "%s:%d: @hot is not followed by a function\n", file, pending);
+				fclose(f);
+				return -1;
+			}
+			if (find_func(name) < 0)
+			{
+				fprintf(stderr, "%s:%d: @hot function %s is not in the assembly\n", file, pending, name);
+				fclose(f);
+				return -1;
+			}
+			funcs[find_func(name)].marked = 1;
+			pending = 0;
+		}
+	}
+	fclose(f);
+	if (begin)
+	{
+		fprintf(stderr, "%s:%d: @hot begin without @hot end\n", file, begin);
+		return -1;
+	}
+	return 0;
+}
+
+static int in_region(const char *file, int line)
+{
+	int i;
+
+	for (i = 0; i < regionCount; ++i)
+	{
+		if (regions[i].file == file && line >= regions[i].first && line <= regions[i].last)	return 1;
+	}
+	return 0;
+}
+
+// Reads functions, helper calls and C calls with their source lines from the assembly
+static int load_asm(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[MAX_LINE], word[MAX_NAME], callee[MAX_NAME];
+	const char *file = NULL;
+	int func = -1, srcLine = 0;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), f))
+	{
+		const char *s = line;
+
+		if (*s == ';')	continue;
+		// Skip a label
+		if (*s != ' ' && *s != '\t' && *s != '.')
+		{
+			while (*s && *s != ':')	++s;
+			if (*s)	++s;
+		}
+		s = skip_space(s);
+
+		if (!strncmp(s, ".proc", 5))
+		{
+			s = skip_space(s + 5);
+			if (*s == '_')	++s;
+			read_word(s, word);
+			if (funcCount == MAX_FUNCS)
+			{
+				fprintf(stderr, "%s: too many functions\n", path);
+				fclose(f);
+				return -1;
+			}
+			func = funcCount++;
+			strcpy(funcs[func].name, word);
+			funcs[func].via = -1;
+			file = NULL;
+			srcLine = 0;
+		}
+		else if (!strncmp(s, ".endproc", 8))
+		{
+			func = -1;
+		}
+		else if (!strncmp(s, ".dbg", 4))
+		{
+			// .dbg line, "file", number
+			s = skip_space(s + 4);
+			if (strncmp(s, "line", 4))	continue;
+			s = strchr(s, '"');
+			if (!s)
+			{
+				file = NULL;
+				continue;
+			}
+			{
+				const char *end = strchr(s + 1, '"');
+				char name[MAX_LINE];
+
+				if (!end)	continue;
+				snprintf(name, sizeof(name), "%.*s", (int)(end - s - 1), s + 1);
+				file = intern_file(name);
+				s = strchr(end, ',');
+				srcLine = s ? atoi(s + 1) : 0;
+			}
+		}
+		else if (func >= 0 && (!strncmp(s, "jsr", 3) || !strncmp(s, "jmp", 3)))
+		{
+			int kind, cycles;
+
+			s = skip_space(s + 3);
+			read_word(s, callee);
+			if (callee[0] == '_')
+			{
+				if (callCount == MAX_CALLS)	continue;
+				calls[callCount].caller = func;
+				strcpy(calls[callCount].callee, callee + 1);
+				calls[callCount].file = file;
+				calls[callCount].line = srcLine;
+				++callCount;
+				continue;
+			}
+			kind = helper_family(callee, &cycles);
+			if (kind < 0 || siteCount == MAX_SITES)	continue;
+			strcpy(sites[siteCount].helper, callee);
+			sites[siteCount].kind = kind;
+			sites[siteCount].cycles = cycles;
+			sites[siteCount].func = func;
+			sites[siteCount].file = file;
+			sites[siteCount].line = srcLine;
+			++funcs[func].sites;
+			++siteCount;
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: hotcheck [-s] [main.s]\n"
+		"Lists the cc65 multiply, divide and shift helpers called from @hot code and fails when there are any\n"
+		"  main.s          assembly cc65 wrote with -g --add-source (default src/main.s)\n"
+		"  -s              also fail on helpers in functions called from hot code\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char *asmPath = DEFAULT_ASM;
+	int strict = 0, failed = 0, hotCycles = 0, reachedCycles = 0, changed, i, j;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-s"))		strict = 1;
+		else if (argv[i][0] == '-')		usage();
+		else							asmPath = argv[i];
+	}
+
+	if (load_asm(asmPath))	return 1;
+	for (i = 0; i < fileCount; ++i)
+	{
+		if (load_markers(files[i]))	return 1;
+	}
+	if (!regionCount)
+	{
+		for (i = 0; i < funcCount && !funcs[i].marked; ++i);
+		if (i == funcCount)
+		{
+			fprintf(stderr, "%s: no @hot markers in its sources (built without -g --add-source?)\n", asmPath);
+			return 1;
+		}
+	}
+
+	// Calls and helper sites in marked functions or lines are hot
+	for (i = 0; i < callCount; ++i)
+	{
+		Call *c = &calls[i];
+		c->hot = funcs[c->caller].marked || (c->file && in_region(c->file, c->line));
+	}
+	for (i = 0; i < siteCount; ++i)
+	{
+		Site *s = &sites[i];
+		s->hot = funcs[s->func].marked || (s->file && in_region(s->file, s->line));
+	}
+
+	// Everything called from hot code, or from what it calls, runs every frame too
+	do
+	{
+		changed = 0;
+		for (i = 0; i < callCount; ++i)
+		{
+			Call *c = &calls[i];
+			int callee = find_func(c->callee);
+
+			if (callee < 0 || funcs[callee].marked || funcs[callee].reached)	continue;
+			if (!c->hot && !funcs[c->caller].reached)	continue;
+			funcs[callee].reached = 1;
+			funcs[callee].via = c->caller;
+			changed = 1;
+		}
+	}
+	while (changed);
+
+	printf("cc65 runtime helpers by function (static call sites, ~cycles per call)\n\n");
+	for (i = 0; i < funcCount; ++i)
+	{
+		Func *fn = &funcs[i];
+		char where[MAX_LINE];
+
+		if (!fn->sites)	continue;
+		if (fn->marked)			printf("%s [hot]\n", fn->name);
+		else if (fn->reached)	printf("%s [called from hot code via %s]\n", fn->name, funcs[fn->via].name);
+		else					printf("%s\n", fn->name);
+
+		for (j = 0; j < siteCount; ++j)
+		{
+			Site *s = &sites[j];
+			int bad = s->hot || (strict && fn->reached);
+
+			if (s->func != i)	continue;
+			snprintf(where, sizeof(where), "%s:%d", s->file ? s->file : "?", s->line);
+			printf("    %-28s %-12s %-15s %5d", where, s->helper, kindNames[s->kind], s->cycles);
+			if (s->hot)	hotCycles += s->cycles;
+			else if (fn->reached)	reachedCycles += s->cycles;
+			if (bad)
+			{
+				printf("  IN HOT CODE");
+				++failed;
+			}
+			printf("\n");
+		}
+	}
+
+	printf("\n~%d cycles of helpers in hot code, ~%d in functions it calls (each site once)\n",
+		   hotCycles, reachedCycles);
+	if (failed)
+	{
+		printf("%d helper call%s in hot code: use shifts by a constant on bytes, tables or\n"
+			   "incremental updates instead\n", failed, failed == 1 ? "" : "s");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,732 @@
+/******************************************************************************
+*  @file       	levelpack.c
+*  @brief      	Converts NES Screen Tool level maps into the compact level format
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Reads the NameTable and AttrTable of each .nss file, turns every
+*		16x16 map tile into the metatile with the same characters and
+*		palette (tables read from metatiles.h) and writes one C array per
+*		level:
+*			byte 0-1	player start x,y (map tile coordinates, HUD rows included)
+*			byte 2		number of items
+*			byte 3		map width in map tiles (16 per screen)
+*			byte 4		number of enemies, then 3 bytes per enemy: x,y and
+*						speed digit
+*			then		MAP_HEIGHT rows of metatile IDs, 4 bits each, 2 per byte,
+*						first map tile in the low nibble
+*		> A level wider than one screen is several .nss files side by side,
+*		level_name.nss first, then level_name-2.nss, level_name-3.nss...
+*		(up to 4 screens, the game's map[] is 64 map tiles wide)
+*		> Start and enemy map tiles are markers, found by their upper left
+*		character (TILE_ defines of the game header given with -t), and
+*		are packed as MT_EMPTY. Enemy markers are the TILE_ENEMY character
+*		and the 9 after it (digits '0'-'9'), the digit is the enemy speed.
+*		The HUD rows and the palettes in the .nss are not used
+*		> When no metatile has the palette a map tile is drawn with, the
+*		first metatile with the same characters is used; that is reported
+*		unless the characters are all blank (character 0)
+*		> All levels go into one pack with a pointer table (levelTable) in
+*		level name order and LEVEL_COUNT, so gameLevel indexes it directly
+*		> levelPercentStep and levelPercentRem split 100 by the item count of
+*		each level (100 = step*items + rem, step in packed BCD), so the game
+*		keeps the collected percent without dividing
+*		> Level arrays are placed in the LEVELS0..LEVELS4 segments, filling
+*		one 16K PRG bank each; levelBank gives the segment of every level.
+*		The pointer and bank tables stay in RODATA (the fixed bank)
+*		> Every map tile is checked: map tiles that match no metatile, a
+*		missing or repeated start, more than MAX_ENEMIES enemies, no exit
+*		or no items fail the build
+*
+*		Usage: levelpack -o output.h -m metatiles.h [-t gamePhase.h] level.nss...
+******************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Map geometry, as in gamePhase.h
+#define SCREEN_WIDTH	16
+#define MAP_MAX_WIDTH	64
+#define MAP_HEIGHT		13
+#define HUD_HEIGHT		2
+#define NAME_WIDTH		32
+#define NAME_SIZE		960
+#define ATTR_SIZE		64
+
+#define MAX_LEVELS		255
+// Level segments (LEVELS0..) and the PRG bank size each one fills, as in unrom_128_vert.cfg
+#define LEVEL_BANKS		5
+#define BANK_SIZE		0x4000
+#define MAX_SCREENS		(MAP_MAX_WIDTH/SCREEN_WIDTH)
+// Metatile IDs are packed in 4 bits, the top one is the game's enemy occupancy bit
+#define MAX_METATILES	8
+
+// Enemies per level and speed digits, as ENEMY_MAX and TILE_ENEMY in gamePhase.h
+#define MAX_ENEMIES		8
+#define ENEMY_SPEEDS	10
+
+#define HEADER_SIZE		5
+#define ENEMY_SIZE		3
+#define MAX_LEVEL_SIZE	(HEADER_SIZE + ENEMY_SIZE*MAX_ENEMIES + MAP_MAX_WIDTH*MAP_HEIGHT/2)
+
+#define MAX_DEFINES		256
+
+// Position markers found in the .nss
+enum
+{
+	MARKER_START = 0,
+	MARKER_ENEMY,
+	MARKER_COUNT
+};
+
+// Marker code legend (upper left character), defaults as in gamePhase.h;
+//	a marker is any of the range characters from its code
+static struct
+{
+	const char *define;
+	int code;
+	int range;
+} markers[MARKER_COUNT] =
+{
+	{ "TILE_START",	0x33, 1 },
+	{ "TILE_ENEMY",	0x10, ENEMY_SPEEDS }
+};
+
+// Metatile tables and the defines they use, from metatiles.h
+static struct
+{
+	char name[64];
+	long value;
+} defines[MAX_DEFINES];
+static int defineCount;
+
+static unsigned char metatileChars[MAX_METATILES*4];
+static unsigned char metatilePalette[MAX_METATILES];
+static unsigned char metatileFlags[MAX_METATILES];
+static int metatileCount;
+static int mtEmpty, mtfPickup, mtfExit;
+
+typedef struct
+{
+	unsigned char x, y, speed;
+} Enemy;
+
+typedef struct
+{
+	unsigned char startX, startY;
+	Enemy enemies[MAX_ENEMIES];
+	int width;
+	int items, exits, markers[MARKER_COUNT];
+	unsigned char cells[MAP_MAX_WIDTH*MAP_HEIGHT];
+} Level;
+
+// A .nss file: one screen of a level
+typedef struct
+{
+	const char *path;
+	char level[64];
+	int screen;
+} Screen;
+
+// Expands an NES Screen Tool RLE text field ("00[48]d4[2]..." where [n] means the
+// previous byte appears n times in total); returns the number of bytes written
+static int expand_field(const char *text, unsigned char *out, int size)
+{
+	int n = 0;
+
+	while (*text && *text != '\n' && *text != '\r')
+	{
+		if (*text == '[')
+		{
+			int count = (int)strtol(text + 1, (char **)&text, 16);
+			if (*text != ']' || !n)	return -1;
+			++text;
+			while (--count > 0 && n < size)
+			{
+				out[n] = out[n - 1];
+				++n;
+			}
+		}
+		else
+		{
+			char hex[3] = { text[0], text[1], 0 };
+			if (!text[1] || n == size)	return -1;
+			out[n++] = (unsigned char)strtol(hex, NULL, 16);
+			text += 2;
+		}
+	}
+	return n;
+}
+
+// Reads the NameTable and AttrTable fields of a .nss file
+static int load_screen(const char *path, unsigned char *name, unsigned char *attr)
+{
+	FILE *f = fopen(path, "r");
+	static char line[16384];
+	int nameSize = -1, attrSize = -1;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		if (!strncmp(line, "NameTable=", 10))		nameSize = expand_field(line + 10, name, NAME_SIZE);
+		else if (!strncmp(line, "AttrTable=", 10))	attrSize = expand_field(line + 10, attr, ATTR_SIZE);
+	}
+	fclose(f);
+
+	if (nameSize != NAME_SIZE)
+	{
+		fprintf(stderr, "%s: no %d byte NameTable\n", path, NAME_SIZE);
+		return 1;
+	}
+	if (attrSize != ATTR_SIZE)
+	{
+		fprintf(stderr, "%s: no %d byte AttrTable\n", path, ATTR_SIZE);
+		return 1;
+	}
+	return 0;
+}
+
+// Reads the marker TILE_ defines of the game header; returns 0 on success
+static int load_marker_codes(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	int found = 0, i;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		char define[64];
+		int code;
+
+		if (sscanf(line, " #define %63s %i", define, &code) != 2)	continue;
+		for (i = 0; i < MARKER_COUNT; ++i)
+		{
+			if (!strcmp(define, markers[i].define))
+			{
+				markers[i].code = code & 0xff;
+				found |= 1 << i;
+			}
+		}
+	}
+	fclose(f);
+
+	for (i = 0; i < MARKER_COUNT; ++i)
+	{
+		if (!(found & (1 << i)))
+		{
+			fprintf(stderr, "%s: %s is not defined\n", path, markers[i].define);
+			return 1;
+		}
+	}
+	if ((unsigned)(markers[MARKER_START].code - markers[MARKER_ENEMY].code) < ENEMY_SPEEDS)
+	{
+		fprintf(stderr, "%s: TILE_START $%02x is one of the TILE_ENEMY codes\n", path, markers[MARKER_START].code);
+		return 1;
+	}
+	return 0;
+}
+
+// Value of a define from metatiles.h, -1 when it is missing
+static long define_value(const char *name)
+{
+	int i;
+	for (i = 0; i < defineCount; ++i)
+	{
+		if (!strcmp(defines[i].name, name))	return defines[i].value;
+	}
+	return -1;
+}
+
+// Name of a metatile ID for messages (its MT_ define)
+static const char *metatile_name(int id)
+{
+	int i;
+	for (i = 0; i < defineCount; ++i)
+	{
+		if (!strncmp(defines[i].name, "MT_", 3) && defines[i].value == id)	return defines[i].name;
+	}
+	return "?";
+}
+
+// Replaces comments with spaces so that only code is left
+static void strip_comments(char *text)
+{
+	while (*text)
+	{
+		if (text[0] == '/' && text[1] == '/')
+		{
+			while (*text && *text != '\n')	*text++ = ' ';
+		}
+		else if (text[0] == '/' && text[1] == '*')
+		{
+			while (*text && !(text[0] == '*' && text[1] == '/'))	*text++ = ' ';
+			if (*text)
+			{
+				text[0] = text[1] = ' ';
+				text += 2;
+			}
+		}
+		else
+		{
+			++text;
+		}
+	}
+}
+
+// Reads the elements of a const array initializer; elements are numbers and defines
+//	joined with |. Returns the number of elements, or -1 on error
+static int parse_array(const char *path, const char *text, const char *array, unsigned char *out, int size)
+{
+	const char *p = strstr(text, array);
+	int n = 0;
+
+	if (!p || !(p = strchr(p, '{')))
+	{
+		fprintf(stderr, "%s: no initializer for %s\n", path, array);
+		return -1;
+	}
+	++p;
+	while (1)
+	{
+		long value = 0;
+
+		while (isspace((unsigned char)*p))	++p;
+		if (*p == '}')	return n;
+		if (n == size)
+		{
+			fprintf(stderr, "%s: %s has more than %d elements\n", path, array, size);
+			return -1;
+		}
+
+		// Element: term { | term }
+		while (1)
+		{
+			char term[64];
+			int len = 0;
+
+			while (isspace((unsigned char)*p))	++p;
+			while ((isalnum((unsigned char)*p) || *p == '_') && len < 63)	term[len++] = *p++;
+			term[len] = 0;
+			if (!len)
+			{
+				fprintf(stderr, "%s: cannot parse %s\n", path, array);
+				return -1;
+			}
+			if (isdigit((unsigned char)term[0]))
+			{
+				value |= strtol(term, NULL, 0);
+			}
+			else if (define_value(term) >= 0)
+			{
+				value |= define_value(term);
+			}
+			else
+			{
+				fprintf(stderr, "%s: %s in %s is not defined\n", path, term, array);
+				return -1;
+			}
+
+			while (isspace((unsigned char)*p))	++p;
+			if (*p != '|')	break;
+			++p;
+		}
+		out[n++] = (unsigned char)value;
+
+		if (*p == ',')	++p;
+		else if (*p != '}')
+		{
+			fprintf(stderr, "%s: cannot parse %s\n", path, array);
+			return -1;
+		}
+	}
+}
+
+// Reads the metatile tables; returns 0 on success
+static int load_metatiles(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	char *text, *line;
+	long size;
+	unsigned char attr[MAX_METATILES];
+	int charCount, attrCount, flagCount, i;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	text = malloc(size + 1);
+	size = (long)fread(text, 1, size, f);
+	text[size] = 0;
+	fclose(f);
+	strip_comments(text);
+
+	// Numeric defines (IDs, flags, count)
+	for (line = text; line; line = strchr(line, '\n'), line = line ? line + 1 : NULL)
+	{
+		char name[64];
+		long value;
+
+		if (sscanf(line, " #define %63s %li", name, &value) != 2 || defineCount == MAX_DEFINES)	continue;
+		strcpy(defines[defineCount].name, name);
+		defines[defineCount].value = value;
+		++defineCount;
+	}
+
+	charCount = parse_array(path, text, "metatileChars", metatileChars, MAX_METATILES*4);
+	attrCount = parse_array(path, text, "metatileAttr", attr, MAX_METATILES);
+	flagCount = parse_array(path, text, "metatileFlags", metatileFlags, MAX_METATILES);
+	free(text);
+	if (charCount < 0 || attrCount < 0 || flagCount < 0)	return 1;
+
+	metatileCount = attrCount;
+	if (charCount != metatileCount*4 || flagCount != metatileCount || !metatileCount)
+	{
+		fprintf(stderr, "%s: metatileChars, metatileAttr and metatileFlags disagree on the metatile count\n", path);
+		return 1;
+	}
+	for (i = 0; i < metatileCount; ++i)
+	{
+		metatilePalette[i] = attr[i] & 3;
+	}
+
+	mtEmpty = (int)define_value("MT_EMPTY");
+	mtfPickup = (int)define_value("MTF_PICKUP");
+	mtfExit = (int)define_value("MTF_EXIT");
+	if (mtEmpty < 0 || mtEmpty >= metatileCount || mtfPickup < 0 || mtfExit < 0)
+	{
+		fprintf(stderr, "%s: MT_EMPTY, MTF_PICKUP or MTF_EXIT is missing\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+// Turns every map tile of a screen into a metatile ID, screens are numbered from 0;
+//	returns the number of errors
+static int parse_screen(const char *path, const unsigned char *name, const unsigned char *attr,
+						int screen, Level *level)
+{
+	int x, y, k, id, errors = 0;
+
+	for (y = HUD_HEIGHT; y < HUD_HEIGHT + MAP_HEIGHT; ++y)
+	{
+		for (x = 0; x < SCREEN_WIDTH; ++x)
+		{
+			const unsigned char *tile = &name[(y << 1)*NAME_WIDTH + (x << 1)];
+			int mapX = screen*SCREEN_WIDTH + x;
+			unsigned char *cell = &level->cells[(y - HUD_HEIGHT)*MAP_MAX_WIDTH + mapX];
+			const unsigned char chars[4] = { tile[0], tile[1], tile[NAME_WIDTH], tile[NAME_WIDTH + 1] };
+			int palette = (attr[((y >> 1) << 3) | (x >> 1)] >> (((y & 1) << 2) | ((x & 1) << 1))) & 3;
+
+			// Position markers
+			for (k = 0; k < MARKER_COUNT && (unsigned)(tile[0] - markers[k].code) >= (unsigned)markers[k].range; ++k);
+			if (k < MARKER_COUNT)
+			{
+				if (memcmp(chars + 1, metatileChars + mtEmpty*4 + 1, 3))
+				{
+					fprintf(stderr, "%s: warning: %s at map tile %d,%d is drawn as %s in the game\n",
+							path, markers[k].define, x, y, metatile_name(mtEmpty));
+				}
+				*cell = (unsigned char)mtEmpty;
+				if (k == MARKER_START)
+				{
+					level->startX = mapX;
+					level->startY = y;
+				}
+				else if (level->markers[k] < MAX_ENEMIES)
+				{
+					Enemy *enemy = &level->enemies[level->markers[k]];
+					enemy->x = mapX;
+					enemy->y = y;
+					enemy->speed = tile[0] - markers[k].code;
+				}
+				++level->markers[k];
+				continue;
+			}
+
+			// Same characters and palette, or else the first with the same characters
+			for (id = 0; id < metatileCount; ++id)
+			{
+				if (!memcmp(chars, metatileChars + id*4, 4) && metatilePalette[id] == palette)	break;
+			}
+			if (id == metatileCount)
+			{
+				for (id = 0; id < metatileCount && memcmp(chars, metatileChars + id*4, 4); ++id);
+				if (id == metatileCount)
+				{
+					fprintf(stderr, "%s: map tile %d,%d (%02x %02x %02x %02x) matches no metatile\n",
+							path, x, y, chars[0], chars[1], chars[2], chars[3]);
+					++errors;
+					continue;
+				}
+				if (chars[0] | chars[1] | chars[2] | chars[3])
+				{
+					fprintf(stderr, "%s: warning: %s at map tile %d,%d uses palette %d, no metatile has it\n",
+							path, metatile_name(id), x, y, palette);
+				}
+			}
+
+			*cell = (unsigned char)id;
+			if (metatileFlags[id] & mtfExit)	++level->exits;
+			if (metatileFlags[id] & mtfPickup)	++level->items;
+		}
+	}
+	return errors;
+}
+
+// Checks a level once all its screens are parsed; returns the number of errors
+static int check_level(const char *name, const Level *level)
+{
+	int errors = 0;
+
+	if (level->markers[MARKER_START] != 1)
+	{
+		fprintf(stderr, "%s: %d TILE_START tiles, need exactly 1\n", name, level->markers[MARKER_START]);
+		++errors;
+	}
+	if (level->markers[MARKER_ENEMY] > MAX_ENEMIES)
+	{
+		fprintf(stderr, "%s: %d TILE_ENEMY tiles, at most %d are supported\n", name, level->markers[MARKER_ENEMY], MAX_ENEMIES);
+		++errors;
+	}
+	if (!level->exits)
+	{
+		fprintf(stderr, "%s: no MTF_EXIT map tile\n", name);
+		++errors;
+	}
+	// The clear percentage divides by the item count
+	if (!level->items || level->items > 255)
+	{
+		fprintf(stderr, "%s: %d MTF_PICKUP map tiles, need 1 to 255\n", name, level->items);
+		++errors;
+	}
+	return errors;
+}
+
+// Level (array) name and screen number from the file name:
+//	graphics/level_test.nss -> level_test, 1 and graphics/level_test-2.nss -> level_test, 2
+static void screen_name(Screen *screen)
+{
+	const char *base = strrchr(screen->path, '/');
+	char *dash;
+	size_t n = 0;
+
+	base = base ? base + 1 : screen->path;
+	while (base[n] && base[n] != '.' && n + 1 < sizeof(screen->level))
+	{
+		screen->level[n] = base[n];
+		++n;
+	}
+	screen->level[n] = 0;
+
+	screen->screen = 1;
+	dash = strrchr(screen->level, '-');
+	if (dash && dash[1] && strspn(dash + 1, "0123456789") == strlen(dash + 1))
+	{
+		screen->screen = atoi(dash + 1);
+		*dash = 0;
+	}
+}
+
+// Packed size of a level
+static int level_size(const Level *level)
+{
+	return HEADER_SIZE + ENEMY_SIZE*level->markers[MARKER_ENEMY] + MAP_HEIGHT*level->width/2;
+}
+
+// Writes a level array; returns its size
+static int write_level(FILE *out, const char *name, const Level *level)
+{
+	unsigned char data[MAX_LEVEL_SIZE];
+	int size = HEADER_SIZE, x, y, i;
+
+	data[0] = level->startX;
+	data[1] = level->startY;
+	data[2] = (unsigned char)level->items;
+	data[3] = (unsigned char)level->width;
+	data[4] = (unsigned char)level->markers[MARKER_ENEMY];
+	for (i = 0; i < level->markers[MARKER_ENEMY]; ++i)
+	{
+		data[size++] = level->enemies[i].x;
+		data[size++] = level->enemies[i].y;
+		data[size++] = level->enemies[i].speed;
+	}
+	for (y = 0; y < MAP_HEIGHT; ++y)
+	{
+		const unsigned char *row = &level->cells[y*MAP_MAX_WIDTH];
+		for (x = 0; x < level->width; x += 2)
+		{
+			data[size++] = row[x] | row[x + 1] << 4;
+		}
+	}
+
+	fprintf(out, "const unsigned char %s[%d]={\n", name, size);
+	for (i = 0; i < size; ++i)
+	{
+		fprintf(out, "0x%02x%s", data[i], i == size - 1 ? "\n" : (i & 15) == 15 ? ",\n" : ",");
+	}
+	fprintf(out, "};\n\n");
+	return size;
+}
+
+static int compare_screens(const void *a, const void *b)
+{
+	const Screen *sa = a, *sb = b;
+	int order = strcmp(sa->level, sb->level);
+	return order ? order : sa->screen - sb->screen;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: levelpack -o output.h -m metatiles.h [-t gamePhase.h] level.nss...\n"
+		"Packs NES Screen Tool maps into the level pack; a wider level is level_name.nss, level_name-2.nss...\n"
+		"  -o output.h     level pack header to write\n"
+		"  -m metatiles.h  metatile characters and palettes\n"
+		"  -t gamePhase.h  TILE_ marker characters of the start and enemies\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char *outPath = NULL, *codePath = NULL, *metatilePath = NULL;
+	Screen *screens = malloc(sizeof(Screen)*argc);
+	static unsigned char name[NAME_SIZE], attr[ATTR_SIZE];
+	static Level level;
+	static char arrayNames[MAX_LEVELS][64];
+	static unsigned char levelBank[MAX_LEVELS];
+	static int levelItems[MAX_LEVELS];
+	FILE *out;
+	int screenCount = 0, levelCount = 0, bytes = 0, errors = 0, i, first;
+	int bank = 0, bankUsed = 0, size;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-o") && i + 1 < argc)			outPath = argv[++i];
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)	codePath = argv[++i];
+		else if (!strcmp(argv[i], "-m") && i + 1 < argc)	metatilePath = argv[++i];
+		else if (argv[i][0] == '-')							usage();
+		else												screens[screenCount++].path = argv[i];
+	}
+	if (!outPath || !metatilePath || !screenCount)	usage();
+	if (codePath && load_marker_codes(codePath))	return 1;
+	if (load_metatiles(metatilePath))	return 1;
+
+	// Level order is level name order, whatever order the shell globbed them in,
+	//	and the screens of a level follow each other
+	for (i = 0; i < screenCount; ++i)	screen_name(&screens[i]);
+	qsort(screens, screenCount, sizeof(Screen), compare_screens);
+
+	out = fopen(outPath, "w");
+	if (!out)
+	{
+		fprintf(stderr, "%s: cannot create\n", outPath);
+		return 1;
+	}
+	fprintf(out, "// Generated by tools/levelpack.c, do not edit\n\n");
+	fprintf(out, "#pragma rodata-name (push,\"LEVELS0\")\n\n");
+
+	for (first = 0; first < screenCount; first = i)
+	{
+		if (levelCount == MAX_LEVELS)
+		{
+			fprintf(stderr, "more than %d levels, they do not fit in gameLevel\n", MAX_LEVELS);
+			++errors;
+			break;
+		}
+
+		memset(&level, 0, sizeof(level));
+		for (i = first; i < screenCount && !strcmp(screens[i].level, screens[first].level); ++i)
+		{
+			if (screens[i].screen != i - first + 1 || i - first == MAX_SCREENS)
+			{
+				fprintf(stderr, "%s: screen %d of %s, screens go from 1 to at most %d without gaps\n",
+						screens[i].path, screens[i].screen, screens[i].level, MAX_SCREENS);
+				++errors;
+				continue;
+			}
+			if (load_screen(screens[i].path, name, attr) ||
+				parse_screen(screens[i].path, name, attr, i - first, &level))
+			{
+				++errors;
+			}
+		}
+		level.width = (i - first)*SCREEN_WIDTH;
+		if (level.width > MAP_MAX_WIDTH)	level.width = MAP_MAX_WIDTH;
+		errors += check_level(screens[first].level, &level);
+
+		// Next segment when the level does not fit in the rest of this bank
+		if (bankUsed + level_size(&level) > BANK_SIZE)
+		{
+			if (++bank == LEVEL_BANKS)
+			{
+				fprintf(stderr, "%s: levels do not fit in %d banks\n", screens[first].path, LEVEL_BANKS);
+				++errors;
+				break;
+			}
+			bankUsed = 0;
+			fprintf(out, "#pragma rodata-name (pop)\n");
+			fprintf(out, "#pragma rodata-name (push,\"LEVELS%d\")\n\n", bank);
+		}
+
+		strcpy(arrayNames[levelCount], screens[first].level);
+		levelBank[levelCount] = (unsigned char)bank;
+		levelItems[levelCount] = level.items;
+		size = write_level(out, arrayNames[levelCount], &level);
+		bankUsed += size;
+		bytes += size + 6;	// Plus its levelTable, levelBank and percent table entries
+		++levelCount;
+	}
+	fprintf(out, "#pragma rodata-name (pop)\n\n");
+
+	// Level pointer and bank tables, indexed by gameLevel
+	fprintf(out, "#define LEVEL_COUNT %d\n\n", levelCount);
+	fprintf(out, "const unsigned char* const levelTable[LEVEL_COUNT]={\n");
+	for (i = 0; i < levelCount; ++i)
+	{
+		fprintf(out, "%s%s\n", arrayNames[i], i == levelCount - 1 ? "" : ",");
+	}
+	fprintf(out, "};\n\n");
+	fprintf(out, "const unsigned char levelBank[LEVEL_COUNT]={\n");
+	for (i = 0; i < levelCount; ++i)
+	{
+		fprintf(out, "%d%s", levelBank[i], i == levelCount - 1 ? "\n" : (i & 15) == 15 ? ",\n" : ",");
+	}
+	fprintf(out, "};\n\n");
+
+	// Percent per item, as a packed BCD step and the remainder in item units
+	fprintf(out, "const unsigned int levelPercentStep[LEVEL_COUNT]={\n");
+	for (i = 0; i < levelCount; ++i)
+	{
+		size = levelItems[i] ? 100/levelItems[i] : 0;
+		fprintf(out, "0x%04x%s", (size/100 << 8) | (size/10%10 << 4) | size%10,
+				i == levelCount - 1 ? "\n" : (i & 7) == 7 ? ",\n" : ",");
+	}
+	fprintf(out, "};\n\n");
+	fprintf(out, "const unsigned char levelPercentRem[LEVEL_COUNT]={\n");
+	for (i = 0; i < levelCount; ++i)
+	{
+		fprintf(out, "%d%s", levelItems[i] ? 100%levelItems[i] : 0, i == levelCount - 1 ? "\n" : (i & 15) == 15 ? ",\n" : ",");
+	}
+	fprintf(out, "};\n");
+
+	fclose(out);
+	free(screens);
+	if (errors)	remove(outPath);
+	if (!errors)	printf("%s: %d levels, %d bytes in %d of %d level banks\n", outPath, levelCount, bytes, bank + 1, LEVEL_BANKS);
+	return errors != 0;
+}
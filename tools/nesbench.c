@@ -0,0 +1,398 @@
+/******************************************************************************
+*  @file       	nesbench.c
+*  @brief      	Headless benchmark harness for NESMaze.nes
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Boots the ROM in the headless machine, feeds pad input from a
+*		script and reports CPU cycles per frame, lag frames and peak
+*		cycles for every game phase
+*		> A frame runs from one vblank start to the next. Cycles spent in
+*		the neslib wait loops (ppu_wait_frame, ppu_wait_nmi, split) are
+*		idle time; everything else, NMI included, is counted as busy
+*		> A frame is a lag frame when rendering was on and the main loop
+*		never reached a wait loop before the next vblank
+*		> PPU accesses that land outside vblank while rendering is on are
+*		reported with the routine that made them. A ROM assembled with
+*		NMI_PROFILE also reports the cycles of each NMI stage and the
+*		frames whose NMI was still touching the PPU after vblank ended
+*
+*		Usage: nesbench [options] [rom]
+*			-i script	pad input script (see tools/bench/session.txt)
+*			-p padlog	replay a pad log recorded by the game instead (needs -l)
+*			-w padlog	record the buttons of every pad poll into a pad log (needs -l)
+*			-L level	level the first cleared level goes on to (needs -l)
+*			-n frames	number of frames to run (default 3600)
+*			-l labels	ld65 label file, enables the per-phase breakdown
+*			-c csv		write one line per frame to this file
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "session.h"
+
+#define DEFAULT_ROM		"NESMaze.nes"
+#define DEFAULT_FRAMES	3600
+
+// Longest busy-wait loop body that is recognised as idle, in bytes
+#define IDLE_LOOP_MAX	8
+
+// NMI stage probes written by neslib.s when assembled with NMI_PROFILE
+#define NMI_PROBE_BASE	0x4018
+#define NMI_STAGES		7
+#define NMI_PROBE_PPU	4
+// Each probe is a 4 cycle absolute store, not charged to the stage it ends
+#define NMI_PROBE_COST	4
+
+static const char *nmiStageNames[NMI_STAGES] =
+{
+	"entry", "oam", "palette", "vram", "scroll", "split", "sound"
+};
+
+typedef struct
+{
+	unsigned frames;
+	unsigned lagFrames;
+	unsigned blankFrames;
+	uint64_t busyTotal;
+	uint64_t nmiTotal;
+	unsigned peakBusy;
+	uint64_t peakFrame;
+
+	// NMI stages, only filled by an NMI_PROFILE build
+	uint64_t stageTotal[NMI_STAGES];
+	unsigned stageMax[NMI_STAGES];
+	unsigned stageCount[NMI_STAGES];
+	uint64_t ppuDoneTotal;
+	unsigned ppuDoneMax;
+	unsigned ppuDoneCount;
+	unsigned overruns;
+
+	// PPU accesses outside vblank
+	unsigned lateWrites;
+	unsigned lateFrames;
+	uint64_t firstLateFrame;
+	uint16_t firstLatePc;
+	uint16_t firstLateAdr;
+} PhaseStats;
+
+static Session session;
+static PhaseStats stats[PHASE_COUNT];
+
+// State of the instruction being executed, for the I/O hook
+static int curPhase;
+static uint16_t curPc;
+static int curInNmi;
+static uint64_t nmiStart;
+static uint64_t lastProbe;
+static int probeCount;
+static int lateThisFrame;
+
+// Addresses that belong to a recognised busy-wait loop
+static uint8_t idleMap[0x10000/8];
+
+static int is_idle(uint16_t adr)
+{
+	return idleMap[adr >> 3] & (1 << (adr & 7));
+}
+
+// A short backward branch whose loop body only loads, compares and tests is a busy-wait on
+// some flag (FRAME_CNT1, FRAME_CNT2, PPU_STATUS); mark the whole loop as idle
+static void detect_idle_loop(NesMachine *nes, uint16_t pc, uint8_t op)
+{
+	uint16_t target, adr;
+
+	if ((op & 0x1f) != 0x10 || nes->pc >= pc || pc - nes->pc > IDLE_LOOP_MAX)	return;
+	target = nes->pc;
+
+	for (adr = target; adr < pc; )
+	{
+		switch (nes_peek(nes, adr))
+		{
+		case 0xa5: case 0xc5: case 0xc9: case 0x24: case 0xa6: case 0xa4: case 0xe4: case 0xc4:
+			adr += 2;	break;
+		case 0xad: case 0xcd: case 0x2c:
+			adr += 3;	break;
+		default:
+			return;
+		}
+	}
+	for (adr = target; adr < pc + 2; ++adr)	idleMap[adr >> 3] |= 1 << (adr & 7);
+}
+
+// Timestamps NMI stage probes and catches PPU accesses made while the PPU is rendering
+static void io_hook(NesMachine *nes, uint16_t adr, uint8_t value)
+{
+	PhaseStats *s = &stats[curPhase];
+	uint16_t reg = adr < 0x4000 ? (adr & 0x2007) : adr;
+	int late;
+
+	(void)value;
+
+	if (curInNmi && adr >= NMI_PROBE_BASE && adr < NMI_PROBE_BASE + NMI_STAGES)
+	{
+		int stage = adr - NMI_PROBE_BASE;
+		unsigned cycles = (unsigned)(nes->cycles - lastProbe) - (probeCount ? NMI_PROBE_COST : 0);
+
+		s->stageTotal[stage] += cycles;
+		++s->stageCount[stage];
+		if (cycles > s->stageMax[stage])	s->stageMax[stage] = cycles;
+		lastProbe = nes->cycles;
+		++probeCount;
+
+		if (stage == NMI_PROBE_PPU && (nes->ppuMask & 0x18))
+		{
+			int done = nes_vblank_cycle(nes);
+			if (done < 0)
+			{
+				// Rendering already started again
+				++s->overruns;
+				done = (int)(nes->cycles - nmiStart);
+			}
+			s->ppuDoneTotal += done;
+			++s->ppuDoneCount;
+			if ((unsigned)done > s->ppuDoneMax)	s->ppuDoneMax = done;
+		}
+		return;
+	}
+
+	// OAM and VRAM address/data accesses corrupt the picture while rendering. Scroll writes
+	// are allowed outside the NMI, that is how split() works, and after the sprite 0 hit
+	// inside it (split_x)
+	late = reg == 0x2003 || reg == 0x2004 || reg == 0x2006 || reg == 0x2007 || reg == 0x4014 ||
+		   (reg == 0x2005 && curInNmi && !(nes->ppuStatus & 0x40));
+	if (late && (nes->ppuMask & 0x18) && !nes_in_vblank(nes))
+	{
+		if (!s->lateWrites)
+		{
+			s->firstLateFrame = nes->frame;
+			s->firstLatePc = curPc;
+			s->firstLateAdr = reg;
+		}
+		++s->lateWrites;
+		if (!lateThisFrame)	++s->lateFrames;
+		lateThisFrame = 1;
+	}
+}
+
+static void report_nmi(void)
+{
+	int i, j;
+
+	for (i = 0; i < PHASE_COUNT && !stats[i].stageCount[0]; ++i);
+	if (i == PHASE_COUNT)	return;
+
+	printf("\nNMI stages, avg/max cycles (ppu done: cycles into vblank at the last PPU write)\n");
+	printf("%-12s", "phase");
+	for (j = 0; j < NMI_STAGES; ++j)	printf(" %11s", nmiStageNames[j]);
+	printf(" %11s %8s\n", "ppu done", "overrun");
+
+	for (i = 0; i < PHASE_COUNT; ++i)
+	{
+		PhaseStats *s = &stats[i];
+		char cell[32];
+
+		if (!s->stageCount[0])	continue;
+		printf("%-12s", phaseNames[i]);
+		for (j = 0; j < NMI_STAGES; ++j)
+		{
+			if (s->stageCount[j])
+			{
+				snprintf(cell, sizeof(cell), "%llu/%u",
+						 (unsigned long long)(s->stageTotal[j]/s->stageCount[j]), s->stageMax[j]);
+			}
+			else
+			{
+				snprintf(cell, sizeof(cell), "-");
+			}
+			printf(" %11s", cell);
+		}
+		if (s->ppuDoneCount)
+		{
+			snprintf(cell, sizeof(cell), "%llu/%u",
+					 (unsigned long long)(s->ppuDoneTotal/s->ppuDoneCount), s->ppuDoneMax);
+		}
+		else
+		{
+			snprintf(cell, sizeof(cell), "-");
+		}
+		printf(" %11s %8u\n", cell, s->overruns);
+	}
+}
+
+static void report_late_writes(void)
+{
+	int i;
+
+	printf("\nPPU accesses outside vblank while rendering\n");
+	printf("%-12s %7s %7s %8s  %s\n", "phase", "writes", "frames", "@frame", "first at");
+	for (i = 0; i < PHASE_COUNT; ++i)
+	{
+		PhaseStats *s = &stats[i];
+		const Symbol *sym;
+
+		if (!s->frames)	continue;
+		if (!s->lateWrites)
+		{
+			printf("%-12s %7u %7u\n", phaseNames[i], 0, 0);
+			continue;
+		}
+		sym = sym_function_at(&session.labels, s->firstLatePc);
+		printf("%-12s %7u %7u %8llu  $%04X in %s, write to $%04X\n", phaseNames[i], s->lateWrites,
+			   s->lateFrames, (unsigned long long)s->firstLateFrame, s->firstLatePc,
+			   sym ? sym->name : "?", s->firstLateAdr);
+	}
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: nesbench [-i script | -p padlog] [-w padlog] [-L level] [-n frames] [-l labels] [-c csv] [rom]\n"
+		"Plays a session on the ROM and reports cycles, lag frames and PPU accesses outside vblank per phase\n"
+		"  -i script       pad input script (see tools/bench/session.txt)\n"
+		"  -p padlog       replay a pad log recorded by the game instead (needs -l)\n"
+		"  -w padlog       record the buttons of every pad poll into a pad log (needs -l)\n"
+		"  -L level        level the first cleared level goes on to, such as the first generated one (needs -l)\n"
+		"  -n frames       number of frames to run (default 3600)\n"
+		"  -l labels       ld65 label file, enables the per-phase breakdown\n"
+		"  -c csv          write one line per frame to this file\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	NesMachine *nes = &session.nes;
+	const char *romPath = DEFAULT_ROM, *scriptPath = NULL, *labelPath = NULL,
+			   *padLogPath = NULL, *padOutPath = NULL, *csvPath = NULL;
+	unsigned long maxFrames = DEFAULT_FRAMES;
+	FILE *csv = NULL;
+	uint64_t frame;
+	unsigned busy = 0, nmi = 0, idle = 0;
+	int sawIdle = 0, nextLevel = -1, i;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-i") && i + 1 < argc)			scriptPath = argv[++i];
+		else if (!strcmp(argv[i], "-p") && i + 1 < argc)	padLogPath = argv[++i];
+		else if (!strcmp(argv[i], "-w") && i + 1 < argc)	padOutPath = argv[++i];
+		else if (!strcmp(argv[i], "-L") && i + 1 < argc)	nextLevel = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)	maxFrames = strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "-l") && i + 1 < argc)	labelPath = argv[++i];
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc)	csvPath = argv[++i];
+		else if (argv[i][0] == '-')							usage();
+		else												romPath = argv[i];
+	}
+
+	if (session_open(&session, romPath, scriptPath, labelPath))	return 1;
+	if (padLogPath && session_replay_pads(&session, padLogPath))	return 1;
+	if (padOutPath && session_record_pads(&session))				return 1;
+	if (nextLevel >= 0 && session_next_level(&session, nextLevel))	return 1;
+
+	if (csvPath)
+	{
+		csv = fopen(csvPath, "w");
+		if (!csv)
+		{
+			fprintf(stderr, "%s: cannot create\n", csvPath);
+			return 1;
+		}
+		fprintf(csv, "frame,phase,busy,nmi,idle,lag,rendering\n");
+	}
+
+	nes->ioHook = io_hook;
+	frame = nes->frame;
+
+	while (nes->frame < maxFrames)
+	{
+		uint16_t pc = nes->pc;
+		uint8_t op = nes_peek(nes, pc);
+		int inNmi = nes->nmiDepth > 0 || nes->nmiPending;
+		int phase = session.phase;
+		int newFrame;
+		unsigned cycles;
+
+		if (nes->nmiPending)
+		{
+			nmiStart = lastProbe = nes->cycles;
+			probeCount = 0;
+		}
+		curPhase = phase;
+		curPc = pc;
+		curInNmi = inNmi;
+
+		cycles = session_step(&session, &newFrame);
+		if (!cycles)	return 1;
+
+		if (inNmi)
+		{
+			nmi += cycles;
+		}
+		else
+		{
+			detect_idle_loop(nes, pc, op);
+			if (is_idle(pc))
+			{
+				idle += cycles;
+				sawIdle = 1;
+			}
+			else
+			{
+				busy += cycles;
+			}
+		}
+
+		// Vblank started: close the frame record
+		if (newFrame)
+		{
+			PhaseStats *s = &stats[phase];
+			int rendering = (nes->ppuMask & 0x18) != 0;
+			int lag = rendering && !sawIdle;
+
+			++s->frames;
+			if (!rendering)	++s->blankFrames;
+			if (lag)		++s->lagFrames;
+			s->busyTotal += busy + nmi;
+			s->nmiTotal += nmi;
+			if (busy + nmi > s->peakBusy)
+			{
+				s->peakBusy = busy + nmi;
+				s->peakFrame = frame;
+			}
+			if (csv)
+			{
+				fprintf(csv, "%llu,%s,%u,%u,%u,%d,%d\n", (unsigned long long)frame,
+						phaseNames[phase], busy + nmi, nmi, idle, lag, rendering);
+			}
+
+			busy = nmi = idle = 0;
+			sawIdle = 0;
+			lateThisFrame = 0;
+			frame = nes->frame;
+		}
+	}
+
+	printf("%s: %lu frames, %u cycles per frame, %u in vblank\n\n",
+		   romPath, maxFrames, NES_CYCLES_PER_FRAME, NES_CYCLES_PER_VBLANK);
+	printf("%-12s %7s %6s %6s %10s %10s %8s %9s\n",
+		   "phase", "frames", "lag", "blank", "avg cyc", "peak cyc", "@frame", "avg nmi");
+	for (i = 0; i < PHASE_COUNT; ++i)
+	{
+		PhaseStats *s = &stats[i];
+		if (!s->frames)	continue;
+		printf("%-12s %7u %6u %6u %10llu %10u %8llu %9llu\n", phaseNames[i], s->frames,
+			   s->lagFrames, s->blankFrames,
+			   (unsigned long long)(s->busyTotal/s->frames), s->peakBusy,
+			   (unsigned long long)s->peakFrame,
+			   (unsigned long long)(s->nmiTotal/s->frames));
+	}
+
+	report_nmi();
+	report_late_writes();
+
+	if (csv)	fclose(csv);
+	if (padOutPath && session_save_pads(&session, padOutPath))	return 1;
+	session_close(&session);
+	return 0;
+}
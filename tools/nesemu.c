@@ -0,0 +1,737 @@
+/******************************************************************************
+*  @file       	nesemu.c
+*  @brief      	Headless NES machine used by the host-side tools
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Only official 6502 opcodes are implemented, which is all that
+*		cc65, neslib and FamiTone2 ever emit
+*		> No pixels are rendered; the PPU only keeps VRAM, OAM, palette
+*		and the vblank/sprite 0 flags
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nesemu.h"
+
+#define VBLANK_DOT		(NES_VBLANK_LINE*NES_DOTS_PER_LINE + 1)
+#define PRERENDER_DOT	(NES_PRERENDER_LINE*NES_DOTS_PER_LINE + 1)
+#define NO_SPRITE0		0xffffffffu
+
+// Base cycle count of every opcode, 0 marks unimplemented opcodes
+static const uint8_t opCycles[256] =
+{
+//	0 1 2 3 4 5 6 7 8 9 A B C D E F
+	7,6,0,0,0,3,5,0,3,2,2,0,0,4,6,0,	// 0
+	2,5,0,0,0,4,6,0,2,4,0,0,0,4,7,0,	// 1
+	6,6,0,0,3,3,5,0,4,2,2,0,4,4,6,0,	// 2
+	2,5,0,0,0,4,6,0,2,4,0,0,0,4,7,0,	// 3
+	6,6,0,0,0,3,5,0,3,2,2,0,3,4,6,0,	// 4
+	2,5,0,0,0,4,6,0,2,4,0,0,0,4,7,0,	// 5
+	6,6,0,0,0,3,5,0,4,2,2,0,5,4,6,0,	// 6
+	2,5,0,0,0,4,6,0,2,4,0,0,0,4,7,0,	// 7
+	0,6,0,0,3,3,3,0,2,0,2,0,4,4,4,0,	// 8
+	2,6,0,0,4,4,4,0,2,5,2,0,0,5,0,0,	// 9
+	2,6,2,0,3,3,3,0,2,2,2,0,4,4,4,0,	// A
+	2,5,0,0,4,4,4,0,2,4,2,0,4,4,4,0,	// B
+	2,6,0,0,3,3,5,0,2,2,2,0,4,4,6,0,	// C
+	2,5,0,0,0,4,6,0,2,4,0,0,0,4,7,0,	// D
+	2,6,0,0,3,3,5,0,2,2,2,0,4,4,6,0,	// E
+	2,5,0,0,0,4,6,0,2,4,0,0,0,4,7,0		// F
+};
+
+/*
+ * PPU
+ */
+
+static uint16_t ppu_name_index(NesMachine *nes, uint16_t adr)
+{
+	adr &= 0x0fff;
+	if (nes->mirroring)	return adr & 0x07ff;
+	return ((adr & 0x0800) >> 1) | (adr & 0x03ff);
+}
+
+static uint8_t ppu_vram_read(NesMachine *nes, uint16_t adr)
+{
+	adr &= 0x3fff;
+	if (adr < 0x2000)	return nes->chr[adr];
+	if (adr < 0x3f00)	return nes->nameRam[ppu_name_index(nes, adr)];
+	adr &= 0x1f;
+	if (!(adr & 3))		adr &= 0x0f;
+	return nes->palette[adr];
+}
+
+static void ppu_vram_write(NesMachine *nes, uint16_t adr, uint8_t value)
+{
+	adr &= 0x3fff;
+	if (adr < 0x2000)
+	{
+		if (nes->chrIsRam)	nes->chr[adr] = value;
+		return;
+	}
+	if (adr < 0x3f00)
+	{
+		nes->nameRam[ppu_name_index(nes, adr)] = value;
+		return;
+	}
+	adr &= 0x1f;
+	if (!(adr & 3))	adr &= 0x0f;
+	nes->palette[adr] = value & 0x3f;
+}
+
+// Finds the first opaque pixel of sprite 0 and converts it to a frame dot
+// Background opacity is not checked, the HUD split only ever puts sprite 0 over solid tiles
+static void ppu_find_sprite0(NesMachine *nes)
+{
+	uint8_t y = nes->oam[0], tile = nes->oam[1], attr = nes->oam[2], x = nes->oam[3];
+	uint16_t base = (nes->ppuCtrl & 0x08) ? 0x1000 : 0x0000;
+	int row, col;
+
+	nes->sprite0Dot = NO_SPRITE0;
+	if (y >= 239)	return;
+
+	for (row = 0; row < 8; ++row)
+	{
+		int srcRow = (attr & 0x80) ? 7 - row : row;
+		uint8_t bits = nes->chr[base + tile*16 + srcRow] | nes->chr[base + tile*16 + 8 + srcRow];
+		if (!bits)	continue;
+		for (col = 0; col < 8; ++col)
+		{
+			int srcCol = (attr & 0x40) ? col : 7 - col;
+			if (bits & (1 << srcCol))
+			{
+				if (x + col == 255)	return;
+				nes->sprite0Dot = (uint32_t)(y + 1 + row)*NES_DOTS_PER_LINE + x + col + 1;
+				return;
+			}
+		}
+	}
+}
+
+static void ppu_tick(NesMachine *nes, uint32_t dots)
+{
+	while (dots)
+	{
+		uint32_t from = nes->dot;
+		uint32_t step = NES_DOTS_PER_FRAME - from;
+		uint32_t to;
+
+		if (step > dots)	step = dots;
+		to = from + step;
+
+		if (from < VBLANK_DOT && to >= VBLANK_DOT)
+		{
+			nes->ppuStatus |= 0x80;
+			++nes->frame;
+			if (nes->ppuCtrl & 0x80)	nes->nmiPending = 1;
+		}
+		if (from < PRERENDER_DOT && to >= PRERENDER_DOT)
+		{
+			nes->ppuStatus &= 0x1f;
+		}
+		if (nes->sprite0Dot != NO_SPRITE0 && from < nes->sprite0Dot && to >= nes->sprite0Dot &&
+			(nes->ppuMask & 0x18) == 0x18)
+		{
+			nes->ppuStatus |= 0x40;
+		}
+
+		nes->dot = to;
+		dots -= step;
+		if (nes->dot == NES_DOTS_PER_FRAME)
+		{
+			nes->dot = 0;
+			ppu_find_sprite0(nes);
+		}
+	}
+}
+
+static uint8_t ppu_read(NesMachine *nes, uint16_t reg)
+{
+	uint8_t value = 0;
+
+	switch (reg & 7)
+	{
+	case 2:
+		value = (nes->ppuStatus & 0xe0) | (nes->readBuffer & 0x1f);
+		nes->ppuStatus &= 0x7f;
+		nes->writeLatch = 0;
+		break;
+	case 4:
+		value = nes->oam[nes->oamAdr];
+		break;
+	case 7:
+		if ((nes->vramAdr & 0x3fff) >= 0x3f00)
+		{
+			value = ppu_vram_read(nes, nes->vramAdr);
+			nes->readBuffer = ppu_vram_read(nes, nes->vramAdr - 0x1000);
+		}
+		else
+		{
+			value = nes->readBuffer;
+			nes->readBuffer = ppu_vram_read(nes, nes->vramAdr);
+		}
+		nes->vramAdr += (nes->ppuCtrl & 0x04) ? 32 : 1;
+		break;
+	}
+	return value;
+}
+
+static void ppu_write(NesMachine *nes, uint16_t reg, uint8_t value)
+{
+	switch (reg & 7)
+	{
+	case 0:
+		if ((value & 0x80) && !(nes->ppuCtrl & 0x80) && (nes->ppuStatus & 0x80))
+		{
+			nes->nmiPending = 1;
+		}
+		nes->ppuCtrl = value;
+		nes->vramTmp = (nes->vramTmp & 0x73ff) | ((value & 3) << 10);
+		break;
+	case 1:
+		nes->ppuMask = value;
+		break;
+	case 3:
+		nes->oamAdr = value;
+		break;
+	case 4:
+		nes->oam[nes->oamAdr++] = value;
+		break;
+	case 5:
+		if (!nes->writeLatch)
+		{
+			nes->vramTmp = (nes->vramTmp & 0x7fe0) | (value >> 3);
+			nes->fineX = value & 7;
+		}
+		else
+		{
+			nes->vramTmp = (nes->vramTmp & 0x0c1f) | ((value & 7) << 12) | ((value & 0xf8) << 2);
+		}
+		nes->writeLatch ^= 1;
+		break;
+	case 6:
+		if (!nes->writeLatch)
+		{
+			nes->vramTmp = (nes->vramTmp & 0x00ff) | ((value & 0x3f) << 8);
+		}
+		else
+		{
+			nes->vramTmp = (nes->vramTmp & 0x7f00) | value;
+			nes->vramAdr = nes->vramTmp;
+		}
+		nes->writeLatch ^= 1;
+		break;
+	case 7:
+		ppu_vram_write(nes, nes->vramAdr, value);
+		nes->vramAdr += (nes->ppuCtrl & 0x04) ? 32 : 1;
+		break;
+	}
+}
+
+/*
+ * Bus
+ */
+
+static uint8_t prg_read(NesMachine *nes, uint16_t adr)
+{
+	uint32_t offset;
+
+	if (nes->mapper == 2)
+	{
+		if (adr < 0xc000)	offset = (uint32_t)nes->prgBank*0x4000 + (adr & 0x3fff);
+		else				offset = nes->prgSize - 0x4000 + (adr & 0x3fff);
+	}
+	else
+	{
+		offset = adr & 0x7fff;
+	}
+	return nes->prg[offset % nes->prgSize];
+}
+
+static uint8_t bus_read(NesMachine *nes, uint16_t adr)
+{
+	if (adr < 0x2000)	return nes->ram[adr & 0x7ff];
+	if (adr < 0x4000)	return ppu_read(nes, adr);
+	if (adr == 0x4016 || adr == 0x4017)
+	{
+		int port = adr & 1;
+		uint8_t bit;
+		if (nes->padStrobe)	return 0x40 | (nes->pad[port] & 1);
+		bit = nes->padShift[port] & 1;
+		nes->padShift[port] = (nes->padShift[port] >> 1) | 0x80;
+		return 0x40 | bit;
+	}
+	if (adr < 0x6000)	return 0;
+	if (adr < 0x8000)	return nes->prgRam[adr & 0x1fff];
+	return prg_read(nes, adr);
+}
+
+static void bus_write(NesMachine *nes, uint16_t adr, uint8_t value)
+{
+	if (adr < 0x2000)
+	{
+		nes->ram[adr & 0x7ff] = value;
+		return;
+	}
+	if (adr < 0x4020 && nes->ioHook)	nes->ioHook(nes, adr, value);
+	if (adr < 0x4000)
+	{
+		ppu_write(nes, adr, value);
+		return;
+	}
+	if (adr == 0x4014)
+	{
+		int i;
+		uint16_t src = value << 8;
+		for (i = 0; i < 256; ++i)
+		{
+			nes->oam[(nes->oamAdr + i) & 0xff] = bus_read(nes, src + i);
+		}
+		// CPU is halted for the copy, charged to the writing instruction
+		nes->dmaCycles = 513 + (unsigned)(nes->cycles & 1);
+		return;
+	}
+	if (adr == 0x4016)
+	{
+		nes->padStrobe = value & 1;
+		if (nes->padStrobe)
+		{
+			nes->padShift[0] = nes->pad[0];
+			nes->padShift[1] = nes->pad[1];
+		}
+		return;
+	}
+	if (adr < 0x6000)	return;
+	if (adr < 0x8000)
+	{
+		nes->prgRam[adr & 0x1fff] = value;
+		return;
+	}
+	if (nes->mapper == 2)	nes->prgBank = value & (uint8_t)(nes->prgSize/0x4000 - 1);
+}
+
+uint8_t nes_peek(NesMachine *nes, uint16_t adr)
+{
+	if (adr < 0x2000)	return nes->ram[adr & 0x7ff];
+	if (adr < 0x6000)	return 0;
+	if (adr < 0x8000)	return nes->prgRam[adr & 0x1fff];
+	return prg_read(nes, adr);
+}
+
+void nes_poke(NesMachine *nes, uint16_t adr, uint8_t value)
+{
+	if (adr < 0x2000)						nes->ram[adr & 0x7ff] = value;
+	else if (adr >= 0x6000 && adr < 0x8000)	nes->prgRam[adr & 0x1fff] = value;
+}
+
+int nes_scanline(const NesMachine *nes)
+{
+	return nes->dot / NES_DOTS_PER_LINE;
+}
+
+int nes_in_vblank(const NesMachine *nes)
+{
+	return nes->dot >= VBLANK_DOT && nes->dot < PRERENDER_DOT;
+}
+
+int nes_vblank_cycle(const NesMachine *nes)
+{
+	return nes_in_vblank(nes) ? (int)(nes->dot - VBLANK_DOT)/3 : -1;
+}
+
+/*
+ * CPU
+ */
+
+#define READ(a)			bus_read(nes, (a))
+#define WRITE(a,v)		bus_write(nes, (a), (v))
+#define SET_NZ(v)		(nes->p = (nes->p & ~(FLAG_N|FLAG_Z)) | ((v) & 0x80) | ((v) ? 0 : FLAG_Z))
+
+static void push(NesMachine *nes, uint8_t value)
+{
+	nes->ram[0x100 | nes->s--] = value;
+}
+
+static uint8_t pull(NesMachine *nes)
+{
+	return nes->ram[0x100 | ++nes->s];
+}
+
+static uint16_t read16(NesMachine *nes, uint16_t adr)
+{
+	return READ(adr) | (READ(adr + 1) << 8);
+}
+
+// Zero page word read, wraps within page 0 like the real thing
+static uint16_t read16zp(NesMachine *nes, uint8_t adr)
+{
+	return nes->ram[adr] | (nes->ram[(uint8_t)(adr + 1)] << 8);
+}
+
+static void interrupt(NesMachine *nes, uint16_t vector, int brk)
+{
+	push(nes, nes->pc >> 8);
+	push(nes, nes->pc & 0xff);
+	push(nes, (nes->p | FLAG_U | (brk ? FLAG_B : 0)) & ~(brk ? 0 : FLAG_B));
+	nes->p |= FLAG_I;
+	nes->pc = read16(nes, vector);
+}
+
+static void adc(NesMachine *nes, uint8_t value)
+{
+	unsigned sum = nes->a + value + (nes->p & FLAG_C);
+	nes->p &= ~(FLAG_C|FLAG_V);
+	if (sum > 0xff)									nes->p |= FLAG_C;
+	if (~(nes->a ^ value) & (nes->a ^ sum) & 0x80)	nes->p |= FLAG_V;
+	nes->a = (uint8_t)sum;
+	SET_NZ(nes->a);
+}
+
+static void compare(NesMachine *nes, uint8_t reg, uint8_t value)
+{
+	uint8_t diff = reg - value;
+	nes->p = (nes->p & ~FLAG_C) | (reg >= value ? FLAG_C : 0);
+	SET_NZ(diff);
+}
+
+void nes_reset(NesMachine *nes)
+{
+	nes->a = nes->x = nes->y = 0;
+	nes->s = 0xfd;
+	nes->p = FLAG_I | FLAG_U;
+	nes->cycles = 7;
+	nes->jammed = 0;
+	nes->nmiDepth = 0;
+	nes->prgBank = 0;
+	nes->ppuCtrl = nes->ppuMask = nes->ppuStatus = nes->oamAdr = 0;
+	nes->vramAdr = nes->vramTmp = 0;
+	nes->fineX = nes->writeLatch = nes->readBuffer = 0;
+	nes->dot = 0;
+	nes->sprite0Dot = NO_SPRITE0;
+	nes->frame = 0;
+	nes->nmiPending = 0;
+	nes->padStrobe = 0;
+	nes->pc = read16(nes, 0xfffc);
+}
+
+unsigned nes_step(NesMachine *nes)
+{
+	uint16_t pc = nes->pc, adr = 0;
+	uint8_t op, value;
+	unsigned cycles;
+	int crossed = 0;
+
+	if (nes->nmiPending)
+	{
+		nes->nmiPending = 0;
+		++nes->nmiDepth;
+		interrupt(nes, 0xfffa, 0);
+		nes->cycles += 7;
+		ppu_tick(nes, 7*3);
+		return 7;
+	}
+
+	op = READ(pc);
+	cycles = opCycles[op];
+	if (!cycles)
+	{
+		nes->jammed = 1;
+		return 0;
+	}
+
+	// Resolve the operand address by addressing mode (column/row pattern of the opcode matrix)
+	switch (op)
+	{
+	// Immediate
+	case 0x09: case 0x29: case 0x49: case 0x69: case 0xa0: case 0xa2: case 0xa9:
+	case 0xc0: case 0xc9: case 0xe0: case 0xe9:
+		adr = pc + 1; nes->pc = pc + 2; break;
+	// Zero page
+	case 0x05: case 0x06: case 0x24: case 0x25: case 0x26: case 0x45: case 0x46:
+	case 0x65: case 0x66: case 0x84: case 0x85: case 0x86: case 0xa4: case 0xa5:
+	case 0xa6: case 0xc4: case 0xc5: case 0xc6: case 0xe4: case 0xe5: case 0xe6:
+		adr = READ(pc + 1); nes->pc = pc + 2; break;
+	// Zero page,X
+	case 0x15: case 0x16: case 0x35: case 0x36: case 0x55: case 0x56: case 0x75:
+	case 0x76: case 0x94: case 0x95: case 0xb4: case 0xb5: case 0xd5: case 0xd6:
+	case 0xf5: case 0xf6:
+		adr = (uint8_t)(READ(pc + 1) + nes->x); nes->pc = pc + 2; break;
+	// Zero page,Y
+	case 0x96: case 0xb6:
+		adr = (uint8_t)(READ(pc + 1) + nes->y); nes->pc = pc + 2; break;
+	// Absolute
+	case 0x0d: case 0x0e: case 0x20: case 0x2c: case 0x2d: case 0x2e: case 0x4c:
+	case 0x4d: case 0x4e: case 0x6d: case 0x6e: case 0x8c: case 0x8d: case 0x8e:
+	case 0xac: case 0xad: case 0xae: case 0xcc: case 0xcd: case 0xce: case 0xec:
+	case 0xed: case 0xee:
+		adr = read16(nes, pc + 1); nes->pc = pc + 3; break;
+	// Absolute,X
+	case 0x1d: case 0x1e: case 0x3d: case 0x3e: case 0x5d: case 0x5e: case 0x7d:
+	case 0x7e: case 0x9d: case 0xbc: case 0xbd: case 0xdd: case 0xde: case 0xfd:
+	case 0xfe:
+		adr = read16(nes, pc + 1);
+		crossed = ((adr + nes->x) ^ adr) & 0xff00;
+		adr += nes->x; nes->pc = pc + 3; break;
+	// Absolute,Y
+	case 0x19: case 0x39: case 0x59: case 0x79: case 0x99: case 0xb9: case 0xbe:
+	case 0xd9: case 0xf9:
+		adr = read16(nes, pc + 1);
+		crossed = ((adr + nes->y) ^ adr) & 0xff00;
+		adr += nes->y; nes->pc = pc + 3; break;
+	// (Indirect,X)
+	case 0x01: case 0x21: case 0x41: case 0x61: case 0x81: case 0xa1: case 0xc1:
+	case 0xe1:
+		adr = read16zp(nes, (uint8_t)(READ(pc + 1) + nes->x)); nes->pc = pc + 2; break;
+	// (Indirect),Y
+	case 0x11: case 0x31: case 0x51: case 0x71: case 0x91: case 0xb1: case 0xd1:
+	case 0xf1:
+		adr = read16zp(nes, READ(pc + 1));
+		crossed = ((adr + nes->y) ^ adr) & 0xff00;
+		adr += nes->y; nes->pc = pc + 2; break;
+	// Relative branches: target computed below
+	case 0x10: case 0x30: case 0x50: case 0x70: case 0x90: case 0xb0: case 0xd0:
+	case 0xf0:
+		adr = pc + 2 + (int8_t)READ(pc + 1); nes->pc = pc + 2; break;
+	// Indirect JMP, with the page wrap bug
+	case 0x6c:
+		adr = read16(nes, pc + 1);
+		adr = READ(adr) | (READ((adr & 0xff00) | ((adr + 1) & 0xff)) << 8);
+		nes->pc = pc + 3; break;
+	// Implied and accumulator
+	default:
+		nes->pc = pc + 1; break;
+	}
+
+	switch (op)
+	{
+	// Loads and stores
+	case 0xa9: case 0xa5: case 0xb5: case 0xad: case 0xbd: case 0xb9: case 0xa1: case 0xb1:
+		nes->a = READ(adr); SET_NZ(nes->a);
+		if (op == 0xbd || op == 0xb9 || op == 0xb1)	cycles += crossed ? 1 : 0;
+		break;
+	case 0xa2: case 0xa6: case 0xb6: case 0xae: case 0xbe:
+		nes->x = READ(adr); SET_NZ(nes->x);
+		if (op == 0xbe)	cycles += crossed ? 1 : 0;
+		break;
+	case 0xa0: case 0xa4: case 0xb4: case 0xac: case 0xbc:
+		nes->y = READ(adr); SET_NZ(nes->y);
+		if (op == 0xbc)	cycles += crossed ? 1 : 0;
+		break;
+	case 0x85: case 0x95: case 0x8d: case 0x9d: case 0x99: case 0x81: case 0x91:
+		WRITE(adr, nes->a); break;
+	case 0x86: case 0x96: case 0x8e:
+		WRITE(adr, nes->x); break;
+	case 0x84: case 0x94: case 0x8c:
+		WRITE(adr, nes->y); break;
+
+	// Transfers
+	case 0xaa: nes->x = nes->a; SET_NZ(nes->x); break;
+	case 0xa8: nes->y = nes->a; SET_NZ(nes->y); break;
+	case 0x8a: nes->a = nes->x; SET_NZ(nes->a); break;
+	case 0x98: nes->a = nes->y; SET_NZ(nes->a); break;
+	case 0xba: nes->x = nes->s; SET_NZ(nes->x); break;
+	case 0x9a: nes->s = nes->x; break;
+
+	// Stack
+	case 0x48: push(nes, nes->a); break;
+	case 0x08: push(nes, nes->p | FLAG_B | FLAG_U); break;
+	case 0x68: nes->a = pull(nes); SET_NZ(nes->a); break;
+	case 0x28: nes->p = (pull(nes) & ~FLAG_B) | FLAG_U; break;
+
+	// Logic and arithmetic (reads get the page cross penalty)
+	case 0x29: case 0x25: case 0x35: case 0x2d: case 0x3d: case 0x39: case 0x21: case 0x31:
+		nes->a &= READ(adr); SET_NZ(nes->a); goto readPenalty;
+	case 0x09: case 0x05: case 0x15: case 0x0d: case 0x1d: case 0x19: case 0x01: case 0x11:
+		nes->a |= READ(adr); SET_NZ(nes->a); goto readPenalty;
+	case 0x49: case 0x45: case 0x55: case 0x4d: case 0x5d: case 0x59: case 0x41: case 0x51:
+		nes->a ^= READ(adr); SET_NZ(nes->a); goto readPenalty;
+	case 0x69: case 0x65: case 0x75: case 0x6d: case 0x7d: case 0x79: case 0x61: case 0x71:
+		adc(nes, READ(adr)); goto readPenalty;
+	case 0xe9: case 0xe5: case 0xf5: case 0xed: case 0xfd: case 0xf9: case 0xe1: case 0xf1:
+		adc(nes, ~READ(adr)); goto readPenalty;
+	case 0xc9: case 0xc5: case 0xd5: case 0xcd: case 0xdd: case 0xd9: case 0xc1: case 0xd1:
+		compare(nes, nes->a, READ(adr)); goto readPenalty;
+	case 0xe0: case 0xe4: case 0xec:
+		compare(nes, nes->x, READ(adr)); break;
+	case 0xc0: case 0xc4: case 0xcc:
+		compare(nes, nes->y, READ(adr)); break;
+	case 0x24: case 0x2c:
+		value = READ(adr);
+		nes->p = (nes->p & ~(FLAG_N|FLAG_V|FLAG_Z)) | (value & (FLAG_N|FLAG_V)) | ((value & nes->a) ? 0 : FLAG_Z);
+		break;
+	readPenalty:
+		switch (op & 0x1f)
+		{
+		case 0x1d: case 0x19: case 0x11: cycles += crossed ? 1 : 0; break;
+		}
+		break;
+
+	// Increments and decrements
+	case 0xe6: case 0xf6: case 0xee: case 0xfe:
+		value = READ(adr) + 1; WRITE(adr, value); SET_NZ(value); break;
+	case 0xc6: case 0xd6: case 0xce: case 0xde:
+		value = READ(adr) - 1; WRITE(adr, value); SET_NZ(value); break;
+	case 0xe8: ++nes->x; SET_NZ(nes->x); break;
+	case 0xc8: ++nes->y; SET_NZ(nes->y); break;
+	case 0xca: --nes->x; SET_NZ(nes->x); break;
+	case 0x88: --nes->y; SET_NZ(nes->y); break;
+
+	// Shifts and rotates
+	case 0x0a:
+		nes->p = (nes->p & ~FLAG_C) | (nes->a >> 7);
+		nes->a <<= 1; SET_NZ(nes->a); break;
+	case 0x4a:
+		nes->p = (nes->p & ~FLAG_C) | (nes->a & 1);
+		nes->a >>= 1; SET_NZ(nes->a); break;
+	case 0x2a:
+		value = (nes->a << 1) | (nes->p & FLAG_C);
+		nes->p = (nes->p & ~FLAG_C) | (nes->a >> 7);
+		nes->a = value; SET_NZ(nes->a); break;
+	case 0x6a:
+		value = (nes->a >> 1) | ((nes->p & FLAG_C) << 7);
+		nes->p = (nes->p & ~FLAG_C) | (nes->a & 1);
+		nes->a = value; SET_NZ(nes->a); break;
+	case 0x06: case 0x16: case 0x0e: case 0x1e:
+		value = READ(adr);
+		nes->p = (nes->p & ~FLAG_C) | (value >> 7);
+		value <<= 1; WRITE(adr, value); SET_NZ(value); break;
+	case 0x46: case 0x56: case 0x4e: case 0x5e:
+		value = READ(adr);
+		nes->p = (nes->p & ~FLAG_C) | (value & 1);
+		value >>= 1; WRITE(adr, value); SET_NZ(value); break;
+	case 0x26: case 0x36: case 0x2e: case 0x3e:
+	{
+		uint8_t old = READ(adr);
+		value = (old << 1) | (nes->p & FLAG_C);
+		nes->p = (nes->p & ~FLAG_C) | (old >> 7);
+		WRITE(adr, value); SET_NZ(value); break;
+	}
+	case 0x66: case 0x76: case 0x6e: case 0x7e:
+	{
+		uint8_t old = READ(adr);
+		value = (old >> 1) | ((nes->p & FLAG_C) << 7);
+		nes->p = (nes->p & ~FLAG_C) | (old & 1);
+		WRITE(adr, value); SET_NZ(value); break;
+	}
+
+	// Jumps and subroutines
+	case 0x4c: case 0x6c:
+		nes->pc = adr; break;
+	case 0x20:
+		push(nes, (pc + 2) >> 8);
+		push(nes, (pc + 2) & 0xff);
+		nes->pc = adr; break;
+	case 0x60:
+		nes->pc = pull(nes);
+		nes->pc |= pull(nes) << 8;
+		++nes->pc; break;
+	case 0x40:
+		nes->p = (pull(nes) & ~FLAG_B) | FLAG_U;
+		nes->pc = pull(nes);
+		nes->pc |= pull(nes) << 8;
+		if (nes->nmiDepth)	--nes->nmiDepth;
+		break;
+	case 0x00:
+		nes->pc = pc + 2;
+		interrupt(nes, 0xfffe, 1);
+		break;
+
+	// Branches
+	case 0x10: case 0x30: case 0x50: case 0x70: case 0x90: case 0xb0: case 0xd0: case 0xf0:
+	{
+		static const uint8_t flagOf[4] = { FLAG_N, FLAG_V, FLAG_C, FLAG_Z };
+		int set = (nes->p & flagOf[op >> 6]) != 0;
+		if (set == ((op >> 5) & 1))
+		{
+			cycles += 1 + (((pc + 2) ^ adr) & 0xff00 ? 1 : 0);
+			nes->pc = adr;
+		}
+		break;
+	}
+
+	// Flags
+	case 0x18: nes->p &= ~FLAG_C; break;
+	case 0x38: nes->p |= FLAG_C; break;
+	case 0x58: nes->p &= ~FLAG_I; break;
+	case 0x78: nes->p |= FLAG_I; break;
+	case 0xb8: nes->p &= ~FLAG_V; break;
+	case 0xd8: nes->p &= ~FLAG_D; break;
+	case 0xf8: nes->p |= FLAG_D; break;
+
+	case 0xea: break;
+	}
+
+	cycles += nes->dmaCycles;
+	nes->dmaCycles = 0;
+
+	nes->cycles += cycles;
+	ppu_tick(nes, cycles*3);
+	if (nes->execHook)	nes->execHook(nes, pc, op, cycles);
+	return cycles;
+}
+
+/*
+ * Cartridge
+ */
+
+int nes_load(NesMachine *nes, const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	uint8_t header[16];
+
+	memset(nes, 0, sizeof(*nes));
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	if (fread(header, 1, 16, f) != 16 || memcmp(header, "NES\x1a", 4))
+	{
+		fprintf(stderr, "%s: not an iNES image\n", path);
+		fclose(f);
+		return 1;
+	}
+
+	nes->prgSize = header[4]*0x4000;
+	nes->mapper = (header[6] >> 4) | (header[7] & 0xf0);
+	nes->mirroring = header[6] & 1;
+	if (nes->mapper != 0 && nes->mapper != 2)
+	{
+		fprintf(stderr, "%s: mapper %d is not supported\n", path, nes->mapper);
+		fclose(f);
+		return 1;
+	}
+
+	nes->prg = malloc(nes->prgSize);
+	if (!nes->prg || fread(nes->prg, 1, nes->prgSize, f) != nes->prgSize)
+	{
+		fprintf(stderr, "%s: truncated PRG\n", path);
+		fclose(f);
+		return 1;
+	}
+	if (header[5])
+	{
+		if (fread(nes->chr, 1, 0x2000, f) != 0x2000)
+		{
+			fprintf(stderr, "%s: truncated CHR\n", path);
+			fclose(f);
+			return 1;
+		}
+	}
+	else
+	{
+		nes->chrIsRam = 1;
+	}
+
+	fclose(f);
+	nes_reset(nes);
+	return 0;
+}
+
+void nes_free(NesMachine *nes)
+{
+	free(nes->prg);
+	nes->prg = NULL;
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+*  @file       	nesemu.h
+*  @brief      	Headless NES machine used by the host-side tools
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Cycle-counting 6502 core plus just enough of the PPU, pads and
+*		mapper to boot NESMaze.nes without a display or sound output
+*		> PPU timing is tracked in dots (3 per CPU cycle, 341x262 per
+*		NTSC frame), so vblank, NMI and sprite 0 hit land on the same
+*		CPU cycle as on hardware, give or take one instruction
+******************************************************************************/
+
+#ifndef NESEMU_H
+#define NESEMU_H
+
+#include <stdint.h>
+
+// NTSC frame geometry, in PPU dots
+#define NES_DOTS_PER_LINE		341
+#define NES_LINES_PER_FRAME		262
+#define NES_DOTS_PER_FRAME		(NES_DOTS_PER_LINE*NES_LINES_PER_FRAME)
+#define NES_VBLANK_LINE			241
+#define NES_PRERENDER_LINE		261
+
+// CPU cycles in one NTSC frame and in the vblank window (rounded down)
+#define NES_CYCLES_PER_FRAME	(NES_DOTS_PER_FRAME/3)
+#define NES_CYCLES_PER_VBLANK	(((NES_PRERENDER_LINE-NES_VBLANK_LINE)*NES_DOTS_PER_LINE)/3)
+
+// Status flag bits
+#define FLAG_C	0x01
+#define FLAG_Z	0x02
+#define FLAG_I	0x04
+#define FLAG_D	0x08
+#define FLAG_B	0x10
+#define FLAG_U	0x20
+#define FLAG_V	0x40
+#define FLAG_N	0x80
+
+typedef struct NesMachine NesMachine;
+
+// Called after every executed instruction (pc is the instruction address)
+typedef void (*NesExecHook)(NesMachine *nes, uint16_t pc, uint8_t opcode, unsigned cycles);
+// Called on every CPU write to $2000-$401f (PPU, APU and I/O registers)
+typedef void (*NesIoHook)(NesMachine *nes, uint16_t adr, uint8_t value);
+
+struct NesMachine
+{
+	// CPU registers
+	uint8_t a, x, y, s, p;
+	uint16_t pc;
+	uint64_t cycles;
+	// Set when the core hits an opcode it does not implement
+	int jammed;
+	// Number of nested NMI handlers currently running (RTI pops one)
+	int nmiDepth;
+	// Extra cycles the current instruction stalls for (OAM DMA)
+	unsigned dmaCycles;
+
+	// Memory
+	uint8_t ram[0x800];
+	uint8_t prgRam[0x2000];
+	uint8_t *prg;
+	uint32_t prgSize;
+	uint8_t chr[0x2000];
+	int chrIsRam;
+	int mapper;
+	int mirroring;			// 0 horizontal, 1 vertical
+	uint8_t prgBank;		// Switchable 16K bank (UNROM)
+
+	// PPU state
+	uint8_t ppuCtrl, ppuMask, ppuStatus, oamAdr;
+	uint16_t vramAdr, vramTmp;
+	uint8_t fineX, writeLatch, readBuffer;
+	uint8_t nameRam[0x800];
+	uint8_t palette[32];
+	uint8_t oam[256];
+	uint32_t dot;			// Dot within the current frame
+	uint32_t sprite0Dot;	// Dot at which sprite 0 hit is raised this frame
+	uint64_t frame;			// Number of completed frames (vblank starts)
+	int nmiPending;
+
+	// Controllers
+	uint8_t pad[2];
+	uint8_t padShift[2];
+	uint8_t padStrobe;
+
+	// Optional instrumentation
+	NesExecHook execHook;
+	NesIoHook ioHook;
+	void *user;
+};
+
+// Loads an iNES image into the machine; returns 0 on success
+int nes_load(NesMachine *nes, const char *path);
+// Frees the loaded image
+void nes_free(NesMachine *nes);
+// Resets the CPU and PPU to power-on state
+void nes_reset(NesMachine *nes);
+// Executes one instruction (or services a pending NMI); returns CPU cycles taken
+unsigned nes_step(NesMachine *nes);
+
+// Side effect free memory access, for tools that inspect or patch RAM
+uint8_t nes_peek(NesMachine *nes, uint16_t adr);
+void nes_poke(NesMachine *nes, uint16_t adr, uint8_t value);
+
+// Current scanline (0..261) and whether the PPU is rendering right now
+int nes_scanline(const NesMachine *nes);
+int nes_in_vblank(const NesMachine *nes);
+// CPU cycles since the current vblank started, or -1 outside vblank
+int nes_vblank_cycle(const NesMachine *nes);
+
+#endif
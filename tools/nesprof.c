@@ -0,0 +1,349 @@
+/******************************************************************************
+*  @file       	nesprof.c
+*  @brief      	Function and source line CPU profiler for NESMaze.nes
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Plays the same scripted session as nesbench and attributes every
+*		executed cycle to the routine it belongs to (nearest preceding
+*		ld65 label) and, with the debug file, to the C or asm source line
+*		> Calls are followed with a shadow stack built from jsr/rts and
+*		NMI/rti, so inclusive cycles and caller->callee edges are exact
+*		as long as the code returns the usual way. Cycles spent in the NMI
+*		are not charged to the main thread routine it interrupted
+*		> Everything is reported separately for each game phase
+*
+*		Usage: nesprof -l labels [options] [rom]
+*			-g dbgfile	ld65 debug file, adds the source line report
+*			-i script	pad input script (see tools/bench/session.txt)
+*			-p padlog	replay a pad log recorded by the game instead (needs -l)
+*			-w padlog	record the buttons of every pad poll into a pad log (needs -l)
+*			-L level	level the first cleared level goes on to
+*			-n frames	number of frames to run (default 3600)
+*			-t count	rows per report (default 15)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbginfo.h"
+#include "session.h"
+
+#define DEFAULT_ROM		"NESMaze.nes"
+#define DEFAULT_FRAMES	3600
+#define DEFAULT_TOP		15
+
+#define STACK_DEPTH		256
+#define EDGE_HASH_SIZE	8192
+
+// Index used for cycles outside any known routine
+#define NO_FUNC			(-1)
+
+typedef struct
+{
+	uint64_t self;
+	uint64_t incl;
+	uint64_t calls;
+} FuncStats;
+
+typedef struct
+{
+	int used;
+	int caller;
+	int callee;
+	uint64_t calls;
+	uint64_t incl;
+} EdgeStats;
+
+typedef struct
+{
+	int func;
+	int caller;
+	uint8_t sp;
+	int inNmi;
+	uint64_t entryCycles;
+	uint64_t entryNmiCycles;
+} Frame;
+
+static Session session;
+static DebugInfo dbg;
+static int haveDbg;
+
+// Per phase statistics
+static FuncStats *funcStats[PHASE_COUNT];
+static EdgeStats edges[PHASE_COUNT][EDGE_HASH_SIZE];
+static uint64_t *lineCycles[PHASE_COUNT];
+static uint64_t unknownCycles[PHASE_COUNT];
+static uint64_t phaseCycles[PHASE_COUNT];
+static uint64_t phaseFrames[PHASE_COUNT];
+
+static Frame stack[STACK_DEPTH];
+static int depth;
+static uint64_t nmiCycles;
+
+static int func_at(uint16_t adr)
+{
+	const Symbol *sym = sym_function_at(&session.labels, adr);
+	return sym ? (int)(sym - session.labels.syms) : NO_FUNC;
+}
+
+static const char *func_name(int func)
+{
+	return func == NO_FUNC ? "(unknown)" : session.labels.syms[func].name;
+}
+
+static EdgeStats *edge(int phase, int caller, int callee)
+{
+	unsigned h = ((unsigned)caller*31u + (unsigned)callee) & (EDGE_HASH_SIZE - 1);
+
+	while (edges[phase][h].used && (edges[phase][h].caller != caller || edges[phase][h].callee != callee))
+	{
+		h = (h + 1) & (EDGE_HASH_SIZE - 1);
+	}
+	edges[phase][h].used = 1;
+	edges[phase][h].caller = caller;
+	edges[phase][h].callee = callee;
+	return &edges[phase][h];
+}
+
+static void push_frame(int func, int caller, uint8_t sp, int inNmi, int phase)
+{
+	if (depth == STACK_DEPTH)
+	{
+		// Runaway stack (code that never returns normally), drop the oldest half
+		memmove(stack, stack + STACK_DEPTH/2, sizeof(Frame)*(STACK_DEPTH/2));
+		depth = STACK_DEPTH/2;
+	}
+	stack[depth].func = func;
+	stack[depth].caller = caller;
+	stack[depth].sp = sp;
+	stack[depth].inNmi = inNmi;
+	stack[depth].entryCycles = session.nes.cycles;
+	stack[depth].entryNmiCycles = nmiCycles;
+	++depth;
+
+	if (func != NO_FUNC)	++funcStats[phase][func].calls;
+	++edge(phase, caller, func)->calls;
+}
+
+// Pops every frame whose return already happened (the stack pointer is back above it)
+static void pop_frames(int phase)
+{
+	while (depth && stack[depth - 1].sp <= session.nes.s)
+	{
+		Frame *f = &stack[--depth];
+		uint64_t incl = session.nes.cycles - f->entryCycles;
+
+		if (!f->inNmi)	incl -= nmiCycles - f->entryNmiCycles;
+		if (f->func != NO_FUNC)	funcStats[phase][f->func].incl += incl;
+		edge(phase, f->caller, f->func)->incl += incl;
+	}
+}
+
+static int compare_u64_desc(uint64_t a, uint64_t b)
+{
+	return a < b ? 1 : a > b ? -1 : 0;
+}
+
+static int sortPhase;
+
+static int compare_funcs(const void *a, const void *b)
+{
+	return compare_u64_desc(funcStats[sortPhase][*(const int *)a].self, funcStats[sortPhase][*(const int *)b].self);
+}
+
+static int compare_edges(const void *a, const void *b)
+{
+	return compare_u64_desc((*(EdgeStats * const *)a)->incl, (*(EdgeStats * const *)b)->incl);
+}
+
+static int compare_lines(const void *a, const void *b)
+{
+	return compare_u64_desc(lineCycles[sortPhase][*(const int *)a], lineCycles[sortPhase][*(const int *)b]);
+}
+
+static void report(int phase, int top)
+{
+	int funcCount = session.labels.count;
+	int *order = malloc(sizeof(int)*(funcCount + (haveDbg ? dbg.lineCount : 0) + 1));
+	EdgeStats **edgeOrder = malloc(sizeof(EdgeStats *)*EDGE_HASH_SIZE);
+	uint64_t total = phaseCycles[phase];
+	int i, n;
+
+	printf("== %s: %llu cycles in %llu frames (%llu per frame) ==\n\n", phaseNames[phase],
+		   (unsigned long long)total, (unsigned long long)phaseFrames[phase],
+		   (unsigned long long)(phaseFrames[phase] ? total/phaseFrames[phase] : 0));
+
+	// Flat profile by self cycles
+	sortPhase = phase;
+	for (i = 0; i < funcCount; ++i)	order[i] = i;
+	qsort(order, funcCount, sizeof(int), compare_funcs);
+
+	printf("%12s %6s %12s %9s %9s  %s\n", "self cyc", "self%", "incl cyc", "calls", "cyc/call", "routine");
+	for (i = 0; i < funcCount && i < top; ++i)
+	{
+		FuncStats *s = &funcStats[phase][order[i]];
+		if (!s->self)	break;
+		printf("%12llu %5.1f%% %12llu %9llu %9llu  %s\n", (unsigned long long)s->self,
+			   100.0*s->self/total, (unsigned long long)s->incl, (unsigned long long)s->calls,
+			   (unsigned long long)(s->calls ? s->incl/s->calls : 0), func_name(order[i]));
+	}
+	if (unknownCycles[phase])
+	{
+		printf("%12llu %5.1f%% %12s %9s %9s  %s\n", (unsigned long long)unknownCycles[phase],
+			   100.0*unknownCycles[phase]/total, "", "", "", func_name(NO_FUNC));
+	}
+
+	// Call graph edges by inclusive cycles
+	for (i = n = 0; i < EDGE_HASH_SIZE; ++i)
+	{
+		if (edges[phase][i].used && edges[phase][i].incl)	edgeOrder[n++] = &edges[phase][i];
+	}
+	qsort(edgeOrder, n, sizeof(EdgeStats *), compare_edges);
+
+	printf("\n%12s %6s %9s  %s\n", "incl cyc", "incl%", "calls", "caller -> callee");
+	for (i = 0; i < n && i < top; ++i)
+	{
+		printf("%12llu %5.1f%% %9llu  %s -> %s\n", (unsigned long long)edgeOrder[i]->incl,
+			   100.0*edgeOrder[i]->incl/total, (unsigned long long)edgeOrder[i]->calls,
+			   func_name(edgeOrder[i]->caller), func_name(edgeOrder[i]->callee));
+	}
+
+	// Source lines by cycles
+	if (haveDbg)
+	{
+		for (i = 0; i < dbg.lineCount; ++i)	order[i] = i;
+		qsort(order, dbg.lineCount, sizeof(int), compare_lines);
+
+		printf("\n%12s %6s  %s\n", "cycles", "%", "source line");
+		for (i = 0; i < dbg.lineCount && i < top; ++i)
+		{
+			SourceLine *line = &dbg.lines[order[i]];
+			uint64_t c = lineCycles[phase][order[i]];
+			if (!c)	break;
+			printf("%12llu %5.1f%%  %s:%d\n", (unsigned long long)c, 100.0*c/total,
+				   line->file < dbg.fileCount && dbg.files[line->file] ? dbg.files[line->file] : "?",
+				   line->line);
+		}
+	}
+	printf("\n");
+
+	free(edgeOrder);
+	free(order);
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: nesprof -l labels [-g dbgfile] [-i script | -p padlog] [-w padlog] [-L level] [-n frames] [-t count] [rom]\n"
+		"Charges every cycle of a session to its routine and, with -g, its source line, per phase\n"
+		"  -l labels       ld65 label file\n"
+		"  -g dbgfile      ld65 debug file, adds the source line report\n"
+		"  -i script       pad input script (see tools/bench/session.txt)\n"
+		"  -p padlog       replay a pad log recorded by the game instead\n"
+		"  -w padlog       record the buttons of every pad poll into a pad log\n"
+		"  -L level        level the first cleared level goes on to, such as the first generated one\n"
+		"  -n frames       number of frames to run (default 3600)\n"
+		"  -t count        rows per report (default 15)\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	NesMachine *nes = &session.nes;
+	const char *romPath = DEFAULT_ROM, *scriptPath = NULL, *labelPath = NULL,
+			   *padLogPath = NULL, *padOutPath = NULL, *dbgPath = NULL;
+	unsigned long maxFrames = DEFAULT_FRAMES;
+	int top = DEFAULT_TOP, nextLevel = -1, i;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-i") && i + 1 < argc)			scriptPath = argv[++i];
+		else if (!strcmp(argv[i], "-p") && i + 1 < argc)	padLogPath = argv[++i];
+		else if (!strcmp(argv[i], "-w") && i + 1 < argc)	padOutPath = argv[++i];
+		else if (!strcmp(argv[i], "-L") && i + 1 < argc)	nextLevel = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)	maxFrames = strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "-l") && i + 1 < argc)	labelPath = argv[++i];
+		else if (!strcmp(argv[i], "-g") && i + 1 < argc)	dbgPath = argv[++i];
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)	top = atoi(argv[++i]);
+		else if (argv[i][0] == '-')							usage();
+		else												romPath = argv[i];
+	}
+	if (!labelPath)	usage();
+
+	if (session_open(&session, romPath, scriptPath, labelPath))	return 1;
+	if (padLogPath && session_replay_pads(&session, padLogPath))	return 1;
+	if (padOutPath && session_record_pads(&session))				return 1;
+	if (nextLevel >= 0 && session_next_level(&session, nextLevel))	return 1;
+	if (dbgPath)
+	{
+		if (dbg_load(&dbg, dbgPath))	return 1;
+		haveDbg = 1;
+	}
+
+	for (i = 0; i < PHASE_COUNT; ++i)
+	{
+		funcStats[i] = calloc(session.labels.count + 1, sizeof(FuncStats));
+		lineCycles[i] = calloc(haveDbg ? dbg.lineCount + 1 : 1, sizeof(uint64_t));
+	}
+
+	while (nes->frame < maxFrames)
+	{
+		uint16_t pc = nes->pc;
+		uint8_t op = nes_peek(nes, pc);
+		uint8_t sp = nes->s;
+		int nmiEntry = nes->nmiPending;
+		int inNmi = nes->nmiDepth > 0 || nmiEntry;
+		int phase = session.phase;
+		int func, newFrame;
+		unsigned cycles;
+
+		cycles = session_step(&session, &newFrame);
+		if (!cycles)	return 1;
+
+		phaseCycles[phase] += cycles;
+		if (newFrame)	++phaseFrames[phase];
+		if (inNmi)		nmiCycles += cycles;
+
+		if (nmiEntry)
+		{
+			// The 7 entry cycles belong to the handler
+			func = func_at(nes->pc);
+			if (func != NO_FUNC)	funcStats[phase][func].self += cycles;
+			else					unknownCycles[phase] += cycles;
+			push_frame(func, func_at(pc), sp, 1, phase);
+			continue;
+		}
+
+		func = func_at(pc);
+		if (func != NO_FUNC)	funcStats[phase][func].self += cycles;
+		else					unknownCycles[phase] += cycles;
+		if (haveDbg && dbg.lineAt[pc] >= 0)	lineCycles[phase][dbg.lineAt[pc]] += cycles;
+
+		if (op == 0x20)
+		{
+			// A jsr into a phase routine has already switched the phase, count the call there
+			push_frame(func_at(nes->pc), func, sp, inNmi, session.phase);
+		}
+		else if (op == 0x60 || op == 0x40)
+		{
+			pop_frames(phase);
+		}
+	}
+
+	for (i = 0; i < PHASE_COUNT; ++i)
+	{
+		if (phaseCycles[i])	report(i, top);
+	}
+
+	for (i = 0; i < PHASE_COUNT; ++i)
+	{
+		free(funcStats[i]);
+		free(lineCycles[i]);
+	}
+	if (haveDbg)	dbg_free(&dbg);
+	if (padOutPath && session_save_pads(&session, padOutPath))	return 1;
+	session_close(&session);
+	return 0;
+}
@@ -0,0 +1,399 @@
+/******************************************************************************
+*  @file       	nmicheck.c
+*  @brief      	Build-time check that the NMI finishes its PPU work in vblank
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Runs the ROM's own NMI handler in the headless machine with the
+*		worst case state: rendering on, a palette update pending and an
+*		update list queued for flushing
+*		> The handler is stopped when it reaches FamiToneUpdate; the cycle
+*		of its last PPU access, plus the worst NMI entry latency, must fit
+*		in the vblank window or the check fails
+*		> With -q, the budget and entry costs of the VRAM update queue are
+*		read from its header and the densest lists a frame can commit
+*		(all single writes, longest horizontal and vertical runs, many
+*		short runs) are built at a page boundary and flushed. Each must
+*		cost no more than the header says and fit in vblank
+*		> With -u, a constant update list in ROM is checked as it is
+*
+*		Usage: nmicheck -l labels [-q vramQueue.h] [-u label]... [-b budget] [rom]
+*			-q header	check the VRAM update queue limits in this header
+*			-u label	constant update list to check
+*			-b budget	cycles available (default the NTSC vblank)
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nesemu.h"
+#include "symbols.h"
+
+#define DEFAULT_ROM		"NESMaze.nes"
+#define MAX_LISTS		16
+#define MAX_LIST_SIZE	256
+#define MAX_CYCLES		100000
+
+// The NMI is taken after the current instruction: up to 7 more cycles (inc abs,x),
+// and the OAM DMA takes one more cycle when it starts on an odd cycle
+#define NMI_LATENCY		7
+#define DMA_ALIGN		1
+
+// Zero page variables of crt0.s set up for the worst case
+static const char *zpNames[] =
+{
+	"PPU_MASK_VAR", "PPU_CTRL_VAR", "PAL_UPDATE", "VRAM_UPDATE", "NAME_UPD_ENABLE",
+	"NAME_UPD_ADR", "PAL_BG_PTR", "PAL_SPR_PTR"
+};
+
+enum
+{
+	ZP_PPU_MASK_VAR = 0,
+	ZP_PPU_CTRL_VAR,
+	ZP_PAL_UPDATE,
+	ZP_VRAM_UPDATE,
+	ZP_NAME_UPD_ENABLE,
+	ZP_NAME_UPD_ADR,
+	ZP_PAL_BG_PTR,
+	ZP_PAL_SPR_PTR,
+	ZP_COUNT
+};
+
+// Synthetic lists go here: every (NAME_UPD_ADR),y read past the first crosses a page
+#define QUEUE_LIST_ADR	0x03ff
+
+// VRAM update queue limits, as defined in the queue header
+static const char *queueNames[] =
+{
+	"VRAM_QUEUE_BUDGET", "VQ_COST_SINGLE", "VQ_COST_RUN", "VQ_COST_RUN_BYTE"
+};
+
+enum
+{
+	Q_BUDGET = 0,
+	Q_SINGLE,
+	Q_RUN,
+	Q_RUN_BYTE,
+	Q_COUNT
+};
+
+static uint64_t lastPpuWrite;
+
+static void io_hook(NesMachine *nes, uint16_t adr, uint8_t value)
+{
+	(void)value;
+	if (adr < 0x4000 || adr == 0x4014)	lastPpuWrite = nes->cycles;
+}
+
+// Walks the list the way _flush_vram_update_nmi does; returns its size in bytes, 0 if unterminated
+static int list_shape(NesMachine *nes, uint16_t adr, int *writes, int *runs, int *runBytes)
+{
+	int i = 0;
+
+	*writes = *runs = *runBytes = 0;
+	while (i < MAX_LIST_SIZE)
+	{
+		uint8_t b = nes_peek(nes, adr + i);
+
+		if (b == 0xff)	return i + 1;
+		if (b < 0x40)
+		{
+			++*writes;
+			i += 3;
+		}
+		else
+		{
+			uint8_t len = nes_peek(nes, adr + i + 2);
+			++*runs;
+			*runBytes += len ? len : 256;
+			i += 3 + (len ? len : 256);
+		}
+	}
+	return 0;
+}
+
+// Runs one NMI with the list queued; returns the cycles up to the last PPU access, or -1
+static int run_nmi(NesMachine *nes, const int *zp, uint16_t list, int famitone, int flush,
+				   unsigned *flushCycles)
+{
+	uint64_t start, flushStart = 0;
+	uint8_t flushSp = 0;
+	int inFlush = 0;
+
+	nes_reset(nes);
+	nes->ioHook = io_hook;
+	nes_poke(nes, zp[ZP_PPU_MASK_VAR], 0x1e);
+	nes_poke(nes, zp[ZP_PPU_CTRL_VAR], 0x80);
+	nes_poke(nes, zp[ZP_PAL_UPDATE], 1);
+	nes_poke(nes, zp[ZP_VRAM_UPDATE], 1);
+	nes_poke(nes, zp[ZP_NAME_UPD_ENABLE], 1);
+	nes_poke(nes, zp[ZP_NAME_UPD_ADR], list & 0xff);
+	nes_poke(nes, zp[ZP_NAME_UPD_ADR] + 1, list >> 8);
+	// Palette contents do not matter, only the upload
+	nes_poke(nes, zp[ZP_PAL_BG_PTR], list & 0xff);
+	nes_poke(nes, zp[ZP_PAL_BG_PTR] + 1, list >> 8);
+	nes_poke(nes, zp[ZP_PAL_SPR_PTR], list & 0xff);
+	nes_poke(nes, zp[ZP_PAL_SPR_PTR] + 1, list >> 8);
+
+	start = lastPpuWrite = nes->cycles;
+	*flushCycles = 0;
+	nes->nmiPending = 1;
+	nes_step(nes);
+
+	while (nes->nmiDepth && nes->pc != famitone)
+	{
+		uint8_t op = nes_peek(nes, nes->pc);
+
+		if (nes->pc == flush && !inFlush)
+		{
+			inFlush = 1;
+			flushStart = nes->cycles;
+			flushSp = nes->s;
+		}
+		if (!nes_step(nes) || nes->cycles - start > MAX_CYCLES)	return -1;
+		if (inFlush && op == 0x60 && nes->s > flushSp)
+		{
+			inFlush = 0;
+			*flushCycles = (unsigned)(nes->cycles - flushStart);
+		}
+	}
+	return (int)(lastPpuWrite - start);
+}
+
+// Reads the queue limits from the header; returns 0 on success
+static int load_queue_limits(const char *path, int *limits)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	int found = 0, i;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		char define[64];
+		int value;
+
+		if (sscanf(line, " #define %63s %i", define, &value) != 2)	continue;
+		for (i = 0; i < Q_COUNT; ++i)
+		{
+			if (!strcmp(define, queueNames[i]))
+			{
+				limits[i] = value;
+				found |= 1 << i;
+			}
+		}
+	}
+	fclose(f);
+
+	for (i = 0; i < Q_COUNT; ++i)
+	{
+		if (!(found & (1 << i)))
+		{
+			fprintf(stderr, "%s: %s is not defined\n", path, queueNames[i]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Writes count entries of runLen bytes (0 for single writes) to the list in RAM; returns the modeled cost
+static int build_queue_list(NesMachine *nes, const int *limits, int count, int runLen, int dir)
+{
+	uint16_t adr = QUEUE_LIST_ADR;
+	int cost = 0, i, j;
+
+	for (i = 0; i < count; ++i)
+	{
+		if (!runLen)
+		{
+			nes_poke(nes, adr++, 0x20);
+			nes_poke(nes, adr++, 0x00);
+			nes_poke(nes, adr++, 0x44);
+			cost += limits[Q_SINGLE];
+		}
+		else
+		{
+			nes_poke(nes, adr++, 0x20 | dir);
+			nes_poke(nes, adr++, 0x00);
+			nes_poke(nes, adr++, runLen);
+			for (j = 0; j < runLen; ++j)	nes_poke(nes, adr++, 0x44);
+			cost += limits[Q_RUN] + runLen*limits[Q_RUN_BYTE];
+		}
+	}
+	nes_poke(nes, adr, 0xff);
+	return cost;
+}
+
+// Flushes the densest lists the queue can commit in one frame; returns the number of failures
+static int check_queue(NesMachine *nes, const int *zp, int famitone, int flush, const int *limits, int budget)
+{
+	int maxRun = (limits[Q_BUDGET] - limits[Q_RUN])/limits[Q_RUN_BYTE];
+	int shortRuns = limits[Q_BUDGET]/(limits[Q_RUN] + limits[Q_RUN_BYTE]);
+	struct
+	{
+		const char *name;
+		int count, runLen, dir;
+	} cases[] =
+	{
+		{ "single write(s)",		limits[Q_BUDGET]/limits[Q_SINGLE], 0, 0 },
+		{ "horizontal run(s)",		1, maxRun, 0x40 },
+		{ "vertical run(s)",		1, maxRun, 0x80 },
+		{ "1-tile run(s)",		shortRuns, 1, 0x80 }
+	};
+	unsigned emptyCycles, flushCycles;
+	int failed = 0, i;
+
+	// Cost of an empty list (end marker and return), which the entry costs do not include
+	build_queue_list(nes, limits, 0, 0, 0);
+	if (run_nmi(nes, zp, QUEUE_LIST_ADR, famitone, flush, &emptyCycles) < 0)	return 1;
+
+	for (i = 0; i < (int)(sizeof(cases)/sizeof(cases[0])); ++i)
+	{
+		int model = build_queue_list(nes, limits, cases[i].count, cases[i].runLen, cases[i].dir);
+		int done = run_nmi(nes, zp, QUEUE_LIST_ADR, famitone, flush, &flushCycles);
+		int actual = (int)flushCycles - (int)emptyCycles;
+		char name[64];
+
+		if (done < 0)
+		{
+			fprintf(stderr, "queue: the NMI handler did not finish\n");
+			return failed + 1;
+		}
+		done += NMI_LATENCY + DMA_ALIGN;
+
+		snprintf(name, sizeof(name), "queue: %d %s", cases[i].count, cases[i].name);
+		printf("%-28s %6d %8u %8d %8d  ", name, cases[i].count*(3 + cases[i].runLen) + 1,
+			   flushCycles, model, done);
+		if (flush < 0)
+		{
+			printf("no _flush_vram_update_nmi label, entry costs not checked\n");
+		}
+		else if (actual > model)
+		{
+			printf("entries cost %d, more than the header says\n", actual);
+			++failed;
+			continue;
+		}
+		if (done > budget)
+		{
+			printf("OVER BUDGET by %d cycles\n", done - budget);
+			++failed;
+		}
+		else if (flush >= 0)
+		{
+			printf("ok\n");
+		}
+	}
+	return failed;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: nmicheck -l labels [-q vramQueue.h] [-u label]... [-b budget] [rom]\n"
+		"Runs the NMI handler on the densest update lists and fails when its PPU work overruns vblank\n"
+		"  -l labels       ld65 label file\n"
+		"  -q header       check the VRAM update queue limits in this header\n"
+		"  -u label        constant update list to check\n"
+		"  -b budget       cycles available (default the NTSC vblank)\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	static NesMachine nes;
+	SymbolTable labels;
+	const char *romPath = DEFAULT_ROM, *labelPath = NULL, *queuePath = NULL;
+	const char *lists[MAX_LISTS];
+	int listCount = 0, budget = NES_CYCLES_PER_VBLANK, failed = 0, i;
+	int zp[ZP_COUNT], limits[Q_COUNT], famitone, flush;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-l") && i + 1 < argc)								labelPath = argv[++i];
+		else if (!strcmp(argv[i], "-u") && i + 1 < argc && listCount < MAX_LISTS)	lists[listCount++] = argv[++i];
+		else if (!strcmp(argv[i], "-q") && i + 1 < argc)						queuePath = argv[++i];
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc)						budget = atoi(argv[++i]);
+		else if (argv[i][0] == '-')												usage();
+		else																	romPath = argv[i];
+	}
+	if (!labelPath || (!listCount && !queuePath))	usage();
+	if (queuePath && load_queue_limits(queuePath, limits))	return 1;
+
+	if (nes_load(&nes, romPath))	return 1;
+	if (sym_load_labels(&labels, labelPath))	return 1;
+
+	for (i = 0; i < ZP_COUNT; ++i)
+	{
+		zp[i] = sym_find(&labels, zpNames[i]);
+		if (zp[i] < 0)
+		{
+			fprintf(stderr, "%s: no label %s (assemble crt0.s with -g)\n", labelPath, zpNames[i]);
+			return 1;
+		}
+	}
+	famitone = sym_find(&labels, "FamiToneUpdate");
+	flush = sym_find(&labels, "_flush_vram_update_nmi");
+
+	printf("NMI PPU work against a %d cycle vblank (%d cycles entry latency included)\n\n",
+		   budget, NMI_LATENCY + DMA_ALIGN);
+	if (queuePath)
+	{
+		printf("%-28s %6s %8s %8s %8s\n", "update list", "bytes", "flush", "modeled", "ppu done");
+		failed |= check_queue(&nes, zp, famitone, flush, limits, budget) != 0;
+		if (listCount)	printf("\n");
+	}
+	if (listCount)
+	{
+		printf("%-20s %6s %6s %5s %5s %8s %8s\n",
+			   "update list", "bytes", "writes", "runs", "tiles", "flush", "ppu done");
+	}
+
+	for (i = 0; i < listCount; ++i)
+	{
+		int adr = sym_find(&labels, lists[i]);
+		int size, writes, runs, runBytes, done;
+		unsigned flushCycles;
+
+		if (adr < 0)
+		{
+			fprintf(stderr, "%s: no label %s\n", labelPath, lists[i]);
+			failed = 1;
+			continue;
+		}
+		size = list_shape(&nes, (uint16_t)adr, &writes, &runs, &runBytes);
+		if (!size)
+		{
+			fprintf(stderr, "%s: no NT_UPD_EOF within %d bytes\n", lists[i], MAX_LIST_SIZE);
+			failed = 1;
+			continue;
+		}
+
+		done = run_nmi(&nes, zp, (uint16_t)adr, famitone, flush, &flushCycles);
+		if (done < 0)
+		{
+			fprintf(stderr, "%s: the NMI handler did not finish\n", lists[i]);
+			failed = 1;
+			continue;
+		}
+		done += NMI_LATENCY + DMA_ALIGN;
+
+		printf("%-20s %6d %6d %5d %5d %8u %8d  %s", lists[i], size, writes, runs, writes + runBytes,
+			   flushCycles, done, done <= budget ? "ok" : "OVER BUDGET");
+		if (done > budget)
+		{
+			printf(" by %d cycles", done - budget);
+			failed = 1;
+		}
+		printf("\n");
+	}
+
+	sym_free(&labels);
+	nes_free(&nes);
+	return failed;
+}
@@ -0,0 +1,498 @@
+/******************************************************************************
+*  @file       	screenpack.c
+*  @brief      	Compresses NES Screen Tool screens for vram_unlz
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Reads the NameTable and AttrTable of each .nss file (1024 bytes,
+*		as vram_unlz writes them from NAMETABLE_A) and writes one C array
+*		per screen, named after the file, in the SCREENS segment
+*		> The format is LZ with runs, made for a decoder that writes
+*		straight to PPU_DATA with no output buffer: a copy does not read
+*		back what was decoded but takes bytes from earlier in the
+*		compressed screen itself, so the bytes it copies are in ROM.
+*		Tokens:
+*			$00			end of the screen
+*			$01-$3f		that many literal bytes follow ($40-$7f unused)
+*			$80			run: count (0-255, 0 writes nothing) and the byte
+*						follow
+*			$81-$bf		run of 1-63, the byte follows
+*			$c3-$ff		copy of 3-63 bytes (token-$c0): one distance byte
+*						follows, and the bytes are copied from that many
+*						bytes before the distance byte ($c0-$c2 unused)
+*		> A copy only reaches back as far as the decoder's read window:
+*		at least WINDOW_SLIDE (64) bytes
+*		> Parsing is greedy with one byte of lookahead. Every screen is
+*		decoded again and compared before it is written
+*		> With -b, each screen is also packed as the RLE of vram_unrle
+*		(as NES Screen Tool exports it), and the size and the decode
+*		cycles of both are listed. Cycles are counted per path through
+*		the two routines in neslib.s, with the arrays one after the other
+*		from the address given by -a (a page crossing costs a cycle)
+*
+*		Usage: screenpack [-o output.h] [-b] [-a address] screen.nss...
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_SIZE		960
+#define ATTR_SIZE		64
+#define SCREEN_SIZE		(NAME_SIZE + ATTR_SIZE)
+// Worst case: all literals, a token per LITERAL_MAX bytes, and the end token
+#define MAX_PACKED		(SCREEN_SIZE + SCREEN_SIZE/LITERAL_MAX + 2)
+
+#define LITERAL_MAX		63
+#define RUN_SHORT_MAX	63
+#define RUN_MAX			255
+#define COPY_MIN		3
+#define COPY_MAX		63
+
+#define TOKEN_RUN		0x80
+#define TOKEN_COPY		0xc0
+
+// The decoder reads with (ptr),y; before a token y is below WINDOW_SLIDE*2, and past
+//	that the pointer moves on WINDOW_SLIDE bytes, so a copy reaches at least that far back
+#define WINDOW_SLIDE	64
+
+// NTSC CPU cycles per frame
+#define FRAME_CYCLES	29781
+
+// A screen and its packed forms
+typedef struct
+{
+	const char *path;
+	char name[64];
+	unsigned char data[SCREEN_SIZE];
+	unsigned char packed[MAX_PACKED];
+	int size;
+} Screen;
+
+// Expands an NES Screen Tool RLE text field ("00[48]d4[2]..." where [n] means the
+// previous byte appears n times in total); returns the number of bytes written
+static int expand_field(const char *text, unsigned char *out, int size)
+{
+	int n = 0;
+
+	while (*text && *text != '\n' && *text != '\r')
+	{
+		if (*text == '[')
+		{
+			int count = (int)strtol(text + 1, (char **)&text, 16);
+			if (*text != ']' || !n)	return -1;
+			++text;
+			while (--count > 0 && n < size)
+			{
+				out[n] = out[n - 1];
+				++n;
+			}
+		}
+		else
+		{
+			char hex[3] = { text[0], text[1], 0 };
+			if (!text[1] || n == size)	return -1;
+			out[n++] = (unsigned char)strtol(hex, NULL, 16);
+			text += 2;
+		}
+	}
+	return n;
+}
+
+// Reads the NameTable and AttrTable fields of a .nss file into one nametable
+static int load_screen(const char *path, unsigned char *data)
+{
+	FILE *f = fopen(path, "r");
+	static char line[16384];
+	int nameSize = -1, attrSize = -1;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		if (!strncmp(line, "NameTable=", 10))		nameSize = expand_field(line + 10, data, NAME_SIZE);
+		else if (!strncmp(line, "AttrTable=", 10))	attrSize = expand_field(line + 10, data + NAME_SIZE, ATTR_SIZE);
+	}
+	fclose(f);
+
+	if (nameSize != NAME_SIZE)
+	{
+		fprintf(stderr, "%s: no %d byte NameTable\n", path, NAME_SIZE);
+		return 1;
+	}
+	if (attrSize != ATTR_SIZE)
+	{
+		fprintf(stderr, "%s: no %d byte AttrTable\n", path, ATTR_SIZE);
+		return 1;
+	}
+	return 0;
+}
+
+// Array name from the file name: graphics/title.nss -> title
+static void screen_name(Screen *screen)
+{
+	const char *base = strrchr(screen->path, '/');
+	char *dot;
+
+	base = base ? base + 1 : screen->path;
+	snprintf(screen->name, sizeof(screen->name), "%s", base);
+	dot = strrchr(screen->name, '.');
+	if (dot)	*dot = 0;
+}
+
+// Length of the run of equal bytes at pos, up to RUN_MAX
+static int run_length(const unsigned char *data, int pos)
+{
+	int n = 1;
+
+	while (pos + n < SCREEN_SIZE && n < RUN_MAX && data[pos + n] == data[pos])	++n;
+	return n;
+}
+
+// Start of the decoder's window once the tokens up to end are read
+static int window_slide(int window, int end)
+{
+	return end - window >= WINDOW_SLIDE*2 ? window + WINDOW_SLIDE : window;
+}
+
+// Longest copy of the bytes at pos from packed bytes between window and packedSize,
+//	where the copy token would go; returns its length and sets *from to its offset
+static int copy_length(const unsigned char *data, int pos, const unsigned char *packed, int packedSize,
+					   int window, int *from)
+{
+	int best = 0, start, n;
+
+	for (start = window; start < packedSize; ++start)
+	{
+		for (n = 0; n < COPY_MAX && pos + n < SCREEN_SIZE && start + n < packedSize; ++n)
+		{
+			if (packed[start + n] != data[pos + n])	break;
+		}
+		if (n > best)
+		{
+			best = n;
+			*from = start;
+		}
+	}
+	return best;
+}
+
+// Bytes saved by the best token at pos (0 for a literal); sets the token's kind
+//	(0 literal, 1 run, 2 copy), length and copy offset
+static int best_token(const unsigned char *data, int pos, const unsigned char *packed, int packedSize,
+					  int window, int *kind, int *length, int *from)
+{
+	int run = run_length(data, pos);
+	int copy = copy_length(data, pos, packed, packedSize, window, from);
+	int runGain = run - (run > RUN_SHORT_MAX ? 3 : 2);
+	int copyGain = copy >= COPY_MIN ? copy - 2 : 0;
+
+	*kind = 0;
+	*length = 1;
+	if (runGain > 0 && runGain >= copyGain)
+	{
+		*kind = 1;
+		*length = run;
+		return runGain;
+	}
+	if (copyGain > 0)
+	{
+		*kind = 2;
+		*length = copy;
+		return copyGain;
+	}
+	return 0;
+}
+
+// Packs a screen; returns the packed size
+static int pack_screen(const unsigned char *data, unsigned char *packed)
+{
+	int size = 0, pos = 0, literal = -1, window = 0, kind, length, from, gain;
+	int nextKind, nextLength, nextFrom;
+
+	while (pos < SCREEN_SIZE)
+	{
+		// Window of a token that goes here, after any open literal
+		int tokenWindow = literal < 0 ? window : window_slide(window, size);
+
+		gain = best_token(data, pos, packed, size, tokenWindow, &kind, &length, &from);
+
+		// A literal here is better when the next byte starts a token that saves more
+		if (kind && pos + 1 < SCREEN_SIZE &&
+			best_token(data, pos + 1, packed, size, tokenWindow, &nextKind, &nextLength, &nextFrom) > gain + 1)
+		{
+			kind = 0;
+		}
+
+		if (!kind)
+		{
+			if (literal >= 0 && packed[literal] == LITERAL_MAX)
+			{
+				window = window_slide(window, size);
+				literal = -1;
+			}
+			if (literal < 0)
+			{
+				literal = size;
+				packed[size++] = 0;
+			}
+			++packed[literal];
+			packed[size++] = data[pos++];
+			continue;
+		}
+		literal = -1;
+		window = tokenWindow;
+
+		if (kind == 1)
+		{
+			if (length > RUN_SHORT_MAX)
+			{
+				packed[size++] = TOKEN_RUN;
+				packed[size++] = (unsigned char)length;
+			}
+			else
+			{
+				packed[size++] = (unsigned char)(TOKEN_RUN + length);
+			}
+			packed[size++] = data[pos];
+		}
+		else
+		{
+			// Distance back from the distance byte
+			packed[size++] = (unsigned char)(TOKEN_COPY + length);
+			packed[size] = (unsigned char)(size - from);
+			++size;
+		}
+		pos += length;
+		window = window_slide(window, size);
+	}
+	packed[size++] = 0;
+	return size;
+}
+
+// lda (ptr),y with ptr at window: adds its cycles and returns the byte at window+y
+static int read_byte(const unsigned char *packed, int address, int window, int y, long *cycles)
+{
+	*cycles += 5 + (((address + window) & 0xff) + y > 0xff);
+	return packed[window + y];
+}
+
+// Decodes a packed screen as vram_unlz does; returns the cycles it takes with the array
+//	at address, or -1 when it does not give back data
+static long unpack_screen(const unsigned char *packed, int size, const unsigned char *data, int address)
+{
+	unsigned char out[SCREEN_SIZE];
+	int window = 0, y = 0, n = 0, token, count, from, i;
+	// Entry: sta stx ldy
+	long cycles = 8;
+
+	while (window + y < size)
+	{
+		token = read_byte(packed, address, window, y, &cycles);
+		if (!token)
+		{
+			// bmi beq rts
+			cycles += 2 + 3 + 6;
+			break;
+		}
+
+		if (token < TOKEN_RUN)
+		{
+			// bmi beq iny tax, 16 per byte (lda sta iny dex bne)
+			if (token > LITERAL_MAX || window + y + 1 + token > size || n + token > SCREEN_SIZE)	return -1;
+			cycles += 8 + 11*token - 1;
+			++y;
+			for (i = 0; i < token; ++i)	out[n++] = (unsigned char)read_byte(packed, address, window, y++, &cycles);
+		}
+		else if (token < TOKEN_COPY)
+		{
+			// bmi iny cmp bcs and bne
+			cycles += 3 + 2 + 2 + 2 + 2 + 3;
+			++y;
+			count = token - TOKEN_RUN;
+			if (!count)
+			{
+				// bne not taken, lda iny
+				cycles += -1 + 2;
+				count = read_byte(packed, address, window, y++, &cycles);
+			}
+			if (window + y >= size || n + count > SCREEN_SIZE)	return -1;
+			// sta lda iny, lsr and the odd byte, lsr and the odd pair, ldx beq, and
+			//	21 per 4 bytes (sta sta sta sta dex bne) then beq
+			cycles += 3 + 2;
+			token = read_byte(packed, address, window, y++, &cycles);
+			for (i = 0; i < count; ++i)	out[n++] = (unsigned char)token;
+			cycles += 5 + (count & 1 ? 6 : 3) + 5 + (count & 2 ? 10 : 3) + 3;
+			cycles += count >> 2 ? 2 + 21*(count >> 2) - 1 + 3 : 3;
+		}
+		else
+		{
+			// bmi iny cmp bcs, and tax tya sbc iny sty tay, 16 per byte, ldy bne
+			count = token - TOKEN_COPY;
+			if (count < COPY_MIN || window + y + 2 > size)	return -1;
+			cycles += 3 + 2 + 2 + 3 + 6;
+			++y;
+			from = y - read_byte(packed, address, window, y, &cycles);
+			cycles += 2 + 3 + 2;
+			++y;
+			if (from < 0 || from + count > y - 2 || n + count > SCREEN_SIZE)	return -1;
+			cycles += 11*count - 1 + 6;
+			for (i = 0; i < count; ++i)	out[n++] = (unsigned char)read_byte(packed, address, window, from + i, &cycles);
+		}
+
+		// cpy bcc, or the window slide (tya sbc tay lda adc sta bcc, inc bcs on a carry)
+		if (y < WINDOW_SLIDE*2)
+		{
+			cycles += 5;
+		}
+		else
+		{
+			cycles += 21;
+			if (((address + window) & 0xff) + WINDOW_SLIDE > 0xff)	cycles += 7;
+			window += WINDOW_SLIDE;
+			y -= WINDOW_SLIDE;
+		}
+	}
+	if (n != SCREEN_SIZE || memcmp(out, data, SCREEN_SIZE))	return -1;
+	return cycles;
+}
+
+// Packs a screen as NES Screen Tool RLE for vram_unrle: the first byte is a tag value
+//	the screen does not use, then the bytes, where tag,n repeats the byte before n more
+//	times and tag,0 ends. Returns the packed size and the decode cycles
+static int pack_rle(const unsigned char *data, int address, long *cycles)
+{
+	int used[256] = { 0 }, tag, pos, size, run;
+
+	for (pos = 0; pos < SCREEN_SIZE; ++pos)	used[data[pos]] = 1;
+	for (tag = 0; tag < 256 && used[tag]; ++tag);
+	if (tag == 256)	return -1;
+
+	// Entry (tay stx lda sta), the tag (lda sta iny bne); every byte read after is
+	//	lda iny bne, and inc when the index wraps
+	size = 1;
+	*cycles = 10 + 13;
+	for (pos = 0; pos < SCREEN_SIZE; pos += run)
+	{
+		run = run_length(data, pos);
+		if (run > 256)	run = 256;
+
+		// The byte: cmp beq sta sta bne
+		size += 1;
+		*cycles += 10 + 15;
+		if (run == 2)
+		{
+			size += 1;
+			*cycles += 10 + 15;
+		}
+		else if (run > 2)
+		{
+			// tag,n: cmp beq, lda beq iny bne tax lda, 9 per byte, beq
+			size += 2;
+			*cycles += 10 + 6 + 5 + 2 + 2 + 3 + 2 + 3 + 9*(run - 1) - 1 + 3;
+		}
+	}
+	// tag,0: cmp beq, lda beq rts
+	size += 2;
+	*cycles += 10 + 6 + 5 + 3 + 6;
+	*cycles += 4*(((address & 0xff) + size)/256);
+	return size;
+}
+
+// Writes a screen array
+static void write_screen(FILE *out, const Screen *screen)
+{
+	int i;
+
+	fprintf(out, "const unsigned char %s[%d]={\n", screen->name, screen->size);
+	for (i = 0; i < screen->size; ++i)
+	{
+		fprintf(out, "0x%02x%s", screen->packed[i], i == screen->size - 1 ? "\n" : (i & 15) == 15 ? ",\n" : ",");
+	}
+	fprintf(out, "};\n\n");
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: screenpack [-o output.h] [-b] [-a address] screen.nss...\n"
+		"Packs NES Screen Tool screens as LZ for vram_unlz\n"
+		"  -o output.h     header to write\n"
+		"  -b              list the size and decode cycles of LZ and RLE for every screen\n"
+		"  -a address      address of the first array, for the page crossings of -b\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char *outPath = NULL;
+	Screen *screens = calloc(argc, sizeof(Screen));
+	int screenCount = 0, bench = 0, address = 0, errors = 0, i;
+	long lzCycles, rleCycles, lzTotal = 0, rleTotal = 0;
+	int rleSize, lzBytes = 0, rleBytes = 0;
+	FILE *out;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-o") && i + 1 < argc)			outPath = argv[++i];
+		else if (!strcmp(argv[i], "-b"))					bench = 1;
+		else if (!strcmp(argv[i], "-a") && i + 1 < argc)	address = (int)strtol(argv[++i], NULL, 0);
+		else if (argv[i][0] == '-')							usage();
+		else												screens[screenCount++].path = argv[i];
+	}
+	if ((!outPath && !bench) || !screenCount)	usage();
+
+	for (i = 0; i < screenCount; ++i)
+	{
+		Screen *screen = &screens[i];
+
+		screen_name(screen);
+		if (load_screen(screen->path, screen->data))
+		{
+			++errors;
+			continue;
+		}
+		screen->size = pack_screen(screen->data, screen->packed);
+		if (unpack_screen(screen->packed, screen->size, screen->data, 0) < 0)
+		{
+			fprintf(stderr, "%s: packed screen does not decode back\n", screen->path);
+			++errors;
+		}
+	}
+	if (errors)	return 1;
+
+	if (bench)
+	{
+		printf("%-20s %10s %10s %12s %12s\n", "screen", "rle bytes", "lz bytes", "rle cycles", "lz cycles");
+		for (i = 0; i < screenCount; ++i)
+		{
+			rleSize = pack_rle(screens[i].data, address + rleBytes, &rleCycles);
+			lzCycles = unpack_screen(screens[i].packed, screens[i].size, screens[i].data, address + lzBytes);
+			printf("%-20s %10d %10d %12ld %12ld\n", screens[i].name, rleSize, screens[i].size, rleCycles, lzCycles);
+			rleBytes += rleSize;
+			lzBytes += screens[i].size;
+			rleTotal += rleCycles;
+			lzTotal += lzCycles;
+		}
+		printf("%-20s %10d %10d %12ld %12ld\n", "total", rleBytes, lzBytes, rleTotal, lzTotal);
+		printf("decode time: rle %.2f frames, lz %.2f frames (NTSC)\n",
+			   (double)rleTotal/FRAME_CYCLES, (double)lzTotal/FRAME_CYCLES);
+	}
+
+	if (!outPath)	return 0;
+	out = fopen(outPath, "w");
+	if (!out)
+	{
+		fprintf(stderr, "%s: cannot create\n", outPath);
+		return 1;
+	}
+	fprintf(out, "// Generated by tools/screenpack.c, do not edit\n\n");
+	fprintf(out, "#pragma rodata-name (push,\"SCREENS\")\n\n");
+	for (i = 0; i < screenCount; ++i)	write_screen(out, &screens[i]);
+	fprintf(out, "#pragma rodata-name (pop)\n");
+	fclose(out);
+	return 0;
+}
@@ -0,0 +1,300 @@
+/******************************************************************************
+*  @file       	session.c
+*  @brief      	Scripted play session shared by the measuring tools
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Pad script format: "<frame> <buttons>" per line, the buttons are
+*		held from that frame until the next line. Buttons are A B SELECT
+*		START UP DOWN LEFT RIGHT joined with '+', '-' releases all, '#'
+*		starts a comment
+*		> Pad log format: see session.h and src/inputLog.h
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "session.h"
+
+const char *phaseNames[PHASE_COUNT] = { "boot", "titlePhase", "gamePhase", "resultPhase" };
+
+static const char *phaseLabels[PHASE_COUNT] = { NULL, "_titlePhase", "_gamePhase", "_resultPhase" };
+
+static uint8_t parse_buttons(const char *text, const char *path, int lineNum)
+{
+	static const char *names[8] = { "A", "B", "SELECT", "START", "UP", "DOWN", "LEFT", "RIGHT" };
+	char buf[128];
+	char *tok;
+	uint8_t buttons = 0;
+	int i;
+
+	strncpy(buf, text, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = 0;
+
+	for (tok = strtok(buf, " \t+\r\n"); tok; tok = strtok(NULL, " \t+\r\n"))
+	{
+		if (!strcmp(tok, "-"))	continue;
+		if (tok[0] == '#')		break;
+		for (i = 0; i < 8; ++i)
+		{
+			if (!strcmp(tok, names[i]))
+			{
+				buttons |= 1 << i;
+				break;
+			}
+		}
+		if (i == 8)	fprintf(stderr, "%s:%d: unknown button '%s'\n", path, lineNum, tok);
+	}
+	return buttons;
+}
+
+static int load_script(Session *session, const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	int capacity = 0, lineNum = 0;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), f))
+	{
+		char *p = line, *end;
+		unsigned long frame;
+
+		++lineNum;
+		while (*p == ' ' || *p == '\t')	++p;
+		if (*p == '#' || *p == '\n' || *p == '\r' || !*p)	continue;
+
+		frame = strtoul(p, &end, 10);
+		if (end == p)
+		{
+			fprintf(stderr, "%s:%d: expected a frame number\n", path, lineNum);
+			continue;
+		}
+
+		if (session->eventCount == capacity)
+		{
+			capacity = capacity ? capacity*2 : 64;
+			session->events = realloc(session->events, capacity*sizeof(PadEvent));
+		}
+		session->events[session->eventCount].frame = frame;
+		session->events[session->eventCount].buttons = parse_buttons(end, path, lineNum);
+		++session->eventCount;
+	}
+
+	fclose(f);
+	return 0;
+}
+
+int session_open(Session *session, const char *rom, const char *script, const char *labels)
+{
+	int i;
+
+	memset(session, 0, sizeof(*session));
+	for (i = 0; i < PHASE_COUNT; ++i)	session->phaseAdr[i] = -1;
+	session->padPollAdr = -1;
+	session->prepareAdr = session->gameLevelAdr = session->nextLevel = -1;
+
+	if (nes_load(&session->nes, rom))				return 1;
+	if (script && load_script(session, script))		return 1;
+
+	if (labels)
+	{
+		if (sym_load_labels(&session->labels, labels))	return 1;
+		for (i = 1; i < PHASE_COUNT; ++i)
+		{
+			session->phaseAdr[i] = sym_find(&session->labels, phaseLabels[i]);
+			if (session->phaseAdr[i] < 0)	fprintf(stderr, "%s: no label %s\n", labels, phaseLabels[i]);
+		}
+		session->padPollAdr = sym_find(&session->labels, "_pad_poll");
+		session->prepareAdr = sym_find(&session->labels, "_prepareLevel");
+		session->gameLevelAdr = sym_find(&session->labels, "_gameLevel");
+	}
+
+	session->lastFrame = session->nes.frame;
+	return 0;
+}
+
+void session_close(Session *session)
+{
+	sym_free(&session->labels);
+	free(session->events);
+	session->events = NULL;
+	free(session->padLog);
+	session->padLog = NULL;
+	free(session->padOut);
+	session->padOut = NULL;
+	nes_free(&session->nes);
+}
+
+// Pad logs go by the polls, so they need to know where _pad_poll is
+static int need_pad_poll(Session *session)
+{
+	if (session->padPollAdr >= 0)	return 0;
+	fprintf(stderr, "pad logs need the label file with _pad_poll (-l)\n");
+	return 1;
+}
+
+int session_replay_pads(Session *session, const char *path)
+{
+	FILE *f;
+	long size;
+
+	if (need_pad_poll(session))	return 1;
+
+	f = fopen(path, "rb");
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	session->padLog = malloc(size > 0 ? size : 1);
+	session->padLogSize = (int)fread(session->padLog, 1, size, f);
+	fclose(f);
+
+	if (session->padLogSize < PAD_LOG_MAGIC_SIZE ||
+		memcmp(session->padLog, PAD_LOG_MAGIC, PAD_LOG_MAGIC_SIZE))
+	{
+		fprintf(stderr, "%s: not a pad log\n", path);
+		return 1;
+	}
+	session->padLogPos = PAD_LOG_MAGIC_SIZE;
+	session->padRun = 0;
+	return 0;
+}
+
+int session_record_pads(Session *session)
+{
+	if (need_pad_poll(session))	return 1;
+
+	session->padOutCapacity = 256;
+	session->padOut = malloc(session->padOutCapacity);
+	memcpy(session->padOut, PAD_LOG_MAGIC, PAD_LOG_MAGIC_SIZE);
+	session->padOutSize = PAD_LOG_MAGIC_SIZE;
+	return 0;
+}
+
+int session_save_pads(Session *session, const char *path)
+{
+	FILE *f = fopen(path, "wb");
+	static const uint8_t end = 0;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot create\n", path);
+		return 1;
+	}
+	fwrite(session->padOut, 1, session->padOutSize, f);
+	fwrite(&end, 1, 1, f);
+	fclose(f);
+	return 0;
+}
+
+int session_next_level(Session *session, int level)
+{
+	if (session->prepareAdr < 0 || session->gameLevelAdr < 0)
+	{
+		fprintf(stderr, "choosing the next level needs the label file with _prepareLevel and _gameLevel (-l)\n");
+		return 1;
+	}
+	session->nextLevel = level;
+	return 0;
+}
+
+// Sets the buttons for the _pad_poll call about to run, and records them
+static void poll_pads(Session *session)
+{
+	NesMachine *nes = &session->nes;
+	uint8_t *run;
+
+	if (session->padLog)
+	{
+		// Next run; after the last one, nothing is held
+		if (!session->padRun)
+		{
+			if (session->padLogPos + 1 < session->padLogSize && session->padLog[session->padLogPos])
+			{
+				session->padRun = session->padLog[session->padLogPos];
+				nes->pad[0] = session->padLog[session->padLogPos + 1];
+				session->padLogPos += 2;
+			}
+			else
+			{
+				nes->pad[0] = 0;
+			}
+		}
+		if (session->padRun)	--session->padRun;
+	}
+
+	if (!session->padOut)	return;
+	run = session->padOut + session->padOutSize - 2;
+	if (session->padOutSize > PAD_LOG_MAGIC_SIZE && run[1] == nes->pad[0] && run[0] < 255)
+	{
+		++run[0];
+		return;
+	}
+	if (session->padOutSize + 2 > session->padOutCapacity)
+	{
+		session->padOutCapacity *= 2;
+		session->padOut = realloc(session->padOut, session->padOutCapacity);
+	}
+	session->padOut[session->padOutSize++] = 1;
+	session->padOut[session->padOutSize++] = nes->pad[0];
+}
+
+unsigned session_step(Session *session, int *newFrame)
+{
+	NesMachine *nes = &session->nes;
+	uint16_t pc = nes->pc;
+	unsigned cycles;
+	int i;
+
+	// Track the current phase by the jsr from main() into it
+	if (nes_peek(nes, pc) == 0x20 && !nes->nmiPending && !nes->nmiDepth)
+	{
+		int target = nes_peek(nes, pc + 1) | (nes_peek(nes, pc + 2) << 8);
+		for (i = 1; i < PHASE_COUNT; ++i)
+		{
+			if (session->phaseAdr[i] == target)	session->phase = i;
+		}
+	}
+
+	if (pc == session->padPollAdr && !nes->nmiPending && (session->padLog || session->padOut))
+	{
+		poll_pads(session);
+	}
+
+	if (pc == session->prepareAdr && session->nextLevel >= 0 && !nes->nmiPending)
+	{
+		nes_poke(nes, (uint16_t)session->gameLevelAdr, (uint8_t)session->nextLevel);
+		session->nextLevel = -1;
+	}
+
+	cycles = nes_step(nes);
+	if (nes->jammed)
+	{
+		fprintf(stderr, "CPU jammed on opcode $%02x at $%04x, frame %llu\n",
+				nes_peek(nes, pc), pc, (unsigned long long)nes->frame);
+		return 0;
+	}
+
+	*newFrame = nes->frame != session->lastFrame;
+	if (*newFrame)
+	{
+		session->lastFrame = nes->frame;
+		while (!session->padLog && session->nextEvent < session->eventCount &&
+			   session->events[session->nextEvent].frame <= nes->frame)
+		{
+			nes->pad[0] = session->events[session->nextEvent++].buttons;
+		}
+	}
+	return cycles;
+}
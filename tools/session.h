@@ -0,0 +1,93 @@
+/******************************************************************************
+*  @file       	session.h
+*  @brief      	Scripted play session shared by the measuring tools
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Owns the headless machine, feeds it the pad script at every
+*		vblank and keeps track of the current game phase through the
+*		jsr from main() into titlePhase, gamePhase and resultPhase
+*		> Instead of the script, a pad log recorded by the game (see
+*		src/inputLog.h) can be replayed: the buttons are set at every
+*		_pad_poll call rather than at frames, so the session plays out
+*		the same on any build of the game. The buttons of every poll can
+*		also be recorded into a new pad log
+*		> The level cleared first can lead to any other, such as the first
+*		generated one (src/mazeGen.h), which the script could not reach:
+*		gameLevel is set as prepareLevel starts preparing the next level
+******************************************************************************/
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "nesemu.h"
+#include "symbols.h"
+
+// Game phases, entered through a jsr from main()
+enum
+{
+	PHASE_BOOT = 0,
+	PHASE_TITLE,
+	PHASE_GAME,
+	PHASE_RESULT,
+	PHASE_COUNT
+};
+
+extern const char *phaseNames[PHASE_COUNT];
+
+// One scripted pad change: from this frame on, hold these buttons
+typedef struct
+{
+	uint64_t frame;
+	uint8_t buttons;
+} PadEvent;
+
+typedef struct
+{
+	NesMachine nes;
+	SymbolTable labels;
+	PadEvent *events;
+	int eventCount;
+	int nextEvent;
+	int phaseAdr[PHASE_COUNT];
+	int phase;
+	uint64_t lastFrame;
+	// Pad log replayed or recorded at each _pad_poll call
+	int padPollAdr;
+	uint8_t *padLog;
+	int padLogSize;
+	int padLogPos;
+	int padRun;
+	uint8_t *padOut;
+	int padOutSize;
+	int padOutCapacity;
+	// Level the first cleared level goes on to (-1 the next one), set at _prepareLevel
+	int prepareAdr;
+	int gameLevelAdr;
+	int nextLevel;
+} Session;
+
+// Pad log format: PAD_LOG_MAGIC, then a byte of poll count (1-255) and a byte of
+//	buttons per run of polls, ended by a zero count or the end of the file
+#define PAD_LOG_MAGIC		"PL"
+#define PAD_LOG_MAGIC_SIZE	2
+
+// Loads the ROM, the optional pad script and the optional label file; returns 0 on success
+int session_open(Session *session, const char *rom, const char *script, const char *labels);
+void session_close(Session *session);
+
+// Replays the pad log in this file (a battery save of the game's log will do)
+//	in place of the script; needs the label file. Returns 0 on success
+int session_replay_pads(Session *session, const char *path);
+// Records the buttons of every poll from now on; session_save_pads writes them as a pad log
+int session_record_pads(Session *session);
+int session_save_pads(Session *session, const char *path);
+
+// Makes the first cleared level go on to this level; needs the label file. Returns 0 on success
+int session_next_level(Session *session, int level);
+
+// Executes one instruction; returns its cycles, or 0 when the CPU jammed
+// *newFrame is set when a vblank started during the instruction (the pad script is applied then)
+unsigned session_step(Session *session, int *newFrame);
+
+#endif
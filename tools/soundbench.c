@@ -0,0 +1,332 @@
+/******************************************************************************
+*  @file       	soundbench.c
+*  @brief      	Cycle benchmark of the FamiTone2 update per song and per effect
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Boots the ROM in the headless machine up to main (FamiToneInit
+*		and FamiToneSfxInit done), then turns NMIs off and calls
+*		FamiToneUpdate once per frame itself, counting the cycles of each
+*		call, jsr included
+*		> Every MUSIC_ id of the header plays for the given frames, alone
+*		and with the heaviest effect restarted on all FT_SFX_STREAMS
+*		streams. Every SFX_ id plays alone on stream 0 until the stream
+*		stops, that is until an update costs what an idle one does
+*		> The NMI's sound stage runs one update, which has to fit in the
+*		budget, by default what is left of the frame after a full vblank
+*		of PPU work and the longest sprite 0 split wait, or the NMI runs
+*		into the next one
+*
+*		Usage: soundbench -l labels [-s header] [-n frames] [-b budget] [-k bank] [rom]
+*			-s header	MUSIC_ and SFX_ ids (default src/soundsAndMusic/soundsAndMusic.h)
+*			-n frames	frames each song plays (default 1800)
+*			-b budget	cycles the NMI sound stage may take (default 23870)
+*			-k bank		bank holding the music data in an UNROM ROM (default 1)
+******************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nesemu.h"
+#include "symbols.h"
+
+#define DEFAULT_ROM		"NESMaze.nes"
+// Scanlines past vblank the NMI waits for the sprite 0 split before its sound stage at most
+//	(sprite 0 at Y 22, given up 10 lines later, neslib.s)
+#define HUD_LINES		32
+#define DEFAULT_HEADER	"src/soundsAndMusic/soundsAndMusic.h"
+#define DEFAULT_FRAMES	1800
+#define DEFAULT_BUDGET	(NES_CYCLES_PER_FRAME - NES_CYCLES_PER_VBLANK - HUD_LINES*NES_DOTS_PER_LINE/3)
+#define DEFAULT_BANK	1
+
+#define MAX_IDS			64
+#define MAX_CALL_CYCLES	100000
+#define MAX_BOOT_CYCLES	10000000
+#define MAX_SFX_FRAMES	1200
+
+// Effect streams and their FT_SFX_CH offsets, as set up in crt0.s
+#define SFX_STREAMS		4
+#define SFX_STRUCT_SIZE	15
+
+// The jsr into FamiToneUpdate, which the call below does not execute
+#define JSR_CYCLES		6
+
+typedef struct
+{
+	char name[64];
+	int id;
+} SoundId;
+
+// Cycles of a run of updates; the first one, which reads the first row of every channel of
+//	a song, is kept apart from the peak
+typedef struct
+{
+	unsigned frames;
+	uint64_t total;
+	unsigned first;
+	unsigned peak;
+} Cost;
+
+static unsigned cost_peak(const Cost *cost)
+{
+	return cost->first > cost->peak ? cost->first : cost->peak;
+}
+
+static struct
+{
+	int main, update, musicPlay, musicStop, sfxPlay;
+} labels;
+
+// Calls the routine at adr with the given registers; returns its cycles, or 0 if it never returned
+static unsigned call(NesMachine *nes, int adr, uint8_t a, uint8_t x)
+{
+	uint64_t start = nes->cycles;
+	uint16_t ret = (uint16_t)(labels.main - 1);
+	uint8_t s = nes->s;
+
+	// Return into main, whose first instruction is never executed here
+	nes_poke(nes, 0x100 + nes->s--, ret >> 8);
+	nes_poke(nes, 0x100 + nes->s--, ret & 0xff);
+	nes->a = a;
+	nes->x = x;
+	nes->pc = (uint16_t)adr;
+
+	while (nes->pc != labels.main || nes->s != s)
+	{
+		if (!nes_step(nes) || nes->cycles - start > MAX_CALL_CYCLES)	return 0;
+	}
+	return (unsigned)(nes->cycles - start);
+}
+
+static unsigned update(NesMachine *nes, Cost *cost)
+{
+	unsigned cycles = call(nes, labels.update, 0, 0);
+
+	if (!cycles)
+	{
+		fprintf(stderr, "FamiToneUpdate did not return\n");
+		exit(1);
+	}
+	cycles += JSR_CYCLES;
+	if (cost)
+	{
+		cost->total += cycles;
+		if (!cost->frames++)			cost->first = cycles;
+		else if (cycles > cost->peak)	cost->peak = cycles;
+	}
+	return cycles;
+}
+
+// Reads the MUSIC_ and SFX_ enums of the header; returns 0 on success
+static int load_ids(const char *path, SoundId *music, int *musicCount, SoundId *sfx, int *sfxCount)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	int next = 0;
+
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	*musicCount = *sfxCount = 0;
+	while (fgets(line, sizeof(line), f))
+	{
+		char name[64], *p = line;
+		int value;
+
+		while (isspace((unsigned char)*p))	++p;
+		if (!strncmp(p, "enum", 4))
+		{
+			next = 0;
+			continue;
+		}
+		if (sscanf(p, "%63[A-Za-z0-9_] = %i", name, &value) == 2)	next = value;
+		else if (sscanf(p, "%63[A-Za-z0-9_]", name) != 1)			continue;
+
+		if (!strncmp(name, "MUSIC_", 6) && *musicCount < MAX_IDS)
+		{
+			strcpy(music[*musicCount].name, name);
+			music[(*musicCount)++].id = next++;
+		}
+		else if (!strncmp(name, "SFX_", 4) && *sfxCount < MAX_IDS)
+		{
+			strcpy(sfx[*sfxCount].name, name);
+			sfx[(*sfxCount)++].id = next++;
+		}
+	}
+	fclose(f);
+
+	if (!*musicCount && !*sfxCount)
+	{
+		fprintf(stderr, "%s: no MUSIC_ or SFX_ ids\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+static int find_label(SymbolTable *table, const char *path, const char *name)
+{
+	int adr = sym_find(table, name);
+
+	if (adr < 0)
+	{
+		fprintf(stderr, "%s: no label %s\n", path, name);
+		exit(1);
+	}
+	return adr;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: soundbench -l labels [-s header] [-n frames] [-b budget] [-k bank] [rom]\n"
+		"Counts the FamiToneUpdate cycles of every song and effect and fails when the NMI sound stage overruns\n"
+		"  -l labels       ld65 label file\n"
+		"  -s header       MUSIC_ and SFX_ ids (default src/soundsAndMusic/soundsAndMusic.h)\n"
+		"  -n frames       frames each song plays (default 1800)\n"
+		"  -b budget       cycles the NMI sound stage may take (default 23870)\n"
+		"  -k bank         bank holding the music data in an UNROM ROM (default 1)\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	static NesMachine nes;
+	SymbolTable table;
+	const char *romPath = DEFAULT_ROM, *labelPath = NULL, *headerPath = DEFAULT_HEADER;
+	SoundId music[MAX_IDS], sfx[MAX_IDS];
+	int musicCount, sfxCount, frames = DEFAULT_FRAMES, budget = DEFAULT_BUDGET, bank = DEFAULT_BANK;
+	int heaviest = -1, worstSong = -1, i, j, k;
+	unsigned idle, sfxLength[MAX_IDS], heaviestPeak = 0, worst = 0;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-l") && i + 1 < argc)			labelPath = argv[++i];
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc)	headerPath = argv[++i];
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)	frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc)	budget = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-k") && i + 1 < argc)	bank = atoi(argv[++i]);
+		else if (argv[i][0] == '-')							usage();
+		else												romPath = argv[i];
+	}
+	if (!labelPath || frames <= 0)	usage();
+
+	if (load_ids(headerPath, music, &musicCount, sfx, &sfxCount))	return 1;
+	if (nes_load(&nes, romPath))	return 1;
+	if (sym_load_labels(&table, labelPath))	return 1;
+	labels.main = find_label(&table, labelPath, "_main");
+	labels.update = find_label(&table, labelPath, "FamiToneUpdate");
+	labels.musicPlay = find_label(&table, labelPath, "FamiToneMusicPlay");
+	labels.musicStop = find_label(&table, labelPath, "FamiToneMusicStop");
+	labels.sfxPlay = find_label(&table, labelPath, "FamiToneSfxPlay");
+
+	// Boot up to main, then keep the NMI out of the way
+	nes_reset(&nes);
+	while (nes.pc != labels.main)
+	{
+		if (!nes_step(&nes) || nes.cycles > MAX_BOOT_CYCLES)
+		{
+			fprintf(stderr, "%s: main never reached\n", romPath);
+			return 1;
+		}
+	}
+	nes.ppuCtrl &= 0x7f;
+	nes.nmiPending = 0;
+	if (nes.mapper == 2)	nes.prgBank = (uint8_t)bank;
+
+	// Nothing playing
+	call(&nes, labels.musicStop, 0, 0);
+	update(&nes, NULL);
+	idle = update(&nes, NULL);
+
+	printf("FamiToneUpdate cycles per call, jsr included (NTSC frame %d cycles, idle update %u)\n\n",
+		   NES_CYCLES_PER_FRAME, idle);
+
+	// Effects alone, on stream 0
+	if (sfxCount)	printf("%-20s %8s %8s %8s\n", "sfx", "frames", "avg", "peak");
+	for (i = 0; i < sfxCount; ++i)
+	{
+		Cost cost = { 0, 0, 0, 0 };
+
+		call(&nes, labels.sfxPlay, (uint8_t)sfx[i].id, 0);
+		while (cost.frames < MAX_SFX_FRAMES && update(&nes, &cost) != idle)
+			;
+		// The last update found the stream stopped
+		--cost.frames;
+		cost.total -= idle;
+		sfxLength[i] = cost.frames;
+		if (cost_peak(&cost) > heaviestPeak)
+		{
+			heaviestPeak = cost_peak(&cost);
+			heaviest = i;
+		}
+		printf("%-20s %8u %8u %8u%s\n", sfx[i].name, cost.frames,
+			   cost.frames ? (unsigned)(cost.total/cost.frames) : 0, cost_peak(&cost),
+			   cost.frames == MAX_SFX_FRAMES - 1 ? "  (never stopped)" : "");
+	}
+
+	// Songs, alone and under the heaviest effect on every stream
+	if (musicCount)
+	{
+		if (sfxCount)	printf("\n");
+		printf("%-20s %8s %8s %8s %8s %10s\n", "music", "frames", "avg", "first", "peak",
+			   heaviest < 0 ? "" : "+sfx peak");
+	}
+	for (i = 0; i < musicCount; ++i)
+	{
+		Cost alone = { 0, 0, 0, 0 }, mixed = { 0, 0, 0, 0 };
+
+		call(&nes, labels.musicPlay, (uint8_t)music[i].id, 0);
+		for (j = 0; j < frames; ++j)	update(&nes, &alone);
+
+		if (heaviest >= 0)
+		{
+			call(&nes, labels.musicPlay, (uint8_t)music[i].id, 0);
+			for (j = 0; j < frames; ++j)
+			{
+				if (!sfxLength[heaviest] || !(j % sfxLength[heaviest]))
+				{
+					for (k = 0; k < SFX_STREAMS; ++k)
+						call(&nes, labels.sfxPlay, (uint8_t)sfx[heaviest].id, (uint8_t)(k*SFX_STRUCT_SIZE));
+				}
+				update(&nes, &mixed);
+			}
+		}
+		if (cost_peak(&mixed) > worst || cost_peak(&alone) > worst)
+		{
+			worst = cost_peak(&mixed) > cost_peak(&alone) ? cost_peak(&mixed) : cost_peak(&alone);
+			worstSong = i;
+		}
+
+		printf("%-20s %8u %8u %8u %8u", music[i].name, alone.frames, (unsigned)(alone.total/alone.frames),
+			   alone.first, alone.peak);
+		if (heaviest >= 0)	printf(" %10u", cost_peak(&mixed));
+		printf("\n");
+		call(&nes, labels.musicStop, 0, 0);
+	}
+	if (heaviestPeak > worst)	worst = heaviestPeak;
+
+	printf("\nworst update %u cycles, %.1f%% of a frame", worst, worst*100.0/NES_CYCLES_PER_FRAME);
+	if (worstSong >= 0)
+	{
+		printf(" (%s", music[worstSong].name);
+		if (heaviest >= 0)	printf(" with %s on %d streams", sfx[heaviest].name, SFX_STREAMS);
+		printf(")");
+	}
+	printf(", NMI sound stage up to %u of %d cycles", worst, budget);
+	if (worst > (unsigned)budget)
+	{
+		printf("  OVER BUDGET by %u cycles\n", worst - budget);
+		sym_free(&table);
+		nes_free(&nes);
+		return 1;
+	}
+	printf("  ok\n");
+
+	sym_free(&table);
+	nes_free(&nes);
+	return 0;
+}
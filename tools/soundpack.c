@@ -0,0 +1,1631 @@
+/******************************************************************************
+*  @file       	soundpack.c
+*  @brief      	Converts FamiTracker modules to FamiTone2 music and sound effects
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Reads the binary .ftm of FamiTracker 0.4 (2A03 only) and writes
+*		the music.s that FamiToneInit takes, or with -e the sounds.s that
+*		FamiToneSfxInit takes, in place of the Windows text2data and
+*		nsf2data tools
+*		> Music: every track is a song, played in frame order up to the
+*		first Bxx that goes back (or the end, which loops to frame 0).
+*		Each channel is split into blocks of the same number of rows, and
+*		a block that repeats bytes already in the data, in any song or
+*		channel, becomes a FamiTone reference to them ($ff, events,
+*		address), taking as many following blocks along as still match.
+*		Every block size from 4 to 256 rows is tried and the smallest
+*		data wins. Only instruments that some note plays are kept, and
+*		identical envelopes are stored once. Channels that never play a
+*		note share one silent stream
+*		> FamiTone has no release, volume column or effects but Fxx
+*		speed, Bxx loop, Dxx and Cxx; the rest is ignored with a warning.
+*		Pitch sequences are summed up front, as FamiTracker runs them
+*		relative and FamiTone adds its envelope value as is
+*		> Sound effects: every track is an effect, run through a small
+*		model of the FamiTracker player (notes, volume column, instrument
+*		sequences, Fxx, Vxx duty) once at 60 Hz with NTSC periods and once
+*		at 50 Hz with PAL periods, until Cxx or the last row. Each frame
+*		stores the APU registers that changed; an effect whose PAL copy
+*		comes out the same as the NTSC one points both at one copy
+*		> Prints the bytes of every song or effect
+*
+*		Usage: soundpack [-e] [-o output.s] module.ftm
+*			-e			convert the tracks as sound effects
+******************************************************************************/
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FTM_ID				"FamiTracker Module"
+#define FTM_ID_SIZE			18
+#define MIN_FILE_VERSION	0x0420
+#define MAX_FILE_VERSION	0x0440
+#define BLOCK_ID_SIZE		16
+
+// FamiTracker limits
+#define CHANNELS			5
+#define MAX_TRACKS			64
+#define MAX_FRAMES			128
+#define MAX_PATTERNS		128
+#define MAX_ROWS			256
+#define MAX_INSTRUMENTS		64
+#define MAX_SEQUENCES		128
+#define MAX_SEQ_ITEMS		256
+#define MAX_EFFECT_COLUMNS	4
+#define SEQ_TYPES			5
+#define OCTAVE_RANGE		8
+#define NOTE_RANGE			12
+
+#define NO_INSTRUMENT		64
+#define NO_VOLUME			16
+#define DEFAULT_SPEED		6
+#define DEFAULT_TEMPO		150
+
+enum { NOTE_NONE = 0, NOTE_RELEASE = 13, NOTE_HALT = 14 };
+enum { FX_SPEED = 1, FX_JUMP = 2, FX_SKIP = 3, FX_HALT = 4, FX_DUTY = 18, FX_COUNT = 32 };
+enum { SEQ_VOLUME, SEQ_ARPEGGIO, SEQ_PITCH, SEQ_HIPITCH, SEQ_DUTY };
+enum { CH_PULSE1, CH_PULSE2, CH_TRIANGLE, CH_NOISE, CH_DPCM };
+
+// FamiTone2 channel stream codes
+#define FT_INSTRUMENT		0x80
+#define FT_REST				0x81
+#define FT_REST_MAX			61
+#define FT_SPEED			0xfb
+#define FT_LOOP				0xfd
+#define FT_REFERENCE		0xff
+#define FT_REF_SIZE			4
+#define FT_REF_EVENTS_MAX	255
+// Notes 1-60 are C-1 to B-5, the range of the FamiTone note table
+#define FT_NOTE_MAX			60
+#define FT_INSTRUMENT_SIZE	8
+#define FT_DEFAULT_SPEED	6
+
+// Envelope values are stored +192 and must fit -64..63; a byte below $80 holds the value
+//	for that many more frames, and 0 loops to the offset that follows
+#define ENV_BIAS			192
+#define ENV_MIN				(-64)
+#define ENV_MAX				63
+#define ENV_REPEAT_MAX		127
+#define ENV_MAX_SIZE		256
+
+// Sound effect streams: $80+register and the value, a frame count, or 0 at the end
+#define SFX_REGISTERS		11
+#define SFX_REPEAT_MAX		127
+#define SFX_MAX_FRAMES		4096
+#define SFX_MAX_SIZE		(SFX_MAX_FRAMES*(SFX_REGISTERS*2 + 1) + 1)
+
+// Frame rates and CPU clocks of the two regions
+#define NTSC_RATE			60
+#define PAL_RATE			50
+#define NTSC_CLOCK			1789773.0
+#define PAL_CLOCK			1662607.0
+#define MAX_PERIOD			0x7ff
+
+#define MAX_SEGMENTS		(MAX_FRAMES + 2)
+#define LINE_BYTES			16
+
+typedef struct
+{
+	unsigned char note, octave, inst, vol;
+	unsigned char fx[MAX_EFFECT_COLUMNS][2];
+} Cell;
+
+typedef struct
+{
+	int count, loop, release, setting;
+	signed char items[MAX_SEQ_ITEMS];
+} Sequence;
+
+typedef struct
+{
+	int defined;
+	// Sequence index per type, or -1
+	int seq[SEQ_TYPES];
+} Instrument;
+
+typedef struct
+{
+	char name[64];
+	int frames, speed, tempo, rows;
+	unsigned char order[MAX_FRAMES][CHANNELS];
+	int fxColumns[CHANNELS];
+	Cell *patterns[CHANNELS][MAX_PATTERNS];
+} Track;
+
+typedef struct
+{
+	const char *path;
+	int version;
+	int trackCount;
+	Track tracks[MAX_TRACKS];
+	Instrument instruments[MAX_INSTRUMENTS];
+	Sequence sequences[SEQ_TYPES][MAX_SEQUENCES];
+	int seqDefined[SEQ_TYPES][MAX_SEQUENCES];
+	// Already warned about
+	int fxWarned[FX_COUNT], volumeWarned, dpcmWarned;
+} Module;
+
+// Rows [start, end) of a frame as the song plays them; frame -1 is the cut that a Cxx
+//	leaves behind and -2 the silence after it
+typedef struct
+{
+	int frame, start, end;
+} Segment;
+
+typedef struct
+{
+	Segment segs[MAX_SEGMENTS];
+	int count, loop;
+	// Ended by Cxx
+	int halted;
+} Order;
+
+// Reader over one block of the file
+typedef struct
+{
+	const char *path, *name;
+	const unsigned char *data;
+	int size, pos;
+} Block;
+
+static const Cell emptyCell = { NOTE_NONE, 0, NO_INSTRUMENT, NO_VOLUME, { { 0 } } };
+static const Cell cutCell = { NOTE_HALT, 0, NO_INSTRUMENT, NO_VOLUME, { { 0 } } };
+// Effect letters by FamiTracker effect number
+static const char fxNames[FX_COUNT + 1] = " FBDCE3?HI047PGZ12VYQRASXW??????";
+static const char *seqNames[SEQ_TYPES] = { "volume", "arpeggio", "pitch", "hi-pitch", "duty" };
+
+static void warn(const Module *module, const char *format, ...)
+{
+	va_list args;
+
+	fprintf(stderr, "%s: warning: ", module->path);
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
+
+static int block_fail(Block *block, const char *what)
+{
+	fprintf(stderr, "%s: %s block: %s\n", block->path, block->name, what);
+	return 1;
+}
+
+static int get_char(Block *block)
+{
+	if (block->pos >= block->size)	return -1;
+	return block->data[block->pos++];
+}
+
+static int get_int(Block *block)
+{
+	const unsigned char *p = block->data + block->pos;
+
+	if (block->pos + 4 > block->size)
+	{
+		block->pos = block->size + 1;
+		return 0;
+	}
+	block->pos += 4;
+	return (int)((unsigned)p[0] | (unsigned)p[1] << 8 | (unsigned)p[2] << 16 | (unsigned)p[3] << 24);
+}
+
+static int overrun(const Block *block)
+{
+	return block->pos > block->size;
+}
+
+static int read_params(Module *module, Block *block, int version)
+{
+	int expansion, channels;
+
+	if (version < 2)	return block_fail(block, "version 1 modules are not supported");
+	expansion = get_char(block);
+	channels = get_int(block);
+	get_int(block);
+	if (get_int(block))	warn(module, "custom engine speed ignored");
+	if (overrun(block))	return block_fail(block, "truncated");
+	if (expansion)		return block_fail(block, "expansion chips are not supported");
+	if (channels != CHANNELS)	return block_fail(block, "not 5 channels");
+	return 0;
+}
+
+static int read_header(Module *module, Block *block, int version)
+{
+	int i, j, c;
+
+	if (version < 2)	return block_fail(block, "version 1 modules are not supported");
+	module->trackCount = get_char(block) + 1;
+	if (module->trackCount > MAX_TRACKS)	return block_fail(block, "too many tracks");
+	for (i = 0; i < module->trackCount; ++i)
+	{
+		Track *track = &module->tracks[i];
+
+		snprintf(track->name, sizeof(track->name), "%d", i);
+		if (version < 3)	continue;
+		for (j = 0; (c = get_char(block)) > 0; ++j)
+		{
+			if (j < (int)sizeof(track->name) - 1)	track->name[j] = (char)c;
+		}
+		if (c < 0)	return block_fail(block, "truncated");
+		track->name[j < (int)sizeof(track->name) - 1 ? j : (int)sizeof(track->name) - 1] = 0;
+	}
+	for (i = 0; i < CHANNELS; ++i)
+	{
+		get_char(block);
+		for (j = 0; j < module->trackCount; ++j)
+		{
+			c = get_char(block);
+			if (c < 0)	return block_fail(block, "truncated");
+			module->tracks[j].fxColumns[i] = c < MAX_EFFECT_COLUMNS ? c : MAX_EFFECT_COLUMNS - 1;
+		}
+	}
+	return 0;
+}
+
+static int read_instruments(Module *module, Block *block, int version)
+{
+	int count = get_int(block), i, j, octaves = version == 1 ? 6 : OCTAVE_RANGE;
+
+	for (i = 0; i < count; ++i)
+	{
+		int index = get_int(block), type = get_char(block), seqCount = get_int(block);
+		Instrument *inst;
+
+		if (overrun(block) || index < 0 || index >= MAX_INSTRUMENTS)	return block_fail(block, "bad instrument");
+		if (type != 1)	return block_fail(block, "only 2A03 instruments are supported");
+		if (seqCount < 0 || seqCount > SEQ_TYPES)	return block_fail(block, "bad sequence count");
+		inst = &module->instruments[index];
+		inst->defined = 1;
+		for (j = 0; j < SEQ_TYPES; ++j)	inst->seq[j] = -1;
+		for (j = 0; j < seqCount; ++j)
+		{
+			int enabled = get_char(block), seq = get_char(block);
+			if (enabled)	inst->seq[j] = seq;
+		}
+		// DPCM sample assignments
+		block->pos += octaves*NOTE_RANGE*(version > 5 ? 3 : 2);
+		// Name
+		j = get_int(block);
+		if (j < 0)	return block_fail(block, "bad instrument name");
+		block->pos += j;
+		if (overrun(block))	return block_fail(block, "truncated");
+	}
+	return 0;
+}
+
+static int read_sequences(Module *module, Block *block, int version)
+{
+	int count = get_int(block), indices[SEQ_TYPES*MAX_SEQUENCES], types[SEQ_TYPES*MAX_SEQUENCES], i, j;
+
+	if (version < 3)	return block_fail(block, "versions before 3 are not supported");
+	if (count < 0 || count > SEQ_TYPES*MAX_SEQUENCES)	return block_fail(block, "bad count");
+	for (i = 0; i < count; ++i)
+	{
+		int index = get_int(block), type = get_int(block), items = get_char(block), loop = get_int(block);
+		Sequence *seq;
+
+		if (overrun(block) || index < 0 || index >= MAX_SEQUENCES || type < 0 || type >= SEQ_TYPES)
+		{
+			return block_fail(block, "bad sequence");
+		}
+		seq = &module->sequences[type][index];
+		module->seqDefined[type][index] = 1;
+		indices[i] = index;
+		types[i] = type;
+		seq->count = items;
+		seq->loop = loop >= 0 && loop < items ? loop : -1;
+		seq->release = -1;
+		if (version == 4)
+		{
+			seq->release = get_int(block);
+			seq->setting = get_int(block);
+		}
+		for (j = 0; j < items; ++j)	seq->items[j] = (signed char)get_char(block);
+	}
+	if (version == 5)
+	{
+		// Stored for every sequence slot, only the defined ones matter
+		for (i = 0; i < MAX_SEQUENCES; ++i)
+		{
+			for (j = 0; j < SEQ_TYPES; ++j)
+			{
+				int release = get_int(block), setting = get_int(block);
+				if (module->seqDefined[j][i])
+				{
+					module->sequences[j][i].release = release;
+					module->sequences[j][i].setting = setting;
+				}
+			}
+		}
+	}
+	else if (version >= 6)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			Sequence *seq = &module->sequences[types[i]][indices[i]];
+			seq->release = get_int(block);
+			seq->setting = get_int(block);
+		}
+	}
+	if (overrun(block))	return block_fail(block, "truncated");
+	for (j = 0; j < SEQ_TYPES; ++j)
+	{
+		for (i = 0; i < MAX_SEQUENCES; ++i)
+		{
+			Sequence *seq = &module->sequences[j][i];
+			if (seq->release >= seq->count)	seq->release = -1;
+		}
+	}
+	return 0;
+}
+
+static int read_frames(Module *module, Block *block, int version)
+{
+	int i, j, k;
+
+	if (version < 2)	return block_fail(block, "version 1 modules are not supported");
+	for (i = 0; i < module->trackCount; ++i)
+	{
+		Track *track = &module->tracks[i];
+
+		track->frames = get_int(block);
+		track->speed = get_int(block);
+		track->tempo = version >= 3 ? get_int(block) : DEFAULT_TEMPO;
+		track->rows = get_int(block);
+		if (overrun(block) || track->frames < 1 || track->frames > MAX_FRAMES || track->rows < 1 || track->rows > MAX_ROWS)
+		{
+			return block_fail(block, "bad track");
+		}
+		for (j = 0; j < track->frames; ++j)
+		{
+			for (k = 0; k < CHANNELS; ++k)	track->order[j][k] = (unsigned char)get_char(block);
+		}
+	}
+	if (overrun(block))	return block_fail(block, "truncated");
+	return 0;
+}
+
+static int read_patterns(Module *module, Block *block, int version)
+{
+	int i, j;
+
+	if (version < 2)	return block_fail(block, "version 1 modules are not supported");
+	while (block->pos < block->size)
+	{
+		int t = get_int(block), ch = get_int(block), pattern = get_int(block), items = get_int(block);
+		Track *track;
+
+		if (overrun(block) || t < 0 || t >= module->trackCount || ch < 0 || ch >= CHANNELS || pattern < 0 || pattern >= MAX_PATTERNS)
+		{
+			return block_fail(block, "bad pattern");
+		}
+		track = &module->tracks[t];
+		if (!track->patterns[ch][pattern])
+		{
+			track->patterns[ch][pattern] = malloc(MAX_ROWS*sizeof(Cell));
+			for (i = 0; i < MAX_ROWS; ++i)	track->patterns[ch][pattern][i] = emptyCell;
+		}
+		for (i = 0; i < items; ++i)
+		{
+			int row = module->version == 0x0200 ? get_char(block) : get_int(block);
+			Cell cell = emptyCell;
+
+			cell.note = (unsigned char)get_char(block);
+			cell.octave = (unsigned char)get_char(block);
+			cell.inst = (unsigned char)get_char(block);
+			cell.vol = (unsigned char)get_char(block);
+			for (j = 0; j <= track->fxColumns[ch]; ++j)
+			{
+				cell.fx[j][0] = (unsigned char)get_char(block);
+				cell.fx[j][1] = (unsigned char)get_char(block);
+			}
+			if (overrun(block) || row < 0 || row >= MAX_ROWS)	return block_fail(block, "bad row");
+			track->patterns[ch][pattern][row] = cell;
+		}
+	}
+	return 0;
+}
+
+static int load_module(Module *module, const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	unsigned char *data;
+	long size;
+	int pos, errors = 0;
+
+	module->path = path;
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	data = malloc(size + 1);
+	if (fread(data, 1, size, f) != (size_t)size)	size = 0;
+	fclose(f);
+
+	if (size < FTM_ID_SIZE + 4 || memcmp(data, FTM_ID, FTM_ID_SIZE))
+	{
+		fprintf(stderr, "%s: not a FamiTracker module\n", path);
+		return 1;
+	}
+	module->version = data[FTM_ID_SIZE] | data[FTM_ID_SIZE + 1] << 8;
+	if (module->version < MIN_FILE_VERSION || module->version > MAX_FILE_VERSION)
+	{
+		fprintf(stderr, "%s: module version %04x is not supported (FamiTracker 0.4 saves %04x)\n", path, module->version, MAX_FILE_VERSION);
+		return 1;
+	}
+
+	pos = FTM_ID_SIZE + 4;
+	while (!errors && pos + BLOCK_ID_SIZE <= size)
+	{
+		char name[BLOCK_ID_SIZE + 1];
+		Block block;
+		int version;
+
+		memcpy(name, data + pos, BLOCK_ID_SIZE);
+		name[BLOCK_ID_SIZE] = 0;
+		if (!strcmp(name, "END"))	break;
+		if (pos + BLOCK_ID_SIZE + 8 > size)	break;
+
+		block.path = path;
+		block.name = name;
+		block.data = data + pos + BLOCK_ID_SIZE + 8;
+		block.size = data[pos + 20] | data[pos + 21] << 8 | data[pos + 22] << 16 | data[pos + 23] << 24;
+		block.pos = 0;
+		version = data[pos + 16] | data[pos + 17] << 8;
+		if (block.size < 0 || block.data + block.size > data + size)
+		{
+			errors += block_fail(&block, "truncated");
+			break;
+		}
+
+		if (!strcmp(name, "PARAMS"))			errors += read_params(module, &block, version);
+		else if (!strcmp(name, "HEADER"))		errors += read_header(module, &block, version);
+		else if (!strcmp(name, "INSTRUMENTS"))	errors += read_instruments(module, &block, version);
+		else if (!strcmp(name, "SEQUENCES"))	errors += read_sequences(module, &block, version);
+		else if (!strcmp(name, "FRAMES"))		errors += read_frames(module, &block, version);
+		else if (!strcmp(name, "PATTERNS"))		errors += read_patterns(module, &block, version);
+		else if (!strncmp(name, "SEQUENCES_", 10) && block.size > 4)
+		{
+			errors += block_fail(&block, "expansion chips are not supported");
+		}
+		pos += BLOCK_ID_SIZE + 8 + block.size;
+	}
+	free(data);
+	if (!errors && !module->trackCount)
+	{
+		fprintf(stderr, "%s: no tracks\n", path);
+		return 1;
+	}
+	return errors;
+}
+
+static const Cell *cell_at(const Track *track, int ch, int frame, int row)
+{
+	const Cell *pattern;
+
+	if (frame == -1)	return ch == CH_DPCM ? &emptyCell : &cutCell;
+	if (frame < 0)		return &emptyCell;
+	pattern = track->patterns[ch][track->order[frame][ch]];
+	return pattern ? &pattern[row] : &emptyCell;
+}
+
+// Finds effect fx in any channel of the row; returns its parameter or -1
+static int row_effect(const Track *track, int frame, int row, int fx)
+{
+	int ch, col;
+
+	for (ch = 0; ch < CHANNELS; ++ch)
+	{
+		const Cell *cell = cell_at(track, ch, frame, row);
+		for (col = 0; col <= track->fxColumns[ch]; ++col)
+		{
+			if (cell->fx[col][0] == fx)	return cell->fx[col][1];
+		}
+	}
+	return -1;
+}
+
+// Speed set by Fxx in the row (tempo values from $20 up are not supported), or 0
+static int row_speed(const Module *module, const Track *track, int frame, int row)
+{
+	int speed = row_effect(track, frame, row, FX_SPEED);
+
+	if (speed >= 0x20)
+	{
+		if (!module->fxWarned[FX_SPEED])	warn(module, "track %s: tempo change F%02X ignored", track->name, speed);
+		((Module *)module)->fxWarned[FX_SPEED] = 1;
+		return 0;
+	}
+	return speed > 0 ? speed : 0;
+}
+
+// Plays the frame list as FamiTracker does: a frame ends after a row with Bxx, Dxx or
+//	Cxx; Bxx goes to its frame, Dxx to its row of the next frame, and the end to frame 0.
+//	The song loops once it comes back to a frame it played from the same row
+static void play_order(const Track *track, Order *order)
+{
+	int frame = 0, start = 0, i;
+
+	order->count = 0;
+	order->loop = 0;
+	order->halted = 0;
+	for (;;)
+	{
+		Segment *seg;
+		int next = frame + 1, nextStart = 0, row;
+
+		for (i = 0; i < order->count; ++i)
+		{
+			if (order->segs[i].frame == frame && order->segs[i].start == start)
+			{
+				order->loop = i;
+				return;
+			}
+		}
+		seg = &order->segs[order->count++];
+		seg->frame = frame;
+		seg->start = start;
+		seg->end = track->rows;
+		for (row = start; row < track->rows; ++row)
+		{
+			int jump = row_effect(track, frame, row, FX_JUMP), skip = row_effect(track, frame, row, FX_SKIP);
+
+			if (row_effect(track, frame, row, FX_HALT) >= 0)
+			{
+				seg->end = row + 1;
+				seg = &order->segs[order->count++];
+				seg->frame = -1;
+				seg->start = 0;
+				seg->end = 1;
+				seg = &order->segs[order->count++];
+				seg->frame = -2;
+				seg->start = 0;
+				seg->end = FT_REST_MAX;
+				order->loop = order->count - 1;
+				order->halted = 1;
+				return;
+			}
+			if (jump >= 0 || skip >= 0)
+			{
+				seg->end = row + 1;
+				if (jump >= 0)	next = jump;
+				if (skip >= 0)	nextStart = skip;
+				break;
+			}
+		}
+		frame = next < track->frames ? next : 0;
+		start = nextStart < track->rows ? nextStart : 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Music
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+	unsigned char *bytes;
+	int size, events;
+} Chunk;
+
+typedef struct
+{
+	int song, ch;
+	Chunk *chunks;
+	int count, cap;
+	// Chunk the song loops to
+	int loop;
+	// Initial speed, before the loop
+	unsigned char prefix[2];
+	int prefixSize;
+	// No notes: uses the shared silent stream
+	int silent;
+	// Layout: per chunk, -1 when stored here, or the first stored chunk (global index)
+	//	of a reference covering refCount chunks
+	int *refTo, *refCount;
+} Stream;
+
+// A chunk stored in the data, in output order
+typedef struct
+{
+	int stream, chunk;
+	// The next stored chunk follows it directly in the data
+	int joined;
+	int label;
+} Stored;
+
+typedef struct
+{
+	Module *module;
+	Order orders[MAX_TRACKS];
+	// FamiTracker instrument of each FamiTone instrument, and back (-1 when unused)
+	int instruments[MAX_INSTRUMENTS], instrumentCount, packed[MAX_INSTRUMENTS];
+	Stream streams[MAX_TRACKS*CHANNELS];
+	int streamCount;
+	Stored *stored;
+	int storedCount;
+} Music;
+
+// Stream being encoded
+typedef struct
+{
+	Stream *stream;
+	Chunk chunk;
+	unsigned char buf[MAX_ROWS*4 + 8];
+	// Open event: note code (-1 for a rest) and its rows
+	int code, rows;
+} Encoder;
+
+static void emit(Encoder *enc, int byte)
+{
+	enc->buf[enc->chunk.size++] = (unsigned char)byte;
+}
+
+static void emit_rest(Encoder *enc, int rows)
+{
+	while (rows > 0)
+	{
+		int n = rows < FT_REST_MAX ? rows : FT_REST_MAX;
+		emit(enc, FT_REST + ((n - 1) << 1));
+		++enc->chunk.events;
+		rows -= n;
+	}
+}
+
+static void close_event(Encoder *enc)
+{
+	if (!enc->rows)	return;
+	if (enc->code < 0)
+	{
+		emit_rest(enc, enc->rows);
+	}
+	else
+	{
+		// Bit 0 of a note adds one empty row
+		emit(enc, enc->code << 1 | (enc->rows > 1));
+		++enc->chunk.events;
+		emit_rest(enc, enc->rows - 2);
+	}
+	enc->rows = 0;
+}
+
+static void end_chunk(Encoder *enc)
+{
+	Stream *stream = enc->stream;
+
+	close_event(enc);
+	if (stream->count == stream->cap)
+	{
+		stream->cap = stream->cap ? stream->cap*2 : 64;
+		stream->chunks = realloc(stream->chunks, stream->cap*sizeof(Chunk));
+	}
+	enc->chunk.bytes = malloc(enc->chunk.size);
+	memcpy(enc->chunk.bytes, enc->buf, enc->chunk.size);
+	stream->chunks[stream->count++] = enc->chunk;
+	enc->chunk.size = 0;
+	enc->chunk.events = 0;
+}
+
+// FamiTone note code of a cell: 1-60 for C-1..B-5, the 4-bit period with 16 for 0 on the
+//	noise channel, 0 for a cut; -1 when the row has no note
+static int note_code(Music *music, const Track *track, int ch, const Cell *cell)
+{
+	int code;
+
+	if (cell->note == NOTE_HALT)	return 0;
+	if (cell->note < 1 || cell->note > NOTE_RANGE)	return -1;
+	code = cell->octave*NOTE_RANGE + cell->note - 1;
+	if (ch == CH_NOISE)	return (code & 15) ? (code & 15) : 16;
+
+	code -= NOTE_RANGE - 1;
+	if (code < 1 || code > FT_NOTE_MAX)
+	{
+		warn(music->module, "track %s: note out of the C-1..B-5 range moved by octaves", track->name);
+		while (code < 1)			code += NOTE_RANGE;
+		while (code > FT_NOTE_MAX)	code -= NOTE_RANGE;
+	}
+	return code;
+}
+
+// Encodes one channel of a song in chunks of the given rows; forceAtLoop makes the first
+//	note after the loop point set its instrument, since the loop comes from the song end.
+//	Returns the FamiTone instrument left at the end (-1 unknown), *loopInst the one at the
+//	loop point, and whether the channel has any note
+static int encode_channel(Music *music, int t, int ch, int chunkRows, int forceAtLoop, Stream *stream, int *loopInst, int *hasNotes)
+{
+	const Track *track = &music->module->tracks[t];
+	const Order *order = &music->orders[t];
+	Encoder enc;
+	// FamiTone and FamiTracker both start every channel on instrument 0
+	int inst = music->packed[0] >= 0 ? 0 : -1, want = 0, k, row;
+
+	memset(&enc, 0, sizeof(enc));
+	enc.stream = stream;
+	stream->count = 0;
+	stream->prefixSize = 0;
+	*hasNotes = 0;
+	*loopInst = -1;
+
+	if (ch == CH_PULSE1 && track->speed != FT_DEFAULT_SPEED && !row_speed(music->module, track, order->segs[0].frame, order->segs[0].start))
+	{
+		stream->prefix[0] = FT_SPEED;
+		stream->prefix[1] = (unsigned char)track->speed;
+		stream->prefixSize = 2;
+	}
+
+	for (k = 0; k < order->count; ++k)
+	{
+		const Segment *seg = &order->segs[k];
+
+		if (k == order->loop)
+		{
+			stream->loop = stream->count;
+			*loopInst = inst;
+			if (forceAtLoop)	inst = -1;
+		}
+		for (row = seg->start; row < seg->end; ++row)
+		{
+			const Cell *cell = cell_at(track, ch, seg->frame, row);
+			int speed = ch == CH_PULSE1 && seg->frame >= 0 ? row_speed(music->module, track, seg->frame, row) : 0;
+			int code = ch == CH_DPCM ? -1 : note_code(music, track, ch, cell);
+
+			if (cell->inst < MAX_INSTRUMENTS)	want = cell->inst;
+			if (row > seg->start && (row - seg->start) % chunkRows == 0)	end_chunk(&enc);
+
+			if (speed || code >= 0 || !enc.rows)
+			{
+				close_event(&enc);
+				if (speed)
+				{
+					emit(&enc, FT_SPEED);
+					emit(&enc, speed);
+				}
+				if (code > 0)
+				{
+					*hasNotes = 1;
+					if (music->packed[want] != inst)
+					{
+						inst = music->packed[want];
+						emit(&enc, FT_INSTRUMENT | inst << 1);
+					}
+				}
+				enc.code = code;
+			}
+			++enc.rows;
+		}
+		end_chunk(&enc);
+	}
+	if (stream->prefixSize)	*hasNotes = 1;
+	return inst;
+}
+
+static void free_chunks(Stream *stream)
+{
+	int i;
+
+	for (i = 0; i < stream->count; ++i)	free(stream->chunks[i].bytes);
+	stream->count = 0;
+}
+
+static int same_chunk(const Chunk *a, const Chunk *b)
+{
+	return a->size == b->size && !memcmp(a->bytes, b->bytes, a->size);
+}
+
+// Lays the streams out in order, replacing runs of chunks that match stored ones with
+//	references; shareSongs allows references into other songs. Returns the total bytes
+static int layout(Music *music, int shareSongs)
+{
+	int total = 0, s, i, g, m;
+
+	music->storedCount = 0;
+	for (s = 0; s < music->streamCount; ++s)
+	{
+		Stream *stream = &music->streams[s];
+
+		if (stream->silent)	continue;
+		total += stream->prefixSize + 3;
+		for (i = 0; i < stream->count; )
+		{
+			int best = 0, bestBytes = 0, bestTo = -1;
+
+			for (g = 0; g < music->storedCount; ++g)
+			{
+				int bytes = 0, events = 0;
+
+				if (!shareSongs && music->streams[music->stored[g].stream].song != stream->song)	continue;
+				for (m = 0; i + m < stream->count && g + m < music->storedCount; ++m)
+				{
+					const Stored *to = &music->stored[g + m];
+					const Chunk *chunk = &stream->chunks[i + m];
+
+					if (m && (!music->stored[g + m - 1].joined || i + m == stream->loop))	break;
+					if (!same_chunk(chunk, &music->streams[to->stream].chunks[to->chunk]))	break;
+					if (events + chunk->events > FT_REF_EVENTS_MAX)	break;
+					events += chunk->events;
+					bytes += chunk->size;
+				}
+				if (bytes > bestBytes)
+				{
+					best = m;
+					bestBytes = bytes;
+					bestTo = g;
+				}
+			}
+
+			if (bestBytes > FT_REF_SIZE)
+			{
+				stream->refTo[i] = bestTo;
+				stream->refCount[i] = best;
+				for (m = 1; m < best; ++m)	stream->refTo[i + m] = -2;
+				if (music->storedCount)	music->stored[music->storedCount - 1].joined = 0;
+				total += FT_REF_SIZE;
+				i += best;
+			}
+			else
+			{
+				Stored *stored = &music->stored[music->storedCount++];
+
+				stored->stream = s;
+				stored->chunk = i;
+				stored->joined = 1;
+				stored->label = -1;
+				stream->refTo[i] = -1;
+				total += stream->chunks[i].size;
+				++i;
+			}
+		}
+		if (music->storedCount)	music->stored[music->storedCount - 1].joined = 0;
+	}
+	return total;
+}
+
+// Bytes of one stream as laid out
+static int stream_bytes(const Stream *stream)
+{
+	int bytes = stream->prefixSize + 3, i;
+
+	if (stream->silent)	return 0;
+	for (i = 0; i < stream->count; ++i)
+	{
+		if (stream->refTo[i] == -1)			bytes += stream->chunks[i].size;
+		else if (stream->refTo[i] >= 0)		bytes += FT_REF_SIZE;
+	}
+	return bytes;
+}
+
+// Encodes every song with the given chunk rows; returns 0 on success
+static int encode_music(Music *music, int chunkRows)
+{
+	int t, ch, total = 0;
+
+	music->streamCount = 0;
+	for (t = 0; t < music->module->trackCount; ++t)
+	{
+		for (ch = 0; ch < CHANNELS; ++ch)
+		{
+			Stream *stream = &music->streams[music->streamCount++];
+			int loopInst, endInst, hasNotes;
+
+			free_chunks(stream);
+			stream->song = t;
+			stream->ch = ch;
+			endInst = encode_channel(music, t, ch, chunkRows, 0, stream, &loopInst, &hasNotes);
+			if (endInst != loopInst)
+			{
+				free_chunks(stream);
+				encode_channel(music, t, ch, chunkRows, 1, stream, &loopInst, &hasNotes);
+			}
+			stream->silent = !hasNotes;
+			stream->refTo = realloc(stream->refTo, (stream->count + 1)*sizeof(int));
+			stream->refCount = realloc(stream->refCount, (stream->count + 1)*sizeof(int));
+			total += stream->count;
+		}
+	}
+	music->stored = realloc(music->stored, (total + 1)*sizeof(Stored));
+	return 0;
+}
+
+// Warns once per module about what FamiTone does not play
+static void check_music(Module *module, int t, const Order *order)
+{
+	const Track *track = &module->tracks[t];
+	int k, ch, row, col;
+
+	for (k = 0; k < order->count; ++k)
+	{
+		const Segment *seg = &order->segs[k];
+
+		for (ch = 0; ch < CHANNELS && seg->frame >= 0; ++ch)
+		{
+			for (row = seg->start; row < seg->end; ++row)
+			{
+				const Cell *cell = cell_at(track, ch, seg->frame, row);
+
+				if (ch == CH_DPCM && cell->note && !module->dpcmWarned)
+				{
+					warn(module, "track %s: DPCM channel ignored", track->name);
+					module->dpcmWarned = 1;
+				}
+				if (cell->vol != NO_VOLUME && !module->volumeWarned)
+				{
+					warn(module, "track %s: volume column ignored", track->name);
+					module->volumeWarned = 1;
+				}
+				for (col = 0; col <= track->fxColumns[ch]; ++col)
+				{
+					int fx = cell->fx[col][0];
+
+					if (!fx || fx == FX_SPEED || fx == FX_JUMP || fx == FX_SKIP || fx == FX_HALT || fx >= FX_COUNT || module->fxWarned[fx])	continue;
+					warn(module, "track %s: effect %cxx ignored", track->name, fxNames[fx]);
+					module->fxWarned[fx] = 1;
+				}
+			}
+		}
+	}
+}
+
+// Marks the instruments that notes play with and numbers them for FamiTone
+static int pack_instruments(Music *music)
+{
+	Module *module = music->module;
+	int used[MAX_INSTRUMENTS] = { 0 }, t, ch, k, row, i;
+
+	for (t = 0; t < module->trackCount; ++t)
+	{
+		const Track *track = &module->tracks[t];
+		const Order *order = &music->orders[t];
+
+		for (ch = 0; ch < CH_DPCM; ++ch)
+		{
+			int want = 0;
+
+			for (k = 0; k < order->count; ++k)
+			{
+				const Segment *seg = &order->segs[k];
+				for (row = seg->start; row < seg->end; ++row)
+				{
+					const Cell *cell = cell_at(track, ch, seg->frame, row);
+					if (cell->inst < MAX_INSTRUMENTS)	want = cell->inst;
+					if (cell->note >= 1 && cell->note <= NOTE_RANGE)	used[want] = 1;
+				}
+			}
+		}
+	}
+	music->instrumentCount = 0;
+	for (i = 0; i < MAX_INSTRUMENTS; ++i)
+	{
+		music->packed[i] = -1;
+		if (!used[i])	continue;
+		if (!module->instruments[i].defined)
+		{
+			fprintf(stderr, "%s: instrument %02X is played but not defined\n", module->path, i);
+			return 1;
+		}
+		music->packed[i] = music->instrumentCount;
+		music->instruments[music->instrumentCount++] = i;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Envelopes
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+	unsigned char bytes[ENV_MAX_SIZE];
+	int size;
+} Envelope;
+
+// Values a sequence gives frame by frame as FamiTone plays them; returns the count and
+//	sets *loop (the value FamiTone loops to, or the last one)
+static int sequence_values(const Module *module, int type, int index, int *values, int *loop)
+{
+	const Sequence *seq;
+	int count, i, sum = 0;
+
+	if (index < 0 || !module->seqDefined[type][index] || !module->sequences[type][index].count)
+	{
+		values[0] = type == SEQ_VOLUME ? 15 : 0;
+		*loop = 0;
+		return 1;
+	}
+	seq = &module->sequences[type][index];
+	count = seq->count;
+	*loop = seq->loop;
+	// Without release notes, a sequence with a release point stops there (or loops up to it)
+	if (seq->release >= 0)
+	{
+		count = seq->release + 1;
+		if (*loop > seq->release)	*loop = -1;
+	}
+	if (type == SEQ_ARPEGGIO && seq->setting)
+	{
+		warn(module, "arpeggio sequence %d: only absolute arpeggios are supported", index);
+	}
+	for (i = 0; i < count; ++i)
+	{
+		int value = seq->items[i];
+
+		if (type == SEQ_PITCH)	value = sum += value;
+		if (value < ENV_MIN || value > ENV_MAX)
+		{
+			warn(module, "%s sequence %d: value %d clamped to %d..%d", seqNames[type], index, value, ENV_MIN, ENV_MAX);
+			value = value < ENV_MIN ? ENV_MIN : ENV_MAX;
+		}
+		values[i] = value;
+	}
+	if (type == SEQ_PITCH && *loop >= 0)
+	{
+		for (sum = 0, i = *loop; i < count; ++i)	sum += seq->items[i];
+		if (sum)	warn(module, "pitch sequence %d: the loop does not come back to its start, the drift is lost", index);
+	}
+	if (*loop < 0)	*loop = count - 1;
+	return count;
+}
+
+// Run-length codes values[from, to) into the envelope
+static void envelope_runs(Envelope *env, const int *values, int from, int to)
+{
+	int i = from;
+
+	while (i < to)
+	{
+		int run = 1;
+
+		while (i + run < to && values[i + run] == values[i] && run < ENV_REPEAT_MAX + 1)	++run;
+		env->bytes[env->size++] = (unsigned char)(values[i] + ENV_BIAS);
+		if (run == 2)		env->bytes[env->size++] = (unsigned char)(values[i] + ENV_BIAS);
+		else if (run > 2)	env->bytes[env->size++] = (unsigned char)(run - 1);
+		i += run;
+	}
+}
+
+static int make_envelope(const Module *module, int type, int index, Envelope *env)
+{
+	int values[MAX_SEQ_ITEMS], loop, count = sequence_values(module, type, index, values, &loop), loopPos;
+
+	env->size = 0;
+	envelope_runs(env, values, 0, loop);
+	loopPos = env->size;
+	envelope_runs(env, values, loop, count);
+	env->bytes[env->size++] = 0;
+	env->bytes[env->size++] = (unsigned char)loopPos;
+	if (env->size > ENV_MAX_SIZE - 2)
+	{
+		fprintf(stderr, "%s: %s sequence %d is too long for FamiTone\n", module->path, seqNames[type], index);
+		return 1;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Output
+//-----------------------------------------------------------------------------
+
+static void write_bytes(FILE *out, const unsigned char *bytes, int size)
+{
+	int i;
+
+	for (i = 0; i < size; ++i)
+	{
+		fprintf(out, "%s$%02x", i % LINE_BYTES ? "," : "\t.byte ", bytes[i]);
+		if (i % LINE_BYTES == LINE_BYTES - 1 || i == size - 1)	fputc('\n', out);
+	}
+}
+
+static void write_music(FILE *out, Music *music, Envelope *envs, int envCount, int (*instEnv)[3])
+{
+	Module *module = music->module;
+	int s, i, g, labels = 0;
+
+	fprintf(out, ";generated by tools/soundpack.c from %s, do not edit\n\n", module->path);
+	fprintf(out, "music_music_data:\n");
+	fprintf(out, "\t.byte %d\n", module->trackCount);
+	fprintf(out, "\t.word @instruments\n");
+	fprintf(out, "\t.word @samples-4\n");
+	for (s = 0; s < music->streamCount; s += CHANNELS)
+	{
+		const Track *track = &module->tracks[music->streams[s].song];
+
+		fprintf(out, "\t.word ");
+		for (i = 0; i < CHANNELS; ++i)
+		{
+			if (music->streams[s + i].silent)	fprintf(out, "@silence,");
+			else								fprintf(out, "@song%dch%d,", music->streams[s + i].song, i);
+		}
+		// PAL then NTSC tempo step: 256 at 150 BPM on NTSC moves the row counter one speed unit per frame
+		fprintf(out, "%d,%d\n", track->tempo*256/(DEFAULT_TEMPO*PAL_RATE/NTSC_RATE), track->tempo*256/DEFAULT_TEMPO);
+	}
+
+	fprintf(out, "\n@instruments:\n");
+	for (i = 0; i < music->instrumentCount; ++i)
+	{
+		const Instrument *inst = &module->instruments[music->instruments[i]];
+		int values[MAX_SEQ_ITEMS], loop, duty = 0;
+
+		if (inst->seq[SEQ_DUTY] >= 0)
+		{
+			int count = sequence_values(module, SEQ_DUTY, inst->seq[SEQ_DUTY], values, &loop), j;
+			for (j = 1; j < count; ++j)
+			{
+				if (values[j] != values[0])
+				{
+					warn(module, "instrument %02X: FamiTone keeps the first value of its duty sequence", music->instruments[i]);
+					break;
+				}
+			}
+			duty = values[0] & 3;
+		}
+		if (inst->seq[SEQ_HIPITCH] >= 0)	warn(module, "instrument %02X: hi-pitch sequence ignored", music->instruments[i]);
+		fprintf(out, "\t.byte $%02x ;instrument $%02x\n", duty << 6 | 0x30, i);
+		fprintf(out, "\t.word @env%d,@env%d,@env%d\n", instEnv[i][0], instEnv[i][1], instEnv[i][2]);
+		fprintf(out, "\t.byte $00\n");
+	}
+
+	fprintf(out, "\n@samples:\n");
+	for (i = 0; i < envCount; ++i)
+	{
+		fprintf(out, "@env%d:\n", i);
+		write_bytes(out, envs[i].bytes, envs[i].size);
+	}
+
+	for (g = 0; g < music->storedCount; ++g)	music->stored[g].label = -1;
+	for (s = 0; s < music->streamCount; ++s)
+	{
+		const Stream *stream = &music->streams[s];
+		for (i = 0; i < stream->count; ++i)
+		{
+			if (!stream->silent && stream->refTo[i] >= 0 && music->stored[stream->refTo[i]].label < 0)
+			{
+				music->stored[stream->refTo[i]].label = 0;
+			}
+		}
+	}
+	for (g = 0; g < music->storedCount; ++g)
+	{
+		if (!music->stored[g].label)	music->stored[g].label = ++labels;
+	}
+
+	g = 0;
+	for (s = 0; s < music->streamCount; ++s)
+	{
+		const Stream *stream = &music->streams[s];
+
+		if (!(s % CHANNELS))	fputc('\n', out);
+		if (stream->silent)		continue;
+		fprintf(out, "\n@song%dch%d:\n", stream->song, stream->ch);
+		if (stream->prefixSize)	write_bytes(out, stream->prefix, stream->prefixSize);
+		for (i = 0; i < stream->count; ++i)
+		{
+			if (i == stream->loop)	fprintf(out, "@song%dch%dloop:\n", stream->song, stream->ch);
+			if (stream->refTo[i] == -1)
+			{
+				if (music->stored[g].label > 0)	fprintf(out, "@ref%d:\n", music->stored[g].label - 1);
+				write_bytes(out, stream->chunks[i].bytes, stream->chunks[i].size);
+				++g;
+			}
+			else if (stream->refTo[i] >= 0)
+			{
+				int events = 0, m;
+
+				for (m = 0; m < stream->refCount[i]; ++m)	events += stream->chunks[i + m].events;
+				fprintf(out, "\t.byte $%02x,$%02x\n", FT_REFERENCE, events);
+				fprintf(out, "\t.word @ref%d\n", music->stored[stream->refTo[i]].label - 1);
+			}
+		}
+		fprintf(out, "\t.byte $%02x\n", FT_LOOP);
+		fprintf(out, "\t.word @song%dch%dloop\n", stream->song, stream->ch);
+	}
+
+	// Channels without notes rest forever
+	fprintf(out, "\n@silence:\n");
+	fprintf(out, "\t.byte $%02x,$%02x\n", FT_REST + ((FT_REST_MAX - 1) << 1) , FT_LOOP);
+	fprintf(out, "\t.word @silence\n");
+}
+
+static int convert_music(Module *module, const char *outPath)
+{
+	static Music music;
+	static Envelope envs[MAX_INSTRUMENTS*3 + 1];
+	int instEnv[MAX_INSTRUMENTS][3], envCount = 0, envBytes = 0, best = 0, bestTotal = 0, withinSongs;
+	int chunkRows, t, i, j, k;
+	FILE *out;
+
+	music.module = module;
+	for (t = 0; t < module->trackCount; ++t)
+	{
+		play_order(&module->tracks[t], &music.orders[t]);
+		check_music(module, t, &music.orders[t]);
+	}
+	if (pack_instruments(&music))	return 1;
+
+	// Envelopes of the instruments, each distinct one stored once
+	for (i = 0; i < music.instrumentCount; ++i)
+	{
+		const Instrument *inst = &module->instruments[music.instruments[i]];
+		static const int types[3] = { SEQ_VOLUME, SEQ_ARPEGGIO, SEQ_PITCH };
+
+		for (j = 0; j < 3; ++j)
+		{
+			Envelope env;
+
+			if (make_envelope(module, types[j], inst->seq[types[j]], &env))	return 1;
+			for (k = 0; k < envCount; ++k)
+			{
+				if (envs[k].size == env.size && !memcmp(envs[k].bytes, env.bytes, env.size))	break;
+			}
+			if (k == envCount)
+			{
+				envs[envCount++] = env;
+				envBytes += env.size;
+			}
+			instEnv[i][j] = k;
+		}
+	}
+
+	// Smallest data over the chunk sizes
+	for (chunkRows = 4; chunkRows <= MAX_ROWS; chunkRows *= 2)
+	{
+		int total;
+
+		encode_music(&music, chunkRows);
+		total = layout(&music, 1);
+		if (!best || total < bestTotal)
+		{
+			best = chunkRows;
+			bestTotal = total;
+		}
+	}
+	encode_music(&music, best);
+	withinSongs = layout(&music, 0);
+	layout(&music, 1);
+
+	printf("%-12s %6s %6s\n", "song", "rows", "bytes");
+	for (t = 0; t < module->trackCount; ++t)
+	{
+		const Order *order = &music.orders[t];
+		int rows = 0, bytes = 0;
+
+		for (k = 0; k < order->count; ++k)	rows += order->segs[k].end - order->segs[k].start;
+		for (i = 0; i < CHANNELS; ++i)		bytes += stream_bytes(&music.streams[t*CHANNELS + i]);
+		printf("%-12s %6d %6d\n", module->tracks[t].name, rows, bytes);
+	}
+	i = 1 + 4 + module->trackCount*(CHANNELS*2 + 4) + music.instrumentCount*FT_INSTRUMENT_SIZE + envBytes + 4;
+	printf("%-12s %6s %6d  (%d instruments, %d envelopes)\n", "header", "", i, music.instrumentCount, envCount);
+	printf("%-12s %6s %6d  (%d with references only within a song, blocks of %d rows)\n", "total", "", i + bestTotal,
+		   i + withinSongs, best);
+
+	if (!outPath)	return 0;
+	out = fopen(outPath, "w");
+	if (!out)
+	{
+		fprintf(stderr, "%s: cannot create\n", outPath);
+		return 1;
+	}
+	write_music(out, &music, envs, envCount, instEnv);
+	fclose(out);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Sound effects
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+	int playing, note, inst, volume, duty;
+	int seqPos[SEQ_TYPES], seqOn[SEQ_TYPES];
+	int seqVolume, arpeggio, pitch, seqDuty;
+} SfxChannel;
+
+typedef struct
+{
+	unsigned char bytes[SFX_MAX_SIZE];
+	int size, frames;
+} Effect;
+
+// Steps a channel's instrument sequences by one frame, as FamiTracker does
+static void run_sequences(const Module *module, SfxChannel *chn)
+{
+	const Instrument *inst = &module->instruments[chn->inst];
+	int type;
+
+	for (type = 0; type < SEQ_TYPES; ++type)
+	{
+		const Sequence *seq;
+		int value;
+
+		if (!chn->seqOn[type])	continue;
+		seq = &module->sequences[type][inst->seq[type]];
+		value = seq->items[chn->seqPos[type]];
+		switch (type)
+		{
+			case SEQ_VOLUME:	chn->seqVolume = value;		break;
+			case SEQ_ARPEGGIO:	chn->arpeggio = value;		break;
+			case SEQ_PITCH:		chn->pitch += value;		break;
+			case SEQ_HIPITCH:	chn->pitch += value*16;		break;
+			case SEQ_DUTY:		chn->seqDuty = value & 3;	break;
+		}
+		++chn->seqPos[type];
+		if (seq->release >= 0 && chn->seqPos[type] > seq->release)
+		{
+			if (seq->loop >= 0 && seq->loop <= seq->release)	chn->seqPos[type] = seq->loop;
+			else												chn->seqOn[type] = 0;
+		}
+		else if (chn->seqPos[type] >= seq->count)
+		{
+			if (seq->loop >= 0)	chn->seqPos[type] = seq->loop;
+			else				chn->seqOn[type] = 0;
+		}
+	}
+}
+
+// Applies one row to a channel
+static void play_cell(Module *module, const Track *track, int ch, const Cell *cell, SfxChannel *chn)
+{
+	int col, type;
+
+	if (cell->inst < MAX_INSTRUMENTS)
+	{
+		if (!module->instruments[cell->inst].defined)	warn(module, "track %s: instrument %02X not defined", track->name, cell->inst);
+		else											chn->inst = cell->inst;
+	}
+	if (cell->vol < NO_VOLUME)	chn->volume = cell->vol;
+	for (col = 0; col <= track->fxColumns[ch]; ++col)
+	{
+		int fx = cell->fx[col][0];
+
+		if (fx == FX_DUTY)	chn->duty = cell->fx[col][1] & 3;
+		else if (fx && fx != FX_SPEED && fx != FX_JUMP && fx != FX_SKIP && fx != FX_HALT && fx < FX_COUNT && !module->fxWarned[fx])
+		{
+			warn(module, "track %s: effect %cxx ignored", track->name, fxNames[fx]);
+			module->fxWarned[fx] = 1;
+		}
+	}
+	if (cell->note == NOTE_HALT)
+	{
+		chn->playing = 0;
+	}
+	else if (cell->note >= 1 && cell->note <= NOTE_RANGE)
+	{
+		const Instrument *inst = &module->instruments[chn->inst];
+
+		chn->playing = 1;
+		chn->note = cell->octave*NOTE_RANGE + cell->note - 1;
+		chn->seqVolume = 15;
+		chn->arpeggio = 0;
+		chn->pitch = 0;
+		chn->seqDuty = -1;
+		for (type = 0; type < SEQ_TYPES; ++type)
+		{
+			int index = inst->seq[type];
+			chn->seqPos[type] = 0;
+			chn->seqOn[type] = index >= 0 && module->seqDefined[type][index] && module->sequences[type][index].count;
+		}
+	}
+}
+
+// APU registers of a channel, in the FamiTone effect buffer order
+static void channel_registers(int ch, const SfxChannel *chn, const int *periods, int *regs)
+{
+	int volume = chn->seqVolume*chn->volume/15, duty = chn->seqDuty >= 0 ? chn->seqDuty : chn->duty, period;
+
+	if (chn->seqVolume && chn->volume && !volume)	volume = 1;
+	if (!chn->playing)	volume = 0;
+
+	if (ch == CH_NOISE)
+	{
+		regs[9] = 0x30 | volume;
+		if (chn->playing)	regs[10] = (((chn->note + chn->arpeggio) & 15) ^ 15) | (duty & 1) << 7;
+		return;
+	}
+
+	if (chn->playing)
+	{
+		int note = chn->note + chn->arpeggio;
+
+		note = note < 0 ? 0 : note >= OCTAVE_RANGE*NOTE_RANGE ? OCTAVE_RANGE*NOTE_RANGE - 1 : note;
+		period = periods[note] + chn->pitch;
+		period = period < 0 ? 0 : period > MAX_PERIOD ? MAX_PERIOD : period;
+		regs[ch*3 + 1] = period & 0xff;
+		regs[ch*3 + 2] = period >> 8;
+	}
+	if (ch == CH_TRIANGLE)	regs[6] = volume ? 0x81 : 0x80;
+	else if (chn->playing)	regs[ch*3] = duty << 6 | 0x30 | volume;
+	else					regs[ch*3] = 0x30;
+}
+
+// Plays a track at the given frame rate and clock and stores the register changes
+static int render_effect(Module *module, const Track *track, const Order *order, int rate, double clock, Effect *effect)
+{
+	SfxChannel chn[CH_DPCM];
+	int periods[OCTAVE_RANGE*NOTE_RANGE], regs[SFX_REGISTERS], prev[SFX_REGISTERS], active[CH_DPCM] = { 0 };
+	int speed = track->speed, accum = 0, seg = 0, row = order->segs[0].start, frame, lastChange = 0, repeat = 0;
+	int done = 0, i, ch;
+
+	for (i = 0; i < OCTAVE_RANGE*NOTE_RANGE; ++i)
+	{
+		double freq = 440.0*pow(2.0, (i - 45)/12.0);
+		periods[i] = (int)floor(clock/(16.0*freq) - 1.0 + 0.5);
+		if (periods[i] > MAX_PERIOD)	periods[i] = MAX_PERIOD;
+	}
+	memset(chn, 0, sizeof(chn));
+	for (ch = 0; ch < CH_DPCM; ++ch)	chn[ch].volume = 15;
+	for (i = 0; i < SFX_REGISTERS; ++i)	prev[i] = regs[i] = -1;
+	effect->size = 0;
+
+	for (frame = 0; !done; ++frame)
+	{
+		int changed = 0;
+
+		if (frame == SFX_MAX_FRAMES)
+		{
+			fprintf(stderr, "%s: track %s: effect longer than %d frames\n", module->path, track->name, SFX_MAX_FRAMES);
+			return 1;
+		}
+		// A new row when the tempo counter runs out
+		if (accum <= 0)
+		{
+			if (seg >= order->count || order->segs[seg].frame < 0)
+			{
+				// Cxx, or the whole order played once: everything stops
+				for (ch = 0; ch < CH_DPCM; ++ch)	chn[ch].playing = 0;
+				done = 1;
+			}
+			else
+			{
+				const Segment *s = &order->segs[seg];
+				int newSpeed = row_speed(module, track, s->frame, row);
+
+				if (newSpeed)	speed = newSpeed;
+				for (ch = 0; ch < CH_DPCM; ++ch)
+				{
+					play_cell(module, track, ch, cell_at(track, ch, s->frame, row), &chn[ch]);
+					if (chn[ch].playing)	active[ch] = 1;
+				}
+				if (++row >= s->end && ++seg < order->count)	row = order->segs[seg].start;
+			}
+			accum += rate*60;
+		}
+		accum -= track->tempo*24/speed;
+
+		for (ch = 0; ch < CH_DPCM; ++ch)
+		{
+			if (chn[ch].playing)	run_sequences(module, &chn[ch]);
+			if (active[ch])			channel_registers(ch, &chn[ch], periods, regs);
+		}
+
+		for (i = 0; i < SFX_REGISTERS; ++i)	changed |= regs[i] != prev[i];
+		if (!changed)
+		{
+			++repeat;
+			continue;
+		}
+		// Frames the previous state lasts
+		while (frame && repeat > 0)
+		{
+			int n = repeat < SFX_REPEAT_MAX ? repeat : SFX_REPEAT_MAX;
+			effect->bytes[effect->size++] = (unsigned char)n;
+			repeat -= n;
+		}
+		for (i = 0; i < SFX_REGISTERS; ++i)
+		{
+			if (regs[i] != prev[i])
+			{
+				effect->bytes[effect->size++] = (unsigned char)(0x80 + i);
+				effect->bytes[effect->size++] = (unsigned char)regs[i];
+				prev[i] = regs[i];
+			}
+		}
+		lastChange = frame;
+		repeat = 1;
+	}
+	effect->bytes[effect->size++] = 0;
+	effect->frames = lastChange + 1;
+	return 0;
+}
+
+static int convert_effects(Module *module, const char *outPath)
+{
+	static Effect effects[MAX_TRACKS][2];
+	static Order order;
+	// Copy each effect pointer uses: [t][0] NTSC, [t][1] PAL, as t*2+region
+	int use[MAX_TRACKS][2], total = 0, t, r, i;
+	FILE *out = NULL;
+
+	printf("%-12s %6s %6s %6s %6s\n", "effect", "frames", "ntsc", "pal", "bytes");
+	for (t = 0; t < module->trackCount; ++t)
+	{
+		const Track *track = &module->tracks[t];
+		int bytes = 0;
+
+		play_order(track, &order);
+		for (r = 0; r < 2; ++r)
+		{
+			if (render_effect(module, track, &order, r ? PAL_RATE : NTSC_RATE, r ? PAL_CLOCK : NTSC_CLOCK, &effects[t][r]))	return 1;
+
+			// Share a copy that is already in the data
+			use[t][r] = t*2 + r;
+			for (i = 0; i < t*2 + r; ++i)
+			{
+				const Effect *other = &effects[i/2][i%2];
+				if (use[i/2][i%2] == i && other->size == effects[t][r].size && !memcmp(other->bytes, effects[t][r].bytes, other->size))
+				{
+					use[t][r] = i;
+					break;
+				}
+			}
+			if (use[t][r] == t*2 + r)	bytes += effects[t][r].size;
+		}
+		total += bytes + 4;
+		printf("%-12s %6d %6d %6d %6d\n", track->name, effects[t][0].frames, effects[t][0].size, effects[t][1].size, bytes + 4);
+	}
+	printf("%-12s %6s %6s %6s %6d\n", "total", "", "", "", total);
+
+	if (!outPath)	return 0;
+	out = fopen(outPath, "w");
+	if (!out)
+	{
+		fprintf(stderr, "%s: cannot create\n", outPath);
+		return 1;
+	}
+	fprintf(out, ";generated by tools/soundpack.c from %s, do not edit\n\n", module->path);
+	fprintf(out, "sounds:\n");
+	for (t = 0; t < module->trackCount; ++t)
+	{
+		fprintf(out, "\t.word @sfx_%s_%d,@sfx_%s_%d\n", use[t][0] % 2 ? "pal" : "ntsc", use[t][0]/2,
+				use[t][1] % 2 ? "pal" : "ntsc", use[t][1]/2);
+	}
+	fputc('\n', out);
+	for (r = 0; r < 2; ++r)
+	{
+		for (t = 0; t < module->trackCount; ++t)
+		{
+			if (use[t][r] != t*2 + r)	continue;
+			fprintf(out, "@sfx_%s_%d:\n", r ? "pal" : "ntsc", t);
+			write_bytes(out, effects[t][r].bytes, effects[t][r].size);
+		}
+	}
+	fclose(out);
+	return 0;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: soundpack [-e] [-o output.s] module.ftm\n"
+		"Converts a FamiTracker 0.4 module to FamiTone2 music data, or with -e to sound effects\n"
+		"  -e              convert the tracks as sound effects\n"
+		"  -o output.s     file to write (without it only the report is printed)\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	static Module module;
+	const char *outPath = NULL, *path = NULL;
+	int effects = 0, i;
+
+	for (i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-o") && i + 1 < argc)	outPath = argv[++i];
+		else if (!strcmp(argv[i], "-e"))			effects = 1;
+		else if (argv[i][0] == '-' || path)			usage();
+		else										path = argv[i];
+	}
+	if (!path)	usage();
+
+	if (load_module(&module, path))	return 1;
+	return effects ? convert_effects(&module, outPath) : convert_music(&module, outPath);
+}
@@ -0,0 +1,136 @@
+/******************************************************************************
+*  @file       	symbols.c
+*  @brief      	Symbol table loaded from the ld65 label file
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		>
+******************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symbols.h"
+
+int sym_load_labels(SymbolTable *table, const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	int capacity = 0;
+
+	table->syms = NULL;
+	table->count = 0;
+	table->funcs = NULL;
+	table->funcCount = 0;
+	if (!f)
+	{
+		fprintf(stderr, "%s: cannot open\n", path);
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), f))
+	{
+		unsigned adr;
+		char name[200];
+
+		if (sscanf(line, "al %x .%199s", &adr, name) != 2)	continue;
+
+		if (table->count == capacity)
+		{
+			capacity = capacity ? capacity*2 : 256;
+			table->syms = realloc(table->syms, capacity*sizeof(Symbol));
+		}
+		table->syms[table->count].name = strdup(name);
+		table->syms[table->count].adr = (uint16_t)adr;
+		++table->count;
+	}
+
+	fclose(f);
+	return 0;
+}
+
+void sym_free(SymbolTable *table)
+{
+	int i;
+	for (i = 0; i < table->count; ++i)	free(table->syms[i].name);
+	free(table->syms);
+	free(table->funcs);
+	table->syms = NULL;
+	table->funcs = NULL;
+	table->count = 0;
+	table->funcCount = 0;
+}
+
+int sym_find(const SymbolTable *table, const char *name)
+{
+	int i;
+	for (i = 0; i < table->count; ++i)
+	{
+		if (!strcmp(table->syms[i].name, name))	return table->syms[i].adr;
+	}
+	return -1;
+}
+
+// Whether a label names a routine rather than a branch target inside one
+static int is_function_label(const char *name)
+{
+	int i;
+
+	if (name[0] == '@' || strchr(name, '@'))	return 0;
+	if (name[0] == '_' && name[1] == '_')		return 0;
+	if (name[0] == 'L' && strlen(name) == 5)
+	{
+		for (i = 1; i < 5; ++i)
+		{
+			if (!isxdigit((unsigned char)name[i]))	return 1;
+		}
+		return 0;
+	}
+	return 1;
+}
+
+static int compare_adr(const void *a, const void *b)
+{
+	const Symbol *sa = *(const Symbol * const *)a, *sb = *(const Symbol * const *)b;
+	if (sa->adr != sb->adr)	return sa->adr < sb->adr ? -1 : 1;
+	// Prefer C names when two labels share an address
+	return (sb->name[0] == '_') - (sa->name[0] == '_');
+}
+
+const Symbol *sym_function_at(SymbolTable *table, uint16_t adr)
+{
+	int lo, hi, i;
+
+	if (!table->funcs && table->count)
+	{
+		table->funcs = malloc(table->count*sizeof(Symbol *));
+		for (i = 0; i < table->count; ++i)
+		{
+			if (is_function_label(table->syms[i].name))	table->funcs[table->funcCount++] = &table->syms[i];
+		}
+		qsort(table->funcs, table->funcCount, sizeof(Symbol *), compare_adr);
+	}
+
+	// Last function label with address <= adr; the first of equal addresses wins
+	lo = 0;
+	hi = table->funcCount - 1;
+	i = -1;
+	while (lo <= hi)
+	{
+		int mid = (lo + hi)/2;
+		if (table->funcs[mid]->adr <= adr)
+		{
+			i = mid;
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid - 1;
+		}
+	}
+	if (i < 0)	return NULL;
+	while (i > 0 && table->funcs[i - 1]->adr == table->funcs[i]->adr)	--i;
+	return table->funcs[i];
+}
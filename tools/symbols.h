@@ -0,0 +1,41 @@
+/******************************************************************************
+*  @file       	symbols.h
+*  @brief      	Symbol table loaded from the ld65 label file
+*  @modified   	October 17, 2026
+*
+*  @par [explanation]
+*		> Reads the VICE style label file written by "ld65 -Ln labels.txt"
+*		(lines of the form "al 00C0A5 ._gamePhase")
+******************************************************************************/
+
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <stdint.h>
+
+typedef struct
+{
+	char *name;
+	uint16_t adr;
+} Symbol;
+
+typedef struct
+{
+	Symbol *syms;
+	int count;
+	// Code labels sorted by address, built on first use by sym_function_at
+	Symbol **funcs;
+	int funcCount;
+} SymbolTable;
+
+// Loads all labels from path; returns 0 on success
+int sym_load_labels(SymbolTable *table, const char *path);
+// Frees the table
+void sym_free(SymbolTable *table);
+// Returns the address of a label, or -1 if it is not defined
+int sym_find(const SymbolTable *table, const char *name);
+// Returns the routine label at or before adr, or NULL below the first one
+// cc65 local labels (L0F2E), cheap locals and linker symbols (__CODE_RUN__) are skipped
+const Symbol *sym_function_at(SymbolTable *table, uint16_t adr);
+
+#endif